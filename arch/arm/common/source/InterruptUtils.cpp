@@ -89,7 +89,7 @@ void timer_irq_handler()
   heart_beat_value = (heart_beat_value + 1) % 4;
 
   Scheduler::instance()->incTicks();
-  Scheduler::instance()->schedule();
+  Scheduler::instance()->preempt();
 }
 
 void arch_uart1_irq_handler()
@@ -123,7 +123,7 @@ extern "C" void irqHandler_0()
 
   Scheduler::instance()->incTicks();
 
-  Scheduler::instance()->schedule();
+  Scheduler::instance()->preempt();
   // kprintfd("irq0: Going to leave irq Handler 0\n");
   ArchInterrupts::EndOfInterrupt(0);
   arch_contextSwitch();
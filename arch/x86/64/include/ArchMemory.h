@@ -42,8 +42,10 @@ public:
  * @param physical_page
  * @param user_access PTE User/Supervisor Flag, governing the binary Paging
  * Privilege Mechanism
+ * @param writeable PTE Read/Write Flag, 0 maps the page read-only
  */
-  __attribute__((warn_unused_result)) bool mapPage(uint64 virtual_page, uint64 physical_page, uint64 user_access);
+  __attribute__((warn_unused_result)) bool mapPage(uint64 virtual_page, uint64 physical_page, uint64 user_access,
+                                                   uint64 writeable = 1);
 
 /**
  * removes the mapping to a virtual_page by marking its PTE Entry as non valid
@@ -134,6 +136,12 @@ public:
   void copyArgsSegmentToNewArchMem(ArchMemory& new_mem, size_t args_ppn);
 
 private:
+  /**
+   * the vdso pages (see offsets.h) are not owned by the address space, so they are
+   * neither freed nor copied on fork
+   */
+  static bool isVdsoPage(uint64 virtual_page);
+
   /**
    * locks for all paging levels
    */
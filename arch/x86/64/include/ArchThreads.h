@@ -9,7 +9,10 @@
 #define __ATOMIC_SEQ_CST 5
 #endif
 
-struct ArchThreadRegisters
+/**
+ * the plain cpu registers, trivially copyable so arch_contextSwitch can take a local copy
+ */
+struct ArchCpuRegisters
 {
   uint64  rip;       //   0
   uint64  cs;        //   8
@@ -37,7 +40,22 @@ struct ArchThreadRegisters
   uint64  ss;        // 184
   uint64  rsp0;      // 192
   uint64  cr3;       // 200
-  uint32  fpu[28];   // 208
+  uint64  sysret;    // 208 - entered the kernel via SYSCALL, rcx/r11 hold no user state
+};
+
+/**
+ * FPU/SSE state is switched lazily: it is allocated on the first #NM of a thread
+ * and only saved when another thread wants to use the FPU.
+ */
+struct ArchThreadRegisters : public ArchCpuRegisters
+{
+  uint8*  fpu;         // FXSAVE/XSAVE area, 64 byte aligned, 0 if the FPU was never used
+  uint8*  fpu_memory;  // allocation backing fpu
+
+  ArchThreadRegisters() = default;
+  ArchThreadRegisters(const ArchThreadRegisters& src);
+  ArchThreadRegisters& operator=(const ArchThreadRegisters&) = delete;
+  ~ArchThreadRegisters();
 };
 
 class Thread;
@@ -152,7 +170,37 @@ public:
    */
   static void debugCheckNewThread(Thread* thread);
 
+  /**
+   * #NM handler: hands the FPU to the registers of the current (user) thread,
+   * saving the state of the previous owner first
+   * @param info the registers the FPU state belongs to
+   */
+  static void switchFpuOwner(ArchThreadRegisters* info);
+
+  /**
+   * allocates and initializes the FPU state area, must not be called with interrupts disabled
+   * @param info the registers which will own the area
+   */
+  static void allocateFpuState(ArchThreadRegisters* info);
+
+  /**
+   * sets CR0.TS unless info owns the FPU, so the next FPU instruction traps
+   * @param info the registers we are about to switch to
+   */
+  static void updateFpuTrap(const ArchThreadRegisters* info);
+
 private:
+  friend struct ArchThreadRegisters;
+
+  static void initialiseFpu();
+  static void saveFpuState(ArchThreadRegisters* info);
+  static void restoreFpuState(ArchThreadRegisters* info);
+
+  static ArchThreadRegisters* fpu_owner_;
+  static size_t fpu_state_size_;
+  static bool fpu_xsave_;
+  static bool fpu_trap_set_;
+
   /**
    * creates the ArchThreadRegisters for a thread (common setup for kernel and user registers)
    * @param info where the ArchThreadRegisters is saved
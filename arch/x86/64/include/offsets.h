@@ -28,7 +28,10 @@
 #define ARGS_SEGMENT_START   ((USER_BREAK - 1) & ~(PAGE_SIZE - 1))    // 0x7fff_ffff_f000
 #define ARGS_SEGMENT_END     (ARGS_SEGMENT_START - PAGE_SIZE)         // 0x7fff_ffff_e000
 
-#define STACK_SPACE_START    (ARGS_SEGMENT_END - 1)                   // 0x7fff_ffff_dfff
+#define VDSO_SEGMENT_START   ARGS_SEGMENT_END                         // 0x7fff_ffff_e000
+#define VDSO_SEGMENT_END     (VDSO_SEGMENT_START - 2 * PAGE_SIZE)     // 0x7fff_ffff_c000
+
+#define STACK_SPACE_START    (VDSO_SEGMENT_END - 1)                   // 0x7fff_ffff_bfff
 #define STACK_SPACE_END      0x00002AAAAAAAAAAA                       // 0x2aaa_aaaa_aaaa
 
 //#define STACK_MAX_SIZE      0x800000    //  8MiB = 2048 Pages each 4kiB // LINUX
@@ -51,7 +54,11 @@
  *;                        │   1 PAGE_SIZE = 0x1000 = 4kiB
  *;   0000_7fff_ffff_efff ─┘ ← ARGS_SEGMENT_END
  *;                       ±1
- *;   0000_7fff_ffff_effe ─┐ ← STACK_SPACE_START
+ *;   0000_7fff_ffff_dfff ─┐ ← VDSO_SEGMENT_START - 1
+ *;                        │   2 PAGE_SIZE, read-only time and process page (vdso-definitions.h)
+ *;   0000_7fff_ffff_c000 ─┘ ← VDSO_SEGMENT_END
+ *;                       ±1
+ *;   0000_7fff_ffff_bfff ─┐ ← STACK_SPACE_START
  *;                        │   ~85 TiB stackSpace (2/3)
  *;   0000_2AAA_AAAA_AAAA ─┘ ← STACK_SPACE_END
  *;                       ±1
@@ -37,6 +37,13 @@ typedef int64 ssize_t;
 #define USER_DS ((0x40)|DPL_USER)
 #define USER_SS ((0x40)|DPL_USER)
 
+// SYSCALL loads SS = KERNEL_CS + 8, SYSRET loads CS = base + 16 and SS = base + 8.
+// With our 16 byte GDT entries these land in the upper halves of gdt[1] and gdt[2],
+// boot.32.C places flat data descriptors there.
+#define KERNEL_SYSCALL_SS (KERNEL_CS + 8)
+#define USER_SYSRET_BASE (0x20|DPL_USER)
+#define USER_SYSRET_SS (USER_SYSRET_BASE + 8)
+
 #define likely(x)       __builtin_expect((x),1)
 #define unlikely(x)     __builtin_expect((x),0)
 #define unreachable()    __builtin_unreachable()
@@ -5,6 +5,7 @@
 #include "ArchThreads.h"
 #include "assert.h"
 #include "Thread.h"
+#include "offsets.h"
 
 void ArchInterrupts::initialise()
 {
@@ -130,11 +131,6 @@ extern "C" void arch_saveThreadRegisters(uint64* base, uint64 error)
   register struct interrupt_registers* iregisters;
   iregisters = (struct interrupt_registers*) (base + sizeof(struct context_switch_registers)/sizeof(uint64) + error);
   register ArchThreadRegisters* info = currentThreadRegisters;
-  asm("fnsave %[fpu]\n"
-      "frstor %[fpu]\n"
-      :
-      : [fpu]"m"((info->fpu))
-      :);
   info->rsp = iregisters->rsp;
   info->rip = iregisters->rip;
   info->cs = iregisters->cs;
@@ -156,9 +152,16 @@ extern "C" void arch_saveThreadRegisters(uint64* base, uint64 error)
   info->rcx = registers->rcx;
   info->rax = registers->rax;
   info->rbp = registers->rbp;
+  info->sysret = 0;
   assert(!currentThread || currentThread->isStackCanaryOK());
 }
 
+extern "C" void arch_saveSyscallRegisters(uint64* base)
+{
+  arch_saveThreadRegisters(base, 0);
+  currentThreadRegisters->sysret = 1;
+}
+
 typedef struct {
     uint32 padding;
     uint64 rsp0; // actually the TSS has more fields, but we don't need them
@@ -179,10 +182,33 @@ extern "C" void arch_contextSwitch()
     assert(currentThread->lock_waiting_on_ == 0 && "How did you even manage to execute code while waiting for a lock?");
   }
   assert(currentThread->isStackCanaryOK() && "Kernel stack corruption detected.");
-  ArchThreadRegisters info = *currentThreadRegisters; // optimization: local copy produces more efficient code in this case
+  ArchThreads::updateFpuTrap(currentThreadRegisters);
+  ArchCpuRegisters info = *currentThreadRegisters; // optimization: local copy produces more efficient code in this case
   g_tss.rsp0 = info.rsp0;
-  asm("frstor %[fpu]\n" : : [fpu]"m"(info.fpu));
   asm("mov %[cr3], %%cr3\n" : : [cr3]"r"(info.cr3));
+  if ((info.cs & DPL_USER) && info.sysret && info.rip < USER_BREAK)
+  {
+    // the thread left userspace via SYSCALL, rcx and r11 are scratch - no need for iretq
+    asm("mov %[rip], %%rcx\n" : : [rip]"m"(info.rip));
+    asm("mov %[rflags], %%r11\n" : : [rflags]"m"(info.rflags));
+    asm("mov %[rsi], %%rsi\n" : : [rsi]"m"(info.rsi));
+    asm("mov %[rdi], %%rdi\n" : : [rdi]"m"(info.rdi));
+    asm("mov %[es], %%es\n" : : [es]"m"(info.es));
+    asm("mov %[ds], %%ds\n" : : [ds]"m"(info.ds));
+    asm("mov %[r8], %%r8\n" : : [r8]"m"(info.r8));
+    asm("mov %[r9], %%r9\n" : : [r9]"m"(info.r9));
+    asm("mov %[r10], %%r10\n" : : [r10]"m"(info.r10));
+    asm("mov %[r12], %%r12\n" : : [r12]"m"(info.r12));
+    asm("mov %[r13], %%r13\n" : : [r13]"m"(info.r13));
+    asm("mov %[r14], %%r14\n" : : [r14]"m"(info.r14));
+    asm("mov %[r15], %%r15\n" : : [r15]"m"(info.r15));
+    asm("mov %[rdx], %%rdx\n" : : [rdx]"m"(info.rdx));
+    asm("mov %[rbx], %%rbx\n" : : [rbx]"m"(info.rbx));
+    asm("mov %[rax], %%rax\n" : : [rax]"m"(info.rax));
+    asm("mov %[rsp], %%rsp\n" : : [rsp]"m"(info.rsp));
+    asm("mov %[rbp], %%rbp\n" : : [rbp]"m"(info.rbp));
+    asm("sysretq");
+  }
   asm("push %[ss]" : : [ss]"m"(info.ss));
   asm("push %[rsp]" : : [rsp]"m"(info.rsp));
   asm("push %[rflags]\n" : : [rflags]"m"(info.rflags));
@@ -7,6 +7,7 @@
 #include "kstring.h"
 #include "ArchThreads.h"
 #include "Thread.h"
+#include "Scheduler.h"
 
 PageMapLevel4Entry kernel_page_map_level_4[PAGE_MAP_LEVEL_4_ENTRIES] __attribute__((aligned(0x1000)));
 PageDirPointerTableEntry kernel_page_directory_pointer_table[2 * PAGE_DIR_POINTER_TABLE_ENTRIES] __attribute__((aligned(0x1000)));
@@ -107,7 +108,7 @@ bool ArchMemory::insert(pointer map_ptr, uint64 index, uint64 ppn, uint64 bzero,
   return true;
 }
 
-bool ArchMemory::mapPage(uint64 virtual_page, uint64 physical_page, uint64 user_access)
+bool ArchMemory::mapPage(uint64 virtual_page, uint64 physical_page, uint64 user_access, uint64 writeable)
 {
   debug(A_MEMORY, "%zx %zx %zx %zx\n", page_map_level_4_, virtual_page, physical_page, user_access);
   ArchMemoryMapping m = resolveMapping(page_map_level_4_, virtual_page);
@@ -141,7 +142,7 @@ bool ArchMemory::mapPage(uint64 virtual_page, uint64 physical_page, uint64 user_
   pt_lock_.acquire();
   if (m.page_ppn == 0)
   {
-    bool insertion_valid = insert<PageTableEntry>(getIdentAddressOfPPN(m.pt_ppn), m.pti, physical_page, 0, 0, user_access, 1);
+    bool insertion_valid = insert<PageTableEntry>(getIdentAddressOfPPN(m.pt_ppn), m.pti, physical_page, 0, 0, user_access, writeable);
     pt_lock_.release();
     return insertion_valid;
   }
@@ -177,11 +178,13 @@ ArchMemory::~ArchMemory()
                 if (pt[pti].present)
                 {
                   pt[pti].present = 0;
-                  PageManager::instance()->freePPN(pt[pti].page_ppn);
+                  if (!isVdsoPage(((pml4i * PAGE_DIR_POINTER_TABLE_ENTRIES + pdpti) * PAGE_DIR_ENTRIES + pdi) * PAGE_TABLE_ENTRIES + pti))
+                    PageManager::instance()->freePPN(pt[pti].page_ppn);
                 }
               }
               pd[pdi].pt.present = 0;
               PageManager::instance()->freePPN(pd[pdi].pt.page_ppn);
+              Scheduler::instance()->condResched();
             }
           }
           pdpt[pdpti].pd.present = 0;
@@ -334,6 +337,11 @@ void ArchMemory::unmapKernelPage(size_t virtual_page)
   asm volatile ("movq %%cr3, %%rax; movq %%rax, %%cr3;" ::: "%rax");
 }
 
+bool ArchMemory::isVdsoPage(uint64 virtual_page)
+{
+  return virtual_page >= VDSO_SEGMENT_END / PAGE_SIZE && virtual_page < VDSO_SEGMENT_START / PAGE_SIZE;
+}
+
 uint64 ArchMemory::getRootOfPagingStructure()
 {
   return page_map_level_4_;
@@ -372,13 +380,13 @@ void ArchMemory::copyPagesToNewArchMem(ArchMemory& new_mem)
 
               for (uint64 pti = 0; pti < PAGE_TABLE_ENTRIES; pti++)
               {
-                if (pt[pti].present)
+                uint64 virt_addr = ((pml4i) << (9 + 9 + 9 + 12)) +
+                                   ((pdpti) << (9 + 9 + 12)) +
+                                   ((pdi)   << (9 + 12)) +
+                                   ((pti)   << (12));
+                if (pt[pti].present && !isVdsoPage(virt_addr / PAGE_SIZE))
                 {
                   size_t phys_page = PageManager::instance()->allocPPN();
-                  uint64 virt_addr = ((pml4i) << (9 + 9 + 9 + 12)) +
-                                     ((pdpti) << (9 + 9 + 12)) +
-                                     ((pdi)   << (9 + 12)) +
-                                     ((pti)   << (12));
 
                   // TODO: to enable cow we need to pass the old page_ppn into this function
                   bool vpn_mapped = copyPageHierarchy(virt_addr / PAGE_SIZE, phys_page,
@@ -495,13 +503,12 @@ void ArchMemory::copyPagesToNewArchMemCOW(ArchMemory &new_mem, size_t pid1, size
 
               for (uint64 pti = 0; pti < PAGE_TABLE_ENTRIES; pti++)
               {
-                if (pt[pti].present)
+                uint64 virt_addr = ((pml4i) << (9 + 9 + 9 + 12)) +
+                                   ((pdpti) << (9 + 9 + 12)) +
+                                   ((pdi)   << (9 + 12)) +
+                                   ((pti)   << (12));
+                if (pt[pti].present && !isVdsoPage(virt_addr / PAGE_SIZE))
                 {
-                  uint64 virt_addr = ((pml4i) << (9 + 9 + 9 + 12)) +
-                                     ((pdpti) << (9 + 9 + 12)) +
-                                     ((pdi)   << (9 + 12)) +
-                                     ((pti)   << (12));
-
                   // the same ppn as in the old archmem is passed to the function to enable cow
                   bool vpn_mapped = copyPageHierarchy(virt_addr / PAGE_SIZE, pt[pti].page_ppn,
                                                       new_mem, 0);
@@ -515,6 +522,7 @@ void ArchMemory::copyPagesToNewArchMemCOW(ArchMemory &new_mem, size_t pid1, size
 
                 }
               }
+              Scheduler::instance()->condResched();
             }
           }
         }
@@ -6,21 +6,143 @@
 #include "assert.h"
 #include "Thread.h"
 #include "kstring.h"
+#include "ArchInterrupts.h"
 
 extern PageMapLevel4Entry kernel_page_map_level_4[];
 
+#define CR0_MP         0x2
+#define CR0_EM         0x4
+#define CR0_TS         0x8
+#define CR4_OSFXSR     0x200
+#define CR4_OSXMMEXCPT 0x400
+#define CR4_OSXSAVE    0x40000
+#define CPUID_ECX_XSAVE (1 << 26)
+#define CPUID_ECX_AVX   (1 << 28)
+#define XCR0_X87       0x1
+#define XCR0_SSE       0x2
+#define XCR0_AVX       0x4
+#define FXSAVE_SIZE    512
+#define FPU_ALIGNMENT  64
+
+ArchThreadRegisters* ArchThreads::fpu_owner_ = 0;
+size_t ArchThreads::fpu_state_size_ = FXSAVE_SIZE;
+bool ArchThreads::fpu_xsave_ = false;
+bool ArchThreads::fpu_trap_set_ = false;
+
 void ArchThreads::initialise()
 {
   currentThreadRegisters = new ArchThreadRegisters{};
 
-  /** Enable SSE for floating point instructions in long mode **/
-  asm volatile ("movq %%cr0, %%rax\n"
-          "and $0xFFFB, %%ax\n"
-          "or $0x2, %%ax\n"
-          "movq %%rax, %%cr0\n"
-          "movq %%cr4, %%rax\n"
-          "orq $0x200, %%rax\n"
-          "movq %%rax, %%cr4\n" : : : "rax");
+  initialiseFpu();
+}
+
+void ArchThreads::initialiseFpu()
+{
+  uint32 eax, ebx, ecx, edx;
+  asm volatile("cpuid" : "=a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx) : "a"(1), "c"(0));
+
+  /** Enable SSE for floating point instructions in long mode, the FPU starts out trapping (lazy switching) **/
+  uint64 cr0, cr4;
+  asm volatile("movq %%cr0, %0\n" "movq %%cr4, %1\n" : "=r"(cr0), "=r"(cr4));
+  cr0 = (cr0 & ~(uint64)CR0_EM) | CR0_MP | CR0_TS;
+  cr4 |= CR4_OSFXSR | CR4_OSXMMEXCPT;
+  if (ecx & CPUID_ECX_XSAVE)
+    cr4 |= CR4_OSXSAVE;
+  asm volatile("movq %0, %%cr0\n" "movq %1, %%cr4\n" : : "r"(cr0), "r"(cr4));
+  fpu_trap_set_ = true;
+
+  if (ecx & CPUID_ECX_XSAVE)
+  {
+    uint64 xcr0 = XCR0_X87 | XCR0_SSE | ((ecx & CPUID_ECX_AVX) ? XCR0_AVX : 0);
+    asm volatile("xsetbv" : : "c"(0), "a"((uint32)xcr0), "d"((uint32)(xcr0 >> 32)));
+    // ebx reports the area size for the features enabled in xcr0
+    asm volatile("cpuid" : "=a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx) : "a"(0xD), "c"(0));
+    fpu_xsave_ = true;
+    fpu_state_size_ = ebx;
+  }
+  debug(A_INTERRUPTS, "FPU: lazy switching using %s, %zu byte state\n", fpu_xsave_ ? "XSAVE" : "FXSAVE", fpu_state_size_);
+}
+
+void ArchThreads::allocateFpuState(ArchThreadRegisters* info)
+{
+  assert(!info->fpu);
+  uint8* memory = new uint8[fpu_state_size_ + FPU_ALIGNMENT];
+  uint8* area = (uint8*)(((size_t)memory + FPU_ALIGNMENT - 1) & ~(size_t)(FPU_ALIGNMENT - 1));
+  memset(area, 0, fpu_state_size_);
+  *(uint16*)(area + 0) = 0x037F;  // fcw (=fninit)
+  *(uint32*)(area + 24) = 0x1F80; // mxcsr, all exceptions masked
+  // the xsave header (xstate_bv = 0) is zero, so everything else starts in its init state
+  info->fpu_memory = memory;
+  info->fpu = area;
+}
+
+void ArchThreads::saveFpuState(ArchThreadRegisters* info)
+{
+  assert(info->fpu);
+  asm volatile("clts");
+  fpu_trap_set_ = false;
+  if (fpu_xsave_)
+    asm volatile("xsaveq %0" : "=m"(*info->fpu) : "a"(-1U), "d"(-1U) : "memory");
+  else
+    asm volatile("fxsaveq %0" : "=m"(*info->fpu) : : "memory");
+}
+
+void ArchThreads::restoreFpuState(ArchThreadRegisters* info)
+{
+  assert(info->fpu);
+  if (fpu_xsave_)
+    asm volatile("xrstorq %0" : : "m"(*info->fpu), "a"(-1U), "d"(-1U) : "memory");
+  else
+    asm volatile("fxrstorq %0" : : "m"(*info->fpu) : "memory");
+}
+
+void ArchThreads::switchFpuOwner(ArchThreadRegisters* info)
+{
+  asm volatile("clts");
+  fpu_trap_set_ = false;
+  if (fpu_owner_ == info)
+    return;
+  if (fpu_owner_)
+    saveFpuState(fpu_owner_);
+  restoreFpuState(info);
+  fpu_owner_ = info;
+}
+
+void ArchThreads::updateFpuTrap(const ArchThreadRegisters* info)
+{
+  bool trap = (fpu_owner_ != info);
+  if (trap == fpu_trap_set_)
+    return;
+  uint64 cr0;
+  asm volatile("movq %%cr0, %0\n" : "=r"(cr0));
+  cr0 = trap ? (cr0 | CR0_TS) : (cr0 & ~(uint64)CR0_TS);
+  asm volatile("movq %0, %%cr0\n" : : "r"(cr0));
+  fpu_trap_set_ = trap;
+}
+
+ArchThreadRegisters::ArchThreadRegisters(const ArchThreadRegisters& src) :
+    ArchCpuRegisters(src), fpu(0), fpu_memory(0)
+{
+  if (!src.fpu)
+    return;
+  ArchThreads::allocateFpuState(this);
+  bool interrupts = ArchInterrupts::disableInterrupts();
+  // the live state of the owner is still in the fpu registers
+  if (ArchThreads::fpu_owner_ == &src)
+    ArchThreads::saveFpuState(const_cast<ArchThreadRegisters*>(&src));
+  memcpy(fpu, src.fpu, ArchThreads::fpu_state_size_);
+  if (interrupts)
+    ArchInterrupts::enableInterrupts();
+}
+
+ArchThreadRegisters::~ArchThreadRegisters()
+{
+  bool interrupts = ArchInterrupts::disableInterrupts();
+  if (ArchThreads::fpu_owner_ == this)
+    ArchThreads::fpu_owner_ = 0;
+  if (interrupts)
+    ArchInterrupts::enableInterrupts();
+  delete[] fpu_memory;
 }
 
 void ArchThreads::setAddressSpace(Thread *thread, ArchMemory& arch_memory)
@@ -47,15 +169,6 @@ void ArchThreads::createBaseThreadRegisters(ArchThreadRegisters *&info, void* st
   info->rsp     = (size_t)stack;          // StackTopAddr
   info->rbp     = (size_t)stack;          // StackBaseAddr
   info->rip     = (size_t)start_function; // InstructionPointer
-
-  /* fpu (=fninit) */
-  info->fpu[0] = 0xFFFF037F;
-  info->fpu[1] = 0xFFFF0000;
-  info->fpu[2] = 0xFFFFFFFF;
-  info->fpu[3] = 0x00000000;
-  info->fpu[4] = 0x00000000;
-  info->fpu[5] = 0x00000000;
-  info->fpu[6] = 0xFFFF0000;
 }
 
 void ArchThreads::createKernelRegisters(ArchThreadRegisters *&info, void* start_function, void* kernel_stack)
@@ -85,6 +85,39 @@ extern "C" void arch_dummyHandlerMiddle();
 uint64 InterruptUtils::pf_address;
 uint64 InterruptUtils::pf_address_counter;
 
+#define MSR_EFER   0xC0000080
+#define MSR_STAR   0xC0000081
+#define MSR_LSTAR  0xC0000082
+#define MSR_SFMASK 0xC0000084
+#define EFER_SCE   0x1
+
+extern "C" void arch_syscallEntry();
+
+static void writeMSR(uint32 msr, uint64 value)
+{
+  asm volatile("wrmsr" : : "c"(msr), "a"((uint32)value), "d"((uint32)(value >> 32)));
+}
+
+static uint64 readMSR(uint32 msr)
+{
+  uint32 low, high;
+  asm volatile("rdmsr" : "=a"(low), "=d"(high) : "c"(msr));
+  return ((uint64)high << 32) | low;
+}
+
+/**
+ * SYSCALL/SYSRET as fast alternative to int $0x80, both paths end up in syscallHandler
+ */
+static void initialiseFastSyscalls()
+{
+  writeMSR(MSR_STAR, ((uint64)USER_SYSRET_BASE << 48) | ((uint64)KERNEL_CS << 32));
+  writeMSR(MSR_LSTAR, (uint64)arch_syscallEntry);
+  // IF, TF, DF, NT and AC are cleared on entry
+  writeMSR(MSR_SFMASK, 0x44700);
+  writeMSR(MSR_EFER, readMSR(MSR_EFER) | EFER_SCE);
+  debug(A_INTERRUPTS, "SYSCALL entry at %p enabled\n", arch_syscallEntry);
+}
+
 void InterruptUtils::initialise()
 {
   uint32 num_handlers = 0;
@@ -127,6 +160,7 @@ void InterruptUtils::initialise()
   lidt(&idtr);
   pf_address = 0xdeadbeef;
   pf_address_counter = 0;
+  initialiseFastSyscalls();
 }
 
 void InterruptUtils::lidt(IDTR *idtr)
@@ -168,7 +202,7 @@ extern "C" void irqHandler_0()
 
   Scheduler::instance()->incTicks();
 
-  Scheduler::instance()->schedule();
+  Scheduler::instance()->preempt();
 
   //kprintfd("irq0: Going to leave irq Handler 0\n");
   ArchInterrupts::EndOfInterrupt(0);
@@ -196,6 +230,28 @@ extern "C" void pageFaultHandler(uint64 address, uint64 error)
     asm volatile ("movq %%cr3, %%rax; movq %%rax, %%cr3;" ::: "%rax");
 }
 
+extern "C" void fpuNotAvailableHandler(uint64 cs)
+{
+  assert((cs & 0x3) && "The kernel must not use the FPU");
+  ArchThreadRegisters* info = currentThread->user_registers_;
+  assert(info && currentThreadRegisters == info);
+  if (!info->fpu)
+  {
+    // first FPU instruction of this thread, allocating needs interrupts
+    currentThread->switch_to_userspace_ = 0;
+    currentThreadRegisters = currentThread->kernel_registers_;
+    ArchInterrupts::enableInterrupts();
+    ArchThreads::allocateFpuState(info);
+    ArchInterrupts::disableInterrupts();
+    currentThread->switch_to_userspace_ = 1;
+    currentThreadRegisters = info;
+    // we might have been scheduled in the meantime, the tss needs our kernel stack again
+    ArchThreads::switchFpuOwner(info);
+    arch_contextSwitch();
+  }
+  ArchThreads::switchFpuOwner(info);
+}
+
 extern "C" void arch_irqHandler_1();
 extern "C" void irqHandler_1()
 {
@@ -207,21 +263,17 @@ extern "C" void irqHandler_1()
 extern "C" void arch_irqHandler_3();
 extern "C" void irqHandler_3()
 {
-  kprintfd( "IRQ 3 called\n" );
   ++outstanding_EOIs;
   SerialManager::getInstance()->service_irq( 3 );
   ArchInterrupts::EndOfInterrupt(3);
-  kprintfd( "IRQ 3 ended\n" );
 }
 
 extern "C" void arch_irqHandler_4();
 extern "C" void irqHandler_4()
 {
-  kprintfd( "IRQ 4 called\n" );
   ++outstanding_EOIs;
   SerialManager::getInstance()->service_irq( 4 );
   ArchInterrupts::EndOfInterrupt(4);
-  kprintfd( "IRQ 4 ended\n" );
 }
 
 extern "C" void arch_irqHandler_6();
@@ -234,7 +286,6 @@ extern "C" void irqHandler_6()
 extern "C" void arch_irqHandler_9();
 extern "C" void irqHandler_9()
 {
-  kprintfd( "IRQ 9 called\n" );
   ++outstanding_EOIs;
   BDManager::getInstance()->serviceIRQ( 9 );
   ArchInterrupts::EndOfInterrupt(9);
@@ -252,7 +303,6 @@ extern "C" void irqHandler_11()
 extern "C" void arch_irqHandler_14();
 extern "C" void irqHandler_14()
 {
-  //kprintfd( "IRQ 14 called\n" );
   ++outstanding_EOIs;
   BDManager::getInstance()->serviceIRQ( 14 );
   ArchInterrupts::EndOfInterrupt(14);
@@ -261,7 +311,6 @@ extern "C" void irqHandler_14()
 extern "C" void arch_irqHandler_15();
 extern "C" void irqHandler_15()
 {
-  //kprintfd( "IRQ 15 called\n" );
   ++outstanding_EOIs;
   BDManager::getInstance()->serviceIRQ( 15 );
   ArchInterrupts::EndOfInterrupt(15);
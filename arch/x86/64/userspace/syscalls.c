@@ -1,12 +1,34 @@
 #include "types.h"
 
+size_t __syscall_int80(size_t arg1, size_t arg2, size_t arg3,
+                       size_t arg4, size_t arg5, size_t arg6)
+{
+  asm volatile("int $0x80\n"
+    : "=a"(arg1)
+    : "a"(arg1), "b"(arg2), "c"(arg3), "d"(arg4), "S"(arg5), "D"(arg6)
+    : "memory");
+  return arg1;
+}
+
+// define SYSCALL_USE_INT80 to route every syscall through the legacy interrupt gate
+#ifndef SYSCALL_USE_INT80
 size_t __syscall(size_t arg1, size_t arg2, size_t arg3,
                  size_t arg4, size_t arg5, size_t arg6)
 {
-  asm("int $0x80\n"
-    : "=a"(arg1)
-    : "a"(arg1), "b"(arg2), "c"(arg3), "d"(arg4), "S"(arg5), "D"(arg6));
+  // syscall clobbers rcx (return address) and r11 (rflags), arg3 travels in r10
+  register size_t r10 asm("r10") = arg3;
+  asm volatile("syscall\n"
+    : "=a"(arg1), "+r"(r10)
+    : "a"(arg1), "b"(arg2), "d"(arg4), "S"(arg5), "D"(arg6)
+    : "rcx", "r11", "memory");
   return arg1;
 }
+#else
+size_t __syscall(size_t arg1, size_t arg2, size_t arg3,
+                 size_t arg4, size_t arg5, size_t arg6)
+{
+  return __syscall_int80(arg1, arg2, arg3, arg4, arg5, arg6);
+}
+#endif
 
 // [Linux System Calls](https://www.tutorialspoint.com/assembly_programming/assembly_system_calls.htm)
@@ -2,6 +2,7 @@
 
 #include "BDDriver.h"
 #include "Mutex.h"
+#include "WorkQueue.h"
 
 class BDRequest;
 
@@ -61,6 +62,11 @@ class ATADriver : public BDDriver
       return 512;
     }
     ;
+    /**
+     * only acknowledges the interrupt, the data of the active request
+     * is moved by transferBlock on the work queue
+     *
+     */
     void serviceIRQ();
 
     /**
@@ -82,6 +88,19 @@ class ATADriver : public BDDriver
 
     int32 selectSector(uint32 start_sector, uint32 num_sectors);
 
+    /**
+     * moves the next block of the active request, runs on the work queue
+     *
+     */
+    static void transferWork(void* driver);
+    void transferBlock();
+
+    /**
+     * sets the final status of the active request and wakes up its thread
+     *
+     */
+    void finishRequest(BDRequest* br, bool error);
+
     uint32 numsec;
 
     uint16 port;
@@ -95,5 +114,7 @@ class ATADriver : public BDDriver
     BDRequest *request_list_tail_;
 
     Mutex lock_;
+
+    WorkItem transfer_work_;
 };
 
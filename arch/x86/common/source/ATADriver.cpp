@@ -9,6 +9,7 @@
 #include "kprintf.h"
 
 #include "Thread.h"
+#include "WorkQueue.h"
 
 #define TIMEOUT_WARNING() do { kprintfd("%s:%d: timeout. THIS MIGHT CAUSE SERIOUS TROUBLE!\n", __PRETTY_FUNCTION__, __LINE__); } while (0)
 
@@ -20,7 +21,8 @@
                                          BODY;\
                                        }
 
-ATADriver::ATADriver( uint16 baseport, uint16 getdrive, uint16 irqnum ) : lock_("ATADriver::lock_")
+ATADriver::ATADriver( uint16 baseport, uint16 getdrive, uint16 irqnum ) :
+    lock_("ATADriver::lock_"), transfer_work_(&ATADriver::transferWork, this)
 {
   debug(ATA_DRIVER, "ctor: Entered with irgnum %d and baseport %d!!\n", irqnum, baseport);
 
@@ -257,10 +259,7 @@ uint32 ATADriver::addRequest( BDRequest *br )
   {
     if(interrupt_context)
       ArchInterrupts::enableInterrupts();
-    jiffies = 0;
-    while (br->getStatus() == BDRequest::BD_QUEUED && jiffies++ < IO_TIMEOUT*10);
-    if (jiffies >= IO_TIMEOUT*10)
-      TIMEOUT_WARNING();
+    // no point in spinning, the data is moved by the work queue which needs the cpu
     if (br->getStatus() == BDRequest::BD_QUEUED)
     {
       ArchInterrupts::disableInterrupts();
@@ -304,6 +303,16 @@ void ATADriver::nextRequest(BDRequest* br)
   request_list_ = br->getNextRequest();
 }
 
+void ATADriver::finishRequest(BDRequest* br, bool error)
+{
+  // the requesting thread may return and drop br as soon as it sees the new status
+  bool interrupts = ArchInterrupts::disableInterrupts();
+  br->setStatus( error ? BDRequest::BD_ERROR : BDRequest::BD_DONE );
+  nextRequest(br);
+  if( interrupts )
+    ArchInterrupts::enableInterrupts();
+}
+
 void ATADriver::serviceIRQ()
 {
   if( mode == BD_PIO_NO_IRQ )
@@ -318,8 +327,23 @@ void ATADriver::serviceIRQ()
     return; // not my interrupt
   }
 
+  // reading the status register acknowledges the interrupt,
+  // the drive waits for us with the next block until the data is moved
+  inportbp( port + 7 );
+  WorkQueue::instance()->queue( &transfer_work_ );
+}
+
+void ATADriver::transferWork(void* driver)
+{
+  ((ATADriver*) driver)->transferBlock();
+}
+
+void ATADriver::transferBlock()
+{
   BDRequest* br = request_list_;
-  debug(ATA_DRIVER, "serviceIRQ: Found active request!!\n");
+  if( br == 0 )
+    return;
+  debug(ATA_DRIVER, "transferBlock: Found active request!!\n");
 
   uint16* word_buff = (uint16*) br->getBuffer();
   uint32 counter;
@@ -329,8 +353,7 @@ void ATADriver::serviceIRQ()
   {
     if( !waitForController() )
     {
-      br->setStatus( BDRequest::BD_ERROR );
-      nextRequest(br);
+      finishRequest(br, true);
       return;
     }
 
@@ -341,30 +364,24 @@ void ATADriver::serviceIRQ()
     br->setBlocksDone( blocks_done );
 
     if( blocks_done == br->getNumBlocks() )
-    {
-      br->setStatus( BDRequest::BD_DONE );
-      nextRequest(br);
-    }
+      finishRequest(br, false);
   }
   else if( br->getCmd() == BDRequest::BD_WRITE )
   {
     blocks_done++;
     if( blocks_done == br->getNumBlocks() )
     {
-      debug(ATA_DRIVER, "serviceIRQ:All done!!\n");
-      br->setStatus( BDRequest::BD_DONE );
-      debug(ATA_DRIVER, "serviceIRQ:Waking up thread!!\n");
-      nextRequest(br);
+      debug(ATA_DRIVER, "transferBlock:All done, waking up thread!!\n");
+      finishRequest(br, false);
     }
     else
     {
       if( !waitForController() )
       {
-        br->setStatus( BDRequest::BD_ERROR );
-        nextRequest(br);
+        finishRequest(br, true);
         return;
       }
-  
+
       for(counter = blocks_done*256; counter != (blocks_done + 1) * 256; counter++ )
         outportw ( port, word_buff [counter] );
 
@@ -373,10 +390,8 @@ void ATADriver::serviceIRQ()
   }
   else
   {
-    blocks_done = br->getNumBlocks();
-    br->setStatus( BDRequest::BD_ERROR );
-    nextRequest(br);
+    finishRequest(br, true);
   }
 
-  debug(ATA_DRIVER, "serviceIRQ:Request handled!!\n");
+  debug(ATA_DRIVER, "transferBlock:Request handled!!\n");
 }
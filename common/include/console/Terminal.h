@@ -3,6 +3,11 @@
 #include "types.h"
 #include "Console.h"
 #include "chardev.h"
+#include "Poll.h"
+#include "Mutex.h"
+#include "Condition.h"
+#include "RingBuffer.h"
+#include "termios-definitions.h"
 
 class Terminal : public CharacterDevice
 {
@@ -60,42 +65,60 @@ class Terminal : public CharacterDevice
     void setBackgroundColor(Console::CONSOLECOLOR const &color);
 
     /**
-     * Reads one character.from the input
+     * Reads one character from the input, waits for it like readLine
      * @return the character read
      */
     char read();
 
     /**
-     * Reads the given number of characters from the input or until the end of line.
-     * @param line the buffer to write
-     * @param size the number of characters to read
-     * @return the number of chracters read
+     * Reads from the input as the line discipline says:
+     * in canonical mode it waits for a complete line and reads at most up to and including its '\n',
+     * in raw mode it waits for VMIN characters and reads what there is, with VMIN 0 it does not wait.
+     * At most TERMINAL_BUFFER_SIZE characters are read at once, a canonical line is never longer.
+     * @param line the buffer to write, may be user memory, \0 terminated if there is space left
+     * @param size the number of characters to read at most
+     * @return the number of characters read, -1 if the waiting thread got cancelled
      */
-    uint32 readLine(char *line, uint32 size);
+    size_t readLine(char *line, size_t size);
 
     /**
-     * Reads the given number of characters from the input or until the end of line.
-     * and don't remove control characters from the string
-     * @param line the buffer to write
-     * @param size the number of characters to read
-     * @return the number of chracters read
+     * Discards the input that was not read yet, including the line being edited.
      */
-    uint32 readLineRaw(char *line, uint32 size);
+    void clearBuffer();
 
     /**
-     * Reads the given number of characters from the input or until the end of line
-     * or until there is no more input
-     * @param line the buffer to write
-     * @param size the number of characters to read
-     * @return the number of chracters read
+     * Feeds a batch of keyboard input through the line discipline, echoing it if ECHO is set.
+     * In canonical mode '\b' erases the last character of the line being edited and the line
+     * only becomes readable with its '\n'. Readers are woken at most once per batch, and only
+     * if they can make progress.
+     * @param keys the input
+     * @param count the number of characters
      */
-    uint32 readLineNoBlock(char *line, uint32 size);
+    void putInBuffer(const char *keys, size_t count);
 
-    void clearBuffer();
-    void putInBuffer(uint32 key);
+    /**
+     * @param entry registers the polling thread on the input if not nullptr
+     * @return POLLIN if a read does not block
+     */
+    uint32 poll(PollEntry* entry);
+
+    /**
+     * wakes up the threads blocked in readLine or poll, so that a cancelled thread notices its cancellation
+     */
+    void wakeUpAll();
+
+    void getAttributes(termios &attributes);
+
+    /**
+     * Switches the line discipline. The line being edited becomes readable as it is when leaving canonical mode.
+     */
+    void setAttributes(termios const &attributes);
 
     void initTerminalColors(Console::CONSOLECOLOR fg, Console::CONSOLECOLOR bg);
 
+    /**
+     * Erases the character left of the cursor from the screen.
+     */
     void backspace();
 
     /**
@@ -132,6 +155,11 @@ class Terminal : public CharacterDevice
     uint32 setCharacter(uint32 row, uint32 column, uint8 character);
     void scrollUp();
 
+    /**
+     * @return whether a read has to wait for more input
+     */
+    bool readWouldBlock();
+
     bool isLetter(uint32 key);
     bool isNumber(uint32 key);
 
@@ -154,5 +182,21 @@ class Terminal : public CharacterDevice
 
     LAYOUTS layout_;
 
+    PollWaitQueue poll_queue_;
+
+    Mutex input_lock_;
+    Condition input_ready_;
+    termios attributes_;
+
+    // the input readers get, in canonical mode only complete lines go in
+    RingBuffer<char> input_;
+
+    // the number of '\n' in input_
+    size_t lines_;
+
+    // the line being edited in canonical mode
+    char line_[TERMINAL_BUFFER_SIZE];
+    size_t line_length_;
+
 };
 
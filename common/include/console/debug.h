@@ -57,6 +57,9 @@ const size_t USERPROCESS        = Ansi_Cyan    | OUTPUT_ENABLED;
 const size_t PROCESS_REG        = Ansi_Yellow  | OUTPUT_ENABLED;
 const size_t BACKTRACE          = Ansi_Cyan    | OUTPUT_ENABLED;
 const size_t USERTRACE          = Ansi_Red     | OUTPUT_ENABLED;
+const size_t CLOCKSOURCE        = Ansi_Green   | OUTPUT_ENABLED;
+const size_t FUTEX              = Ansi_Cyan;
+const size_t WORKQUEUE          = Ansi_Magenta;
 
 //group memory management
 const size_t PM                 = Ansi_Green | OUTPUT_ENABLED;
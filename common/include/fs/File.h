@@ -143,6 +143,28 @@ class File
       return 0;
     }
 
+    /**
+     * reads from an absolute position, the file position stays as it is
+     */
+    int32 readAt(char *buffer, size_t count, l_off_t position)
+    {
+      l_off_t offset = offset_;
+      int32 num_read = read(buffer, count, position - offset);
+      offset_ = offset;
+      return num_read;
+    }
+
+    /**
+     * writes to an absolute position, the file position stays as it is
+     */
+    int32 writeAt(const char *buffer, size_t count, l_off_t position)
+    {
+      l_off_t offset = offset_;
+      int32 written = write(buffer, count, position - offset);
+      offset_ = offset;
+      return written;
+    }
+
     /**
      * Opens the file
      * @param inode is the inode the read the file from.
@@ -2,6 +2,8 @@
 
 #include "types.h"
 
+#define VFS_COPY_CHUNK_SIZE (16 * 1024) // a multiple of the block and zone sizes, so copies stay aligned
+
 class Dirent;
 class Dentry;
 class VfsMount;
@@ -19,6 +21,11 @@ class VfsSyscall
      */
     static int32 dupChecking(const char* pathname, Dentry*& pw_dentry, VfsMount*& pw_vfs_mount);
 
+    /**
+     * open() with the dentry tree already locked, for reading unless O_CREAT is set
+     */
+    static int32 openLocked(const char* pathname, uint32 flag);
+
   public:
 
     /**
@@ -76,6 +83,26 @@ class VfsSyscall
      */
     static int32 close(uint32 fd);
 
+    /**
+     * close, read, lseek and write on a descriptor that was already looked up,
+     * e.g. by an open file of a process, so the global fd list is not searched
+     */
+    static int32 close(FileDescriptor* file_descriptor);
+    static int32 read(FileDescriptor* file_descriptor, char* buffer, uint32 count);
+    static l_off_t lseek(FileDescriptor* file_descriptor, l_off_t offset, uint8 origin);
+    static int32 write(FileDescriptor* file_descriptor, const char *buffer, uint32 count);
+
+    /**
+     * copies between two files in the kernel, in chunks aligned to VFS_COPY_CHUNK_SIZE in the source
+     * @param in_position where to read from, the file position of in is used and advanced if nullptr,
+     *        otherwise it is advanced and the file position stays
+     * @param out_position the same for out
+     * @return the number of bytes copied (less at the end of in), -1 on error or if the ranges
+     *         of one file overlap
+     */
+    static int32 copyFileRange(FileDescriptor* in, l_off_t* in_position, FileDescriptor* out,
+                               l_off_t* out_position, uint32 count);
+
     /**
      * The read() attempts to read up to count bytes from file descriptor fd
      * into the buffer starting at buffter.
@@ -116,6 +143,7 @@ class VfsSyscall
      * @return 0 on success, -1 on error
      */
     static int32 flush(uint32 fd);
+    static int32 flush(FileDescriptor* file_descriptor);
 
     /**
      * mounts a file system
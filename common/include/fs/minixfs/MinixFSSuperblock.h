@@ -3,6 +3,9 @@
 #include "Superblock.h"
 #include "MinixStorageManager.h"
 #include "umap.h"
+#ifndef EXE2MINIXFS
+#include "Mutex.h"
+#endif
 
 class Inode;
 class MinixFSInode;
@@ -213,5 +216,11 @@ class MinixFSSuperblock : public Superblock
      * pointer to self for compatability
      */
     Superblock* superblock_;
+
+    /**
+     * Protects all_inodes_set_ and the open file lists. Path walks only read the dentry tree,
+     * so two of them may load the children of a directory or open a file at the same time.
+     */
+    Mutex inode_list_lock_;
 };
 
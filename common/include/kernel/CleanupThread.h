@@ -9,5 +9,16 @@ class CleanupThread : public Thread
     virtual ~CleanupThread();
     virtual void kill();
     virtual void Run();
+
+    /**
+     * wakes the cleanup thread up if it sleeps, may be called with interrupts disabled
+     */
+    void wakeUp();
+
+  private:
+    /**
+     * set while the cleanup thread sleeps because there are no dead threads
+     */
+    size_t idle_;
 };
 
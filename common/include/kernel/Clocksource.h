@@ -0,0 +1,85 @@
+#pragma once
+
+#include "types.h"
+
+#define PIT_FREQUENCY 1193182 // Hz of the PIT input clock
+#define TSC_CALIBRATION_MS 50 // length of one PIT measurement window
+#define TSC_CALIBRATION_RUNS 3 // the shortest of these windows is used
+#define TSC_MULT_SHIFT 32
+
+#define NS_PER_SEC 1000000000ULL
+#define NS_PER_USEC 1000ULL
+
+#define SLEEP_SPIN_NS 1000000ULL // a sleep remainder shorter than this is polled instead of slept
+
+// clock ids, kept in sync with userspace/libc/include/time.h
+#define CLOCK_REALTIME 0
+#define CLOCK_MONOTONIC 1
+#define CLOCK_PROCESS_CPUTIME_ID 2
+
+struct kernel_timespec
+{
+  int64 tv_sec;
+  int64 tv_nsec;
+};
+
+/**
+ * The TSC based clocksource. The TSC frequency is measured against the PIT
+ * once at boot, afterwards cycles are converted to nanoseconds with a
+ * multiply and a shift: ns = (cycles * mult) >> TSC_MULT_SHIFT
+ */
+class Clocksource
+{
+  public:
+    static Clocksource *instance();
+
+    /**
+     * measures the TSC frequency with PIT channel 2 (needs no interrupts),
+     * has to be called once at boot before anyone converts time
+     */
+    void calibrate();
+
+    /**
+     * @return the raw time stamp counter
+     */
+    uint64 getCycles();
+
+    /**
+     * @return nanoseconds since calibrate(), never goes backwards
+     */
+    uint64 getMonotonicNs();
+
+    uint64 cyclesToNs(uint64 cycles);
+    uint64 nsToCycles(uint64 ns);
+
+    /**
+     * @return true if the cpu reports a TSC that ticks at a constant rate in all
+     * P-/C-states (CPUID 0x80000007 EDX bit 8)
+     */
+    bool isInvariant();
+
+    uint64 getTSCFrequency();
+    uint64 getMult();
+    uint64 getBootCycles();
+
+    /**
+     * @return length of one timer interrupt period
+     */
+    uint64 getTickNs();
+    uint64 getTickCycles();
+
+  private:
+    Clocksource();
+
+    uint64 measureCyclesPerWindow();
+    bool detectInvariantTSC();
+
+    static Clocksource *instance_;
+
+    uint64 tsc_hz_;
+    uint64 mult_;
+    uint64 boot_cycles_;
+    uint64 tick_ns_;
+    uint64 tick_cycles_;
+    bool invariant_;
+};
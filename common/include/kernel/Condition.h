@@ -37,6 +37,8 @@ class Condition : public Lock
 
     /**
      * Wakes up the first Thread on the sleepers list.
+     * A thread that re-acquires the mutex after the wait is not woken up, but moved to
+     * the waiters list of the mutex, so that it runs once the mutex is released.
      * If the list is empty, signal is being lost.
      * @param called_by A pointer to the call point of this function.
      *                  Can be set in case this method is called by a wrapper function.
@@ -52,6 +54,11 @@ class Condition : public Lock
     void broadcast(pointer called_by = 0);
 
   private:
+    /**
+     * Wait morphing: queue a signaled thread on the mutex instead of waking it up.
+     */
+    void moveToMutex(Thread* thread);
+
     /**
      * The mutex which is bound to this condition.
      */
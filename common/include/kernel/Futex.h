@@ -0,0 +1,89 @@
+#pragma once
+
+#include "types.h"
+#include "Mutex.h"
+#include <ulist.h>
+
+#define FUTEX_HASH_BUCKETS 64
+
+// futex operations, kept in sync with userspace/libc/include/sys/futex.h
+#define FUTEX_WAIT 0
+#define FUTEX_WAKE 1
+#define FUTEX_REQUEUE 3
+
+class Thread;
+class Loader;
+
+/**
+ * Wait queues for userspace synchronisation. There is no shared memory, so all futexes
+ * are private: waiters are keyed by the address space and the virtual address of the
+ * futex word. Unlike the physical address, that key stays the same when a fork makes
+ * the page copy on write again. Uncontended locks never get here.
+ */
+class Futex
+{
+  public:
+    static Futex *instance();
+
+    /**
+     * sleeps until woken, but only if *address still contains expected
+     * @return 0 if woken, -1U if the value did not match or the address is invalid
+     */
+    size_t wait(uint32* address, uint32 expected);
+
+    /**
+     * wakes up to count threads waiting on address
+     * @return the number of threads woken
+     */
+    size_t wake(uint32* address, size_t count);
+
+    /**
+     * wakes up to count threads waiting on address and moves up to requeue_count
+     * of the remaining ones over to the queue of address2 (avoids a thundering herd
+     * on condition variable broadcasts)
+     * @return the number of threads woken
+     */
+    size_t requeue(uint32* address, size_t count, uint32* address2, size_t requeue_count);
+
+    /**
+     * wakes thread if it sleeps in wait(), used for cancellation
+     */
+    void wakeThread(Thread* thread);
+
+  private:
+    Futex();
+
+    struct Key
+    {
+      Loader* space;
+      size_t address;
+
+      bool operator==(Key const& other) const
+      {
+        return space == other.space && address == other.address;
+      }
+    };
+
+    struct Waiter
+    {
+      Key key;
+      Thread* thread;
+    };
+
+    struct Bucket
+    {
+      Bucket() : lock_("Futex::Bucket::lock_") {}
+      Mutex lock_;
+      ustl::list<Waiter*> waiters_;
+    };
+
+    /**
+     * @return false if address is no valid futex word of the current process
+     */
+    bool getKey(uint32* address, Key& key);
+    Bucket& getBucket(Key const& key);
+
+    Bucket buckets_[FUTEX_HASH_BUCKETS];
+
+    static Futex *instance_;
+};
@@ -30,6 +30,12 @@ class Loader
      */
     void loadPage(pointer virtual_address);
 
+    /**
+     * maps the read-only vdso time page and the given process page into the address space
+     * @param process_page_ppn ppn of the vdso_process_data page of the process
+     */
+    void mapVdso(size_t process_page_ppn);
+
     Stabs2DebugInfo const* getDebugInfos() const;
 
     void* getEntryFunction() const;
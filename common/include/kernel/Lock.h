@@ -4,6 +4,45 @@
 
 class Thread;
 
+#define LOCK_MAX_CLASSES 64
+#define LOCK_CLASS_NAME_LENGTH 32
+#define LOCK_CLASS_CALL_SITES 4
+#define MUTEX_DEFAULT_SPIN_YIELDS 4
+#define LOCK_CLASS_WORDS ((LOCK_MAX_CLASSES + 63) / 64)
+
+/**
+ * A call point that had to wait for a lock class
+ */
+struct LockCallSite
+{
+  pointer address;
+  size_t count;
+  uint64 wait_cycles;
+};
+
+/**
+ * Contention profile (and mutex spin tuning), shared by all locks with the same name
+ */
+struct LockClass
+{
+  char name[LOCK_CLASS_NAME_LENGTH];
+  size_t acquisitions;
+  size_t contended;
+  uint64 wait_cycles;
+  uint64 max_wait_cycles;
+  uint64 hold_cycles;
+  uint64 max_hold_cycles;
+  LockCallSite call_sites[LOCK_CLASS_CALL_SITES]; // the call points that waited most often
+  size_t spin_limit;           // mutex only: yields to a runnable holder before going to sleep
+  size_t acquired_spinning;
+  size_t spin_yields;
+  bool shared;                 // the overflow class, several names ended up here
+#ifdef LOCKDEP
+  uint64 nested[LOCK_CLASS_WORDS];         // classes that have been acquired while holding this one
+  pointer nested_at[LOCK_MAX_CLASSES];     // where that happened first
+#endif
+};
+
 /**
  * This call represents the locks which are used to synchronize the kernel.
  */
@@ -38,6 +77,11 @@ public:
    */
   static void printHoldingList(Thread* thread);
 
+  /**
+   * Print the contention profile of all lock classes, the class that waited longest first.
+   */
+  static void printStatistics();
+
   Thread* heldBy() const
   {
     return held_by_;
@@ -76,6 +120,42 @@ protected:
    */
   pointer last_accessed_at_;
 
+  /**
+   * Contention profile of all locks with our name.
+   */
+  LockClass* class_;
+
+  /**
+   * The cycle counter when the current holder got the lock, for the hold time.
+   */
+  uint64 acquired_at_;
+
+  /**
+   * Look up the class of a lock name, a new class is created on first use.
+   */
+  static LockClass* getClass(const char* name);
+
+  /**
+   * @return the cycle counter, pass it to profileAcquired once the lock has been waited for
+   */
+  static uint64 profileStart();
+
+  /**
+   * Account a waiting time to the lock class and to the waiting call point.
+   * @param wait_start the value of profileStart() before waiting, 0 for an uncontended acquire
+   */
+  void profileWait(pointer called_by, uint64 wait_start);
+
+  /**
+   * Like profileWait, and starts measuring the hold time.
+   */
+  void profileAcquired(pointer called_by, uint64 wait_start);
+
+  /**
+   * Account the hold time, has to be called before the lock is given up.
+   */
+  void profileReleased();
+
   /**
    * Remove the current thread from the holding list.
    */
@@ -97,10 +177,25 @@ protected:
   void removeFromCurrentThreadHoldingList();
 
   /**
-   * Check if a deadlock would happen in case the current thread would wait for this lock.
-   * The circular check is done within this lock.
+   * Check if the current thread already holds this lock, and (with LOCKDEP) the lock order.
+   */
+  void checkForDeadLock(pointer called_by);
+
+#ifdef LOCKDEP
+  /**
+   * Record that our class is acquired after the classes of all locks the current thread holds.
+   * Only an order never seen before is checked for a cycle in the class graph, so every
+   * possible deadlock between lock classes is reported the first time its order shows up,
+   * whether it deadlocks this time or not.
+   */
+  void checkLockOrder(pointer called_by);
+
+  /**
+   * @param print print the steps of the path found, from the one reaching class to backwards
+   * @return true if class to is reachable from class from in the lock order graph
    */
-  void checkForDeadLock();
+  static bool findLockOrderPath(size_t from, size_t to, uint64* visited, bool print);
+#endif
 
   /**
    * Check if the current thread wants to wait on a lock, even if he is still waiting for
@@ -112,8 +207,9 @@ protected:
    * Do some checks before start to wait on another lock.
    * This is done to prevent the kernel from crushing, and is only
    * useful for the kernel programmer.
+   * @param called_by the call point of the acquire, reported with lock order problems
    */
-  void doChecksBeforeWaiting();
+  void doChecksBeforeWaiting(pointer called_by = 0);
 
   /**
    * Verifies that interrupts are enabled.
@@ -160,6 +256,12 @@ protected:
    */
   void pushFrontCurrentThreadToWaitersList();
 
+  /**
+   * Add a sleeping (or just going to sleep) thread to the waiters list of this lock,
+   * used to move a waiter from a condition to its mutex.
+   */
+  void pushFrontThreadToWaitersList(Thread* thread);
+
   /**
    * Print the lock status.
    */
@@ -183,8 +285,11 @@ private:
    * The list can be read out while the lock is not held (for checks and prints).
    * To be able to read out without locking, all modifying accesses have to be atomic!
    * If not, the list may become invalid while someone is reading out of it!
+   * The newest waiter is first, the threads are linked backwards as well, so that
+   * popping the longest waiting thread from the tail takes constant time.
    */
   Thread* waiters_list_;
+  Thread* waiters_list_tail_;
 
   /**
    * The lock for the waiters list. The list has to be locked for writing access,
@@ -192,18 +297,8 @@ private:
    */
   size_t waiters_list_lock_;
 
-  /**
-   * Check if a deadlock would happen in combination with other locks.
-   * @param thread_waiting The thread which wants to wait on the lock
-   * @param start The lock which the thread wants to wait on
-   */
-  void checkForCircularDeadLock(Thread* thread_waiting, Lock* start);
-
-  /**
-   * Print out a circular deadlock hierarchy.
-   * @param starting The thread which shall be started at
-   */
-  void printOutCircularDeadLock(Thread* starting);
+  static LockClass classes_[LOCK_MAX_CLASSES];
+  static size_t num_classes_;
 
 };
 
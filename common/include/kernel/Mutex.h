@@ -5,6 +5,8 @@
 #include "Lock.h"
 class Thread;
 
+#define MUTEX_SHORT_SECTION_SPIN_YIELDS 16 // for locks that are only held for a few hundred cycles
+
 class Mutex: public Lock
 {
   friend class Scheduler;
@@ -40,8 +42,25 @@ public:
    */
   bool isFree();
 
+  /**
+   * sets how often acquire() yields to a holder that is still runnable before
+   * it goes to sleep, for all mutexes named name (0 sleeps right away)
+   */
+  static void setSpinLimit(const char* name, size_t yields);
+
 private:
 
+  /**
+   * yields to a runnable holder up to limit times
+   * @return true if the mutex was acquired meanwhile
+   */
+  bool spin(size_t limit);
+
+  /**
+   * the old slow path: queue up on the waiters list and sleep until the mutex is free
+   */
+  void acquireSleeping();
+
   /**
    * The basic mutex.
    * It is atomic set to 1 when acquired,
@@ -0,0 +1,178 @@
+#pragma once
+
+#include "types.h"
+#include "Pipe.h"
+#include "Poll.h"
+#include "UnixSocket.h"
+
+class FileDescriptor;
+
+/**
+ * What a process file descriptor refers to: an open vfs file, one end of a pipe, a socket or the terminal.
+ * Reference counted, every fd pointing to it and every syscall working on it holds a reference,
+ * the last unref closes the underlying object. Dup'ed fds and the fds a child inherits on fork
+ * point to the same open file, so they share the file offset.
+ */
+class OpenFile
+{
+  public:
+    enum Type
+    {
+      VFS_FILE,
+      PIPE_END,
+      SOCKET,
+      TERMINAL
+    };
+
+    virtual ~OpenFile();
+
+    OpenFile(OpenFile const&) = delete;
+    OpenFile &operator=(OpenFile const&) = delete;
+
+    Type getType() const
+    {
+      return type_;
+    }
+
+    void ref();
+    void unref();
+
+    /**
+     * @return the number of bytes read, -1 on error
+     */
+    virtual size_t read(char* buffer, size_t count) = 0;
+
+    /**
+     * @return the number of bytes written, -1 on error
+     */
+    virtual size_t write(const char* buffer, size_t count) = 0;
+
+    /**
+     * @return the new offset, -1 if the file is not seekable
+     */
+    virtual l_off_t lseek(l_off_t /*offset*/, uint8 /*origin*/)
+    {
+      return -1;
+    }
+
+    /**
+     * writes the changes to the disk
+     * @return 0 on success, -1 if the file cannot be synced
+     */
+    virtual size_t fsync()
+    {
+      return -1;
+    }
+
+    /**
+     * @param entry registers the polling thread on the wait queue of the object if not nullptr
+     * @return the POLL* events that are ready, a vfs file is always ready
+     */
+    virtual uint32 poll(PollEntry* /*entry*/)
+    {
+      return POLLIN | POLLOUT;
+    }
+
+    /**
+     * wakes up the threads blocked in read, write or poll, so that a cancelled thread notices its cancellation
+     */
+    virtual void wakeUpAll()
+    {
+    }
+
+  protected:
+    OpenFile(Type type);
+
+  private:
+    Type type_;
+    size_t refs_;
+};
+
+class VfsOpenFile : public OpenFile
+{
+  public:
+    /**
+     * takes over the global fd, it is closed with the last reference
+     */
+    VfsOpenFile(FileDescriptor* descriptor);
+    virtual ~VfsOpenFile();
+
+    virtual size_t read(char* buffer, size_t count);
+    virtual size_t write(const char* buffer, size_t count);
+    virtual l_off_t lseek(l_off_t offset, uint8 origin);
+    virtual size_t fsync();
+
+    FileDescriptor* getDescriptor() const
+    {
+      return descriptor_;
+    }
+
+  private:
+    FileDescriptor* descriptor_;
+};
+
+class PipeOpenFile : public OpenFile
+{
+  public:
+    /**
+     * takes over one open end of the pipe, it is closed with the last reference
+     */
+    PipeOpenFile(Pipe* pipe, Pipe::End end);
+    virtual ~PipeOpenFile();
+
+    virtual size_t read(char* buffer, size_t count);
+    virtual size_t write(const char* buffer, size_t count);
+    virtual uint32 poll(PollEntry* entry);
+    virtual void wakeUpAll();
+
+    Pipe* getPipe() const
+    {
+      return pipe_;
+    }
+
+    Pipe::End getEnd() const
+    {
+      return end_;
+    }
+
+  private:
+    Pipe* pipe_;
+    Pipe::End end_;
+};
+
+class SocketOpenFile : public OpenFile
+{
+  public:
+    /**
+     * takes over the reference to the socket, the socket is closed with the last reference
+     */
+    SocketOpenFile(UnixSocket* socket);
+    virtual ~SocketOpenFile();
+
+    virtual size_t read(char* buffer, size_t count);
+    virtual size_t write(const char* buffer, size_t count);
+    virtual uint32 poll(PollEntry* entry);
+    virtual void wakeUpAll();
+
+    UnixSocket* getSocket() const
+    {
+      return socket_;
+    }
+
+  private:
+    UnixSocket* socket_;
+};
+
+/**
+ * stdin reads from the line discipline of the terminal of the calling thread, stdout and stderr go to the console
+ */
+class TerminalOpenFile : public OpenFile
+{
+  public:
+    TerminalOpenFile();
+
+    virtual size_t read(char* buffer, size_t count);
+    virtual size_t write(const char* buffer, size_t count);
+    virtual uint32 poll(PollEntry* entry);
+    virtual void wakeUpAll();
+};
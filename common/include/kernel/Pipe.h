@@ -0,0 +1,106 @@
+#pragma once
+
+#include "types.h"
+#include "paging-definitions.h"
+#include "Mutex.h"
+#include "Condition.h"
+#include "Poll.h"
+#include "RingBuffer.h"
+
+#define PIPE_CAPACITY (4 * PAGE_SIZE) // default size of the pipe buffer
+#define PIPE_ATOMIC_WRITE_SIZE PAGE_SIZE // writes up to this size are not interleaved with other writes (PIPE_BUF)
+
+class OpenFile;
+
+/**
+ * Unidirectional byte stream between the two ends of a pipe.
+ * The data is copied straight between the user buffers and the ring buffer of the pipe, with at
+ * most two memcpys per call. A reader blocks while the pipe is empty, a writer while it is full.
+ * Reading from an empty pipe without writers returns 0 (end of file), writing to a pipe
+ * without readers fails (broken pipe).
+ * The pipe counts how often each end is open, the last close deletes it.
+ */
+class Pipe
+{
+  public:
+    enum End
+    {
+      READ_END,
+      WRITE_END
+    };
+
+    /**
+     * Creates a pipe with both ends opened once
+     * @param capacity size of the buffer in bytes, rounded up to a power of two
+     * @param poll_queue woken instead of the pipe's own queue, for objects made of several pipes
+     */
+    Pipe(size_t capacity = PIPE_CAPACITY, PollWaitQueue* poll_queue = 0);
+    ~Pipe();
+
+    Pipe(Pipe const&) = delete;
+    Pipe &operator=(Pipe const&) = delete;
+
+    /**
+     * @return true if this was the last open end, the caller has to delete the pipe then
+     */
+    bool close(End end);
+
+    /**
+     * Blocks until there is data or no writer is left.
+     * @return the number of bytes read, 0 at end of file, -1 if the thread is cancelled while waiting
+     */
+    size_t read(char* buffer, size_t count);
+
+    /**
+     * Blocks until everything is written or no reader is left.
+     * @return the number of bytes written, -1 if nothing could be written
+     */
+    size_t write(const char* buffer, size_t count);
+
+    /**
+     * Reads from the file straight into the pipe buffer, blocks until there is free space or no reader is left.
+     * Moves at most what fits into the pipe at once, without going through a user buffer.
+     * The file is read without lock_, other writers wait meanwhile.
+     * @return the number of bytes moved, 0 at the end of the file, -1 on error or without readers
+     */
+    size_t spliceFrom(OpenFile* file, size_t count);
+
+    /**
+     * Writes from the pipe buffer straight to the file, blocks until there is data or no writer is left.
+     * The file is written without lock_, other readers wait meanwhile.
+     * @return the number of bytes moved, 0 at end of file, -1 on error
+     */
+    size_t spliceTo(OpenFile* file, size_t count);
+
+    /**
+     * @param entry registers the polling thread on the pipe if not nullptr
+     * @return the POLL* events that are ready for the given end
+     */
+    uint32 poll(End end, PollEntry* entry);
+
+    /**
+     * Wakes up all threads blocked on the pipe, so that a cancelled thread notices its cancellation.
+     */
+    void wakeUpAll();
+
+  private:
+    /**
+     * only changed with lock_ held, so any number of readers and writers can share it
+     */
+    RingBuffer<char> buffer_;
+
+    size_t readers_;
+    size_t writers_;
+
+    /**
+     * a splice owns the free space (in) or the data (out) of the buffer while it does file I/O without lock_
+     */
+    bool splicing_in_;
+    bool splicing_out_;
+
+    Mutex lock_;
+    Condition not_empty_;
+    Condition not_full_;
+    PollWaitQueue own_poll_queue_;
+    PollWaitQueue* poll_queue_;
+};
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "types.h"
+#include "Mutex.h"
+#include <ulist.h>
+#include "poll-definitions.h"
+
+class Thread;
+class Poller;
+class PollWaitQueue;
+
+/**
+ * One registration of a polling thread on the wait queue of a pipe, a terminal, ...
+ */
+struct PollEntry
+{
+  Poller* poller_;
+  PollWaitQueue* queue_;
+};
+
+/**
+ * The threads polling an object. The object wakes them whenever it may have become
+ * readable or writable, they check again then.
+ */
+class PollWaitQueue
+{
+  public:
+    PollWaitQueue(const char* name);
+
+    PollWaitQueue(PollWaitQueue const&) = delete;
+    PollWaitQueue &operator=(PollWaitQueue const&) = delete;
+
+    void add(PollEntry* entry);
+    void remove(PollEntry* entry);
+
+    /**
+     * Has to be called after the state of the object changed, a poller that registered
+     * before the change is woken up, one that registers afterwards sees the new state.
+     */
+    void wakeUpAll();
+
+  private:
+    Mutex lock_;
+    ustl::list<PollEntry*> entries_;
+
+    /**
+     * entries_.size(), read without the lock, so that there is no locking if nobody polls
+     */
+    size_t num_entries_;
+};
+
+/**
+ * The polling thread, it sleeps until one of its wait queues wakes it up or the timeout elapsed.
+ */
+class Poller
+{
+  public:
+    Poller();
+
+    Poller(Poller const&) = delete;
+    Poller &operator=(Poller const&) = delete;
+
+    /**
+     * Has to be called before the objects are checked, a wakeup after it is not lost.
+     */
+    void arm();
+
+    /**
+     * Sleeps unless there was a wakeup since arm().
+     * @param deadline cycle count to wake up at, 0 for none
+     */
+    void sleep(uint64 deadline);
+
+    /**
+     * may be called from any thread
+     */
+    void wakeUp();
+
+  private:
+    Thread* thread_;
+    size_t woken_;
+
+    /**
+     * set while the thread sleeps, only the one clearing it wakes the thread
+     */
+    size_t sleeping_;
+};
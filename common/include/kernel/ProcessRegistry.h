@@ -4,7 +4,12 @@
 #include "upair.h"
 #include "Thread.h"
 #include "Mutex.h"
+#include "RWLock.h"
 #include "Condition.h"
+#include "IdAllocator.h"
+#include "SparseArray.h"
+
+#define PROCESS_REGISTRY_MAX_PIDS 32768
 
 class ProcessRegistry : public Thread
 {
@@ -57,7 +62,7 @@ class ProcessRegistry : public Thread
    UserProcess* getUserProcessFromPid(size_t pid);
 
     /**
-     * returns a new pid and increments pid_counter_
+     * returns the next free pid, a pid is free again once processExit was called for it
      */
     size_t getNewPID();
 
@@ -74,7 +79,6 @@ class ProcessRegistry : public Thread
      Condition any_process_died_;
   private:
     void eraseFromProcessList(size_t pid);
-    bool pidInProcessList(size_t pid);
     size_t checkWaitPidDeadlock(size_t pid_to_wait, size_t waited_by);
 
     char const **progs_;
@@ -86,12 +90,11 @@ class ProcessRegistry : public Thread
     ustl::map<size_t, Condition*> waitpid_map_;
     ustl::map<size_t, ustl::vector<size_t>> wait_pid_map_helper_; // MAP< PID_TO_WAIT, vector<WAITED_BY_TID>>
 
-    size_t pid_counter_;
+    IdAllocator pid_allocator_;
     size_t last_dead_pid_;
-    Mutex pid_counter_lock_;
+    Mutex pid_allocator_lock_;
 
-    // TODO rethink this if a more sophisticated approach for handing out pid's is implemented
-    ustl::map<size_t, UserProcess*> process_list_;
-    Mutex process_list_lock_;
+    SparseArray<UserProcess*> process_list_; // pid -> process
+    RWLock process_list_lock_;
 };
 
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "types.h"
+#include "Lock.h"
+class Thread;
+
+#define RWLOCK_TRACKED_READERS 8
+
+/**
+ * Reader-writer lock for read-mostly kernel tables.
+ * Any number of readers may hold the lock at the same time, a writer holds it alone.
+ * Writers are preferred: as soon as a writer waits, no new reader gets in, so a
+ * steady stream of readers cannot starve it (and a reader must not acquire twice).
+ *
+ * The writer is held_by_ and on its holding list like the owner of a Mutex. Readers
+ * are only counted, the first RWLOCK_TRACKED_READERS of them are remembered to catch
+ * recursive reads and read->write upgrades, which would deadlock. Since readers are not
+ * on any holding list, the lock order validator does not see locks taken while reading.
+ */
+class RWLock: public Lock
+{
+public:
+
+  RWLock(const char* name);
+
+  RWLock(RWLock const &) = delete;
+  RWLock &operator=(RWLock const&) = delete;
+
+  /**
+   * Acquire the lock shared, waits while a writer holds the lock or waits for it.
+   * @param called_by A pointer to the call point of this function.
+   *                  Can be set in case this method is called by a wrapper function.
+   */
+  void acquireRead(pointer called_by = 0);
+  void releaseRead(pointer called_by = 0);
+
+  /**
+   * Acquire the lock exclusive, waits until all readers and the writer are gone.
+   */
+  void acquireWrite(pointer called_by = 0);
+  void releaseWrite(pointer called_by = 0);
+
+  size_t getReaderCount() const
+  {
+    return readers_;
+  }
+
+  /**
+   * Print out the readers we know about.
+   */
+  void printReaders();
+
+private:
+
+  /**
+   * Go to sleep until the next release, the waiters list has to be locked.
+   * The waiters list is locked again on return.
+   */
+  void waitForRelease();
+
+  /**
+   * Wake up everybody who waited at the time of the call, they check again on their own.
+   */
+  void wakeWaiters();
+
+  bool isTrackedReader(Thread* thread) const;
+  void trackReader();
+  void untrackReader();
+
+  size_t readers_;
+  size_t writers_waiting_;
+
+  /**
+   * number of threads on the waiters list, protected by the waiters list lock
+   */
+  size_t waiters_;
+
+  Thread* reader_threads_[RWLOCK_TRACKED_READERS];
+
+  /**
+   * readers that did not fit into reader_threads_
+   */
+  size_t untracked_readers_;
+};
+
+class ReadLock
+{
+  public:
+    ReadLock(RWLock &lock);
+    ~ReadLock();
+
+    ReadLock(ReadLock const&) = delete;
+    ReadLock &operator=(ReadLock const&) = delete;
+
+  private:
+    RWLock &lock_;
+};
+
+class WriteLock
+{
+  public:
+    WriteLock(RWLock &lock);
+    ~WriteLock();
+
+    WriteLock(WriteLock const&) = delete;
+    WriteLock &operator=(WriteLock const&) = delete;
+
+  private:
+    RWLock &lock_;
+};
@@ -2,14 +2,21 @@
 
 #include "types.h"
 #include <ulist.h>
+#include <uvector.h>
 #include "IdleThread.h"
 #include "CleanupThread.h"
 #include "Mutex.h"
 #include "Condition.h"
 
 
-#define CALIBRATION_INTERRUPTS 51 // +1 to account for the first interrupt
-#define CALIBRATION_FREQUENCY 300 // Every 300 ticks recalibrate
+#define SCHED_ROUND_ROBIN 0
+#define SCHED_FAIR 1
+#define SCHEDULING_POLICY SCHED_FAIR // SCHED_ROUND_ROBIN restores the plain rotating thread list
+
+#define SCHED_FAIR_GROUPS 1 // 1: all runnable threads of a process share one process-sized slice
+#define SCHED_NICE_MIN -20
+#define SCHED_NICE_MAX 19
+#define SCHED_NICE_0_WEIGHT 1024
 
 class Thread;
 class Mutex;
@@ -28,16 +35,30 @@ class Scheduler
     void printThreadList();
     void printStackTraces();
     void printLockingInformation();
+
+    /**
+     * hands a thread that reached ToBeDestroyed over to the CleanupThread,
+     * lock-free and safe with interrupts disabled (see Thread::kill)
+     */
+    void addDeadThread(Thread *thread);
     bool isSchedulingEnabled();
     bool isCurrentlyCleaningUp();
     void incTicks();
     uint32 getTicks();
 
+    /**
+     * @return the raw cycle counter of the clocksource, see Clocksource for conversions
+     */
     size_t getCurrentTime();
-    size_t getCurrentAVGClocksPerInterrupt();
-    bool getCalibrated();
     size_t getUThreadStartTime();
 
+    /**
+     * changes the nice level of the given thread, the value is clamped to
+     * [SCHED_NICE_MIN, SCHED_NICE_MAX]
+     * @return the new nice level
+     */
+    int32 setNice(Thread *thread, int32 nice);
+
     /**
      * NEVER EVER EVER CALL THIS METHOD OUTSIDE OF AN INTERRUPT CONTEXT
      * this is the method that decides which threads will be scheduled next
@@ -47,11 +68,41 @@ class Scheduler
      */
     uint32 schedule();
 
+    /**
+     * Called by the timer interrupt handler instead of schedule(). Kernel code is preempted
+     * unless the current thread disabled preemption or the scheduler is locked, then the switch
+     * is only remembered and done by preemptEnable or condResched.
+     * @return like schedule(), 0 if the current thread keeps running in kernel context
+     */
+    uint32 preempt();
+
+    /**
+     * Disable preemption by the timer tick for the current thread, e.g. while holding a SpinLock.
+     * Calls nest, a voluntary yield still switches. Interrupts-off sections need no preempt
+     * count, the tick cannot arrive there anyway.
+     */
+    void preemptDisable();
+
+    /**
+     * Undo preemptDisable, yields if the tick wanted to switch meanwhile.
+     */
+    void preemptEnable();
+
+    /**
+     * Scheduling point for long running kernel loops: yields if a preemption is pending and allowed here.
+     */
+    void condResched();
+
   protected:
     friend class IdleThread;
     friend class CleanupThread;
 
-    void cleanupDeadThreads();
+    /**
+     * removes all threads handed over by addDeadThread from the scheduler and deletes them
+     * @return false if there were none
+     */
+    bool cleanupDeadThreads();
+    bool hasDeadThreads();
 
   private:
     Scheduler();
@@ -69,28 +120,57 @@ class Scheduler
      */
     void unlockScheduling();
 
+    /**
+     * checks the sleep timeout of user threads and whether the thread is schedulable at all
+     * (resets an elapsed wakeup time as a side effect)
+     */
+    bool isRunnable(Thread *thread);
+
+    Thread* pickNextRoundRobin();
+    Thread* pickNextFair();
+
+    /**
+     * charges the cycles the current thread has run since it was picked to its vruntime
+     */
+    void chargeCurrentThread(size_t now);
+
+    /**
+     * vruntime heap helpers, the heap is an array based binary min-heap over vruntime_
+     * and every thread knows its own index, so none of these allocate except fairQueueInsert
+     */
+    void fairQueueInsert(Thread *thread);
+    void fairQueueRemove(Thread *thread);
+    void fairQueueSiftUp(size_t index);
+    void fairQueueSiftDown(size_t index);
+    void fairQueueSwap(size_t a, size_t b);
+    void fairQueueFindMin(size_t index, Thread *&best);
+
     static Scheduler *instance_;
 
     typedef ustl::list<Thread*> ThreadList;
     ThreadList threads_;
 
-    size_t block_scheduling_;
+    ustl::vector<Thread*> fair_queue_;
+    uint64 min_vruntime_;
+    size_t slice_start_;
 
-    size_t ticks_;
+    size_t block_scheduling_;
 
-    size_t clocks_per_interrupt_;
-    size_t old_clocks_per_interrupt_;
+    /**
+     * set if the timer tick could not preempt the current thread
+     */
+    bool need_resched_;
 
-    size_t prev_time_;
+    size_t ticks_;
 
     size_t uthread_start_;
     size_t uthread_end_;
+
+    /**
+     * dead threads not yet cleaned up, linked by Thread::next_dead_thread_, newest first
+     */
+    Thread* dead_threads_;
     
     IdleThread idle_thread_;
     CleanupThread cleanup_thread_;
-    size_t calibr_ticks_;
-
-    bool calibrated_;
-
-    
 };
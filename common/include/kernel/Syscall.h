@@ -17,7 +17,11 @@ class Syscall
   static size_t write(size_t fd, pointer buffer, size_t size);
   static size_t read(size_t fd, pointer buffer, size_t count);
   static size_t close(size_t fd);
+  static size_t lseek(size_t fd, size_t offset, size_t origin);
   static size_t open(size_t path, size_t flags);
+  static size_t dup(size_t fd);
+  static size_t dup2(size_t old_fd, size_t new_fd);
+  static size_t fsync(size_t fd);
 
   static size_t createprocess(size_t path, size_t sleep);
   static void trace();
@@ -29,5 +33,37 @@ class Syscall
   static size_t waitpid(size_t pid, size_t status, size_t options);
   static size_t execv(pointer path, pointer args);
   static size_t pipe(size_t read, size_t write); //array[0], array[1]
+  static size_t nice(size_t increment);
+  static size_t clock_gettime(size_t clock_id, pointer time_spec);
+  static size_t nanosleep(pointer request, pointer remain);
+  static size_t getpid();
+  static size_t futex(size_t address, size_t op, size_t value, size_t address2, size_t value2);
+  static size_t poll(pointer fds, size_t nfds, size_t timeout_ms);
+  static size_t splice(size_t fd_in, size_t fd_out, size_t count, size_t flags);
+  static size_t vmsplice(size_t fd, pointer iov, size_t nr_segs, size_t flags);
+  static size_t socket(size_t domain, size_t type, size_t protocol);
+  static size_t bind(size_t fd, pointer path);
+  static size_t listen(size_t fd, size_t backlog);
+  static size_t accept(size_t fd);
+  static size_t connect(size_t fd, pointer path);
+  static size_t send(size_t fd, pointer buffer, size_t count, size_t flags);
+  static size_t recv(size_t fd, pointer buffer, size_t count, size_t flags);
+  static size_t io_ring_enter(pointer ring, size_t to_submit);
+  static size_t sendfile(size_t out_fd, size_t in_fd, pointer offset, size_t count);
+  static size_t copy_file_range(size_t in_fd, pointer in_offset, size_t out_fd, pointer out_offset, size_t count);
+  static size_t tcgetattr(size_t fd, pointer attributes);
+  static size_t tcsetattr(size_t fd, size_t optional_actions, pointer attributes);
+  static size_t ioctl(size_t fd, size_t request, pointer arg);
+
+  private:
+  /**
+   * cpu time of the current process including the running slice of the current thread
+   */
+  static uint64 processCpuTimeNs();
+
+  /**
+   * puts the current user thread to sleep for at least ns nanoseconds
+   */
+  static void sleepNs(uint64 ns);
 };
 
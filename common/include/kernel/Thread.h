@@ -100,12 +100,28 @@ class Thread
 
     ThreadState getState() const;
 
+    /**
+     * @return the nice level of this thread, ranging from -20 (highest) to 19 (lowest weight)
+     */
+    int32 getNice() const;
+
+    /**
+     * @return the virtual runtime the fair-share scheduling policy has charged to this thread
+     */
+    uint64 getVRuntime() const;
+
     ArchThreadRegisters* kernel_registers_;
     ArchThreadRegisters* user_registers_;
     uint32 kernel_stack_[2048];
 
     uint32 switch_to_userspace_;
 
+    /**
+     * While > 0 the timer tick does not switch away from this thread, see Scheduler::preemptDisable.
+     * Only changed by the thread itself.
+     */
+    size_t preempt_count_;
+
     Loader* t_loader_;  // Thread Loader Reference, same as Parent Process Loader Reference
 
     void setState(ThreadState state);
@@ -116,12 +132,19 @@ class Thread
      * In case of a spinlock it is a busy-waiter, else usually it is a sleeper ^^.
      */
     Thread* next_thread_in_lock_waiters_list_;
+    Thread* prev_thread_in_lock_waiters_list_;
 
     /**
      * The information which lock the thread is currently waiting on.
      */
     Lock* lock_waiting_on_;
 
+    /**
+     * Set while the thread waits on a condition and takes the mutex again after the wake up.
+     * A signal then moves the thread straight to the waiters list of the mutex (wait morphing).
+     */
+    bool reacquire_after_wait_;
+
     /**
      * A single chained list containing all the locks held by the thread at the moment.
      * This list is not locked. It may only be accessed by the thread himself,
@@ -140,9 +163,30 @@ class Thread
 
     Terminal* my_terminal_;
 
+    /**
+     * Cycles this thread has been running, weighted by its nice level (and, for user threads,
+     * by the thread count of its process). The fair-share policy always picks the runnable
+     * thread with the smallest value.
+     */
+    uint64 vruntime_;
+
+    /**
+     * Position of this thread in the scheduler's vruntime heap, -1 if it is not queued.
+     */
+    ssize_t sched_queue_index_;
+
+    /**
+     * Link in the scheduler's list of threads waiting for the CleanupThread,
+     * dead_queued_ makes sure the thread is put there only once.
+     */
+    Thread* next_dead_thread_;
+    size_t dead_queued_;
+
   protected:
     size_t tid_;
 
+    int32 nice_;
+
     FileSystemInfo* working_dir_;
 
     ustl::string name_;
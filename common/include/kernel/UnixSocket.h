@@ -0,0 +1,208 @@
+#pragma once
+
+#include "types.h"
+#include "Mutex.h"
+#include "Condition.h"
+#include "Pipe.h"
+#include "Poll.h"
+#include "RingBuffer.h"
+#include "socket-definitions.h"
+#include <ulist.h>
+#include <umap.h>
+#include <ustring.h>
+
+#define UNIX_SOCKET_BUFFER_SIZE (4 * PAGE_SIZE) // per direction of a connection, and per datagram socket
+
+class UnixSocket;
+
+/**
+ * The two directions of a stream connection. Each is a pipe, so a sender can only put as
+ * much into it as the receiver has consumed (the free space is the sender's credit), and
+ * closing one socket gives the other one end of file and broken pipe errors.
+ * Both pipes wake the connection's poll queue, a socket polls both at once.
+ */
+struct UnixConnection
+{
+  UnixConnection();
+
+  void ref();
+  void unref();
+
+  PollWaitQueue poll_queue_;
+  Pipe to_acceptor_;
+  Pipe to_connector_;
+
+  /**
+   * the open sockets of the connection and the sends, receives and polls in progress on it,
+   * the last one to drop its reference deletes it
+   */
+  size_t refs_;
+};
+
+/**
+ * A unix domain socket. A stream socket either listens on a name, or is one end of a
+ * connection, created by connect on the one side and accept on the other.
+ * A datagram socket receives the messages sent to its name into a ring buffer, and sends
+ * to the socket it connected to.
+ * Reference counted, the open file holds one reference, a lookup by name and a connected
+ * datagram socket hold the others. close() ends the socket even while references remain.
+ */
+class UnixSocket
+{
+  public:
+    enum Type
+    {
+      STREAM = SOCK_STREAM,
+      DGRAM = SOCK_DGRAM
+    };
+
+    UnixSocket(Type type);
+
+    UnixSocket(UnixSocket const&) = delete;
+    UnixSocket &operator=(UnixSocket const&) = delete;
+
+    void ref();
+    void unref();
+
+    /**
+     * removes the name, closes the connection, fails everyone waiting on the socket
+     */
+    void close();
+
+    /**
+     * @return 0 on success, -1 if the name is taken or the socket already has one
+     */
+    size_t bind(const ustl::string& name);
+
+    /**
+     * @param backlog connections that may wait for accept, at most SOMAXCONN
+     * @return 0 on success, -1 if the socket is not a bound stream socket
+     */
+    size_t listen(size_t backlog);
+
+    /**
+     * blocks until a connection arrives
+     * @return the new connected socket with one reference, nullptr on error or cancellation
+     */
+    UnixSocket* accept();
+
+    /**
+     * a stream socket connects to the listening socket with the name, without waiting
+     * for accept, a datagram socket sends to the named socket from now on
+     * @return 0 on success, -1 if there is no such socket or its backlog is full
+     */
+    size_t connect(const ustl::string& name);
+
+    /**
+     * blocks until the data (a stream) or the whole message (a datagram) fits
+     * @return the number of bytes sent, -1 on error
+     */
+    size_t send(const char* buffer, size_t count);
+
+    /**
+     * blocks until there is data, a message longer than count is truncated
+     * @return the number of bytes received, 0 at end of file of a stream, -1 on error
+     */
+    size_t recv(char* buffer, size_t count);
+
+    uint32 poll(PollEntry* entry);
+
+    /**
+     * Wakes up all threads blocked on the socket, so that a cancelled thread notices its cancellation.
+     */
+    void wakeUpAll();
+
+  private:
+    enum State
+    {
+      UNCONNECTED,
+      LISTENING,
+      CONNECTED,
+      CLOSED
+    };
+
+    ~UnixSocket();
+
+    /**
+     * makes this socket one end of the connection
+     */
+    void attach(UnixConnection* connection, bool acceptor);
+
+    /**
+     * closes this socket's ends of the connection and drops the socket's reference to it,
+     * called with lock_ held
+     */
+    void detach();
+
+    /**
+     * snapshots the pipes of a connected stream socket under lock_
+     * @return the connection with a reference taken, nullptr if the socket is not connected
+     */
+    UnixConnection* connection(Pipe*& rx, Pipe*& tx);
+
+    /**
+     * queues a new connected socket for accept
+     * @return false if the socket does not listen or the backlog is full
+     */
+    bool enqueue(UnixSocket* socket);
+
+    /**
+     * puts a message into the datagram buffer of this socket
+     */
+    size_t deliver(const char* buffer, size_t count);
+
+    Type type_;
+    State state_;
+    size_t refs_;
+
+    /**
+     * protects the state, the name, the accept queue, the connection and the datagram buffer
+     */
+    Mutex lock_;
+
+    /**
+     * broadcast whenever a connection is queued or accepted, a message is put or taken, or the socket closes
+     */
+    Condition changed_;
+    PollWaitQueue poll_queue_;
+
+    ustl::string name_;
+
+    ustl::list<UnixSocket*> pending_;
+    size_t backlog_;
+
+    UnixConnection* connection_;
+    Pipe* rx_;
+    Pipe* tx_;
+
+    RingBuffer<char>* messages_;
+    UnixSocket* peer_;
+};
+
+/**
+ * The names unix domain sockets are bound to. The names live in the kernel, not in the file system.
+ */
+class UnixSocketNames
+{
+  public:
+    static UnixSocketNames *instance();
+
+    /**
+     * @return false if the name is taken
+     */
+    bool add(const ustl::string& name, UnixSocket* socket);
+    void remove(const ustl::string& name);
+
+    /**
+     * @return the socket bound to the name with a reference taken, nullptr if there is none
+     */
+    UnixSocket* lookup(const ustl::string& name);
+
+  private:
+    UnixSocketNames();
+
+    Mutex lock_;
+    ustl::map<ustl::string, UnixSocket*> sockets_;
+
+    static UnixSocketNames *instance_;
+};
@@ -4,12 +4,15 @@
 #include "Loader.h"
 #include "UserThread.h"
 #include "Mutex.h"
+#include "RWLock.h"
 #include "Condition.h"
-#include "RingBuffer.h"
+#include "OpenFile.h"
+#include "IdAllocator.h"
+#include "SparseArray.h"
 
-#define PIPE_BUF_SIZE 1024
-#define PIPE_FD_CODE -2
-#define PIPE_FD_CLOSED -3
+#define PROCESS_MAX_THREADS 8192 // tids are handed out from [0, PROCESS_MAX_THREADS)
+#define PROCESS_MAX_FDS 1024 // fds are handed out from [0, PROCESS_MAX_FDS)
+#define PROCESS_FDS_LOCK_NAME "locking local fd" // lock class of the fd tables, tuned once by the ProcessRegistry
 
 struct UserStackInfo
 {
@@ -64,11 +67,23 @@ public:
 
   uint64_t getAccTime() const;
 
-  ustl::map<int, int> getLocalFDs() const;
+  /**
+   * publishes the cpu time of this process on its vdso page, called by the scheduler
+   * (interrupt context) whenever a thread of this process is scheduled in or out
+   * @param running_since TSC value the running thread got the cpu, 0 if none of our threads runs
+   */
+  void updateVdsoCpuTime(uint64 running_since);
 
-  size_t getOrigLocalFD() const;
+  /**
+   * the number of threads of this process in state Running, kept up to date by Thread::setState
+   * and read by the scheduler (interrupt context) to share the fair-share weight among them
+   */
+  size_t getRunnableThreadCount() const;
 
-  size_t getFdNum() const;
+  /**
+   * called by Thread::setState whenever a thread of this process starts or stops being Running
+   */
+  void runnableThreadsChanged(bool runnable);
 
 
   ///-------------------------------- GETTERS & SETTERS END --------------------------------
@@ -146,30 +161,39 @@ public:
   void incAccTime(size_t time);
 
   /**
-   * adding local fd that will point to global fd
-   * @param global_fd global fd to point to
-   * @return local fd 
+   * puts the open file into the lowest free fd, takes over the reference of the caller
+   * @return the fd, -1U if there is no free fd (then the reference is dropped)
+   */
+  size_t addFD(OpenFile* file);
+
+  /**
+   * @return the open file behind fd with a reference for the caller, nullptr if fd is not open
+   */
+  OpenFile* getFD(size_t fd);
+
+  /**
+   * @return 0, -1U if fd is not open
    */
-  size_t addLocalFD(int global_fd);
+  size_t closeFD(size_t fd);
 
   /**
-   * removing local fd 
-   * @param global_fd global fd that identifies local fd
+   * points the lowest free fd to the same open file as fd
+   * @return the new fd, -1U on error
    */
-  void removeLocalFD(int global_fd);
+  size_t dupFD(size_t fd);
 
   /**
-   * getting global fd from local fd 
-   * @param local_fd local fd to resolve
+   * points new_fd to the same open file as old_fd, new_fd is closed first if it is open
+   * @return new_fd, -1U on error
    */
-  size_t getGlobalFD(int local_fd);
+  size_t dup2FD(size_t old_fd, size_t new_fd);
 
   size_t openPipe(size_t read, size_t write);
-  size_t readFromPipe(size_t read_fd, pointer buffer, size_t count);
-  size_t writeToPipe(size_t write_fd, pointer buffer, size_t count);
-  bool isPipe(int local_fd);
-  void closePipe(int local_fd);
-  ustl::map<ustl::pair<int, int>, RingBuffer<char>*> getPipes() const;
+
+  /**
+   * wakes up the threads blocked on one of our fds, so that a cancelled thread leaves the syscall
+   */
+  void wakeUpFDWaiters();
 
   /**
    * Creates a new thread and adds it to this process
@@ -229,8 +253,16 @@ public:
 
 private:
   //NOTE: All the private members are NOT THREAD SAFE
+  /**
+   * @return the next free tid, it is free again once eraseThreadInformation was called for it
+   */
   size_t allocNextFreeTID();
 
+  /**
+   * allocates the vdso process page and maps it (and the global time page) into loader_
+   */
+  void setupVdsoPage();
+
   /**
    * Reads time-stamp-counter, i.e. number of cycles since reboot.
    * @return cycles since reboot.
@@ -292,6 +324,13 @@ private:
 
   void releaseThreadsListLock();
 
+  /**
+   * for walking and looking up the thread list, threads are only added and removed with the write lock
+   */
+  void acquireThreadsListReadLock();
+
+  void releaseThreadsListReadLock();
+
   void acquireWaitersLock();
 
   void releaseWaitersLock();
@@ -300,7 +339,7 @@ private:
 
   size_t pid_;
 
-  int32 fd_;
+  int32 fd_; // global fd of the executable, read by the loader
   ustl::string filename_;
   Loader* loader_;
   FileSystemInfo* fs_info_;
@@ -308,11 +347,11 @@ private:
   uint32 terminal_number_;
   Terminal* my_terminal_;
 
-  size_t next_tid_;
+  IdAllocator tid_allocator_;
   ustl::map<size_t, UserThread*> thread_list_;
   ustl::map<size_t, UserStackInfo> user_stack_list_;
 
-  Mutex thread_list_lock_;
+  RWLock thread_list_lock_;
   Mutex user_stack_list_lock_;
 
   uint64 args_seg_addr_;
@@ -329,11 +368,11 @@ private:
   ustl::atomic<bool> called_exit_;
 
   uint64_t accumulated_incs_;
-  ustl::map<int, int> fds_;  // process local fd -> global fd
-  ustl::map<ustl::pair<int, int>, RingBuffer<char>*> pipes_;  // process <local fd -> global fd> -> ringbuf
-  size_t fd_num_;
-  Mutex fds_lock_;
-  Mutex pipes_lock_;
+  size_t vdso_ppn_;
+  size_t runnable_threads_;
+  IdAllocator fd_allocator_;
+  SparseArray<OpenFile*> fds_;  // process local fd -> open file
+  mutable Mutex fds_lock_;
 
   ustl::vector<pthread_t> tid_list_;
 };
@@ -88,6 +88,13 @@ public:
    */
   void sleepUntil(uint64_t wakeup);
 
+  /**
+   * Sets the wakeup time without yielding. If the thread is Sleeping once the time elapsed,
+   * the scheduler sets it back to Running, so a sleep with a timeout is possible.
+   * @param wakeup rdtsc value, 0 for none
+   */
+  void setWakeUpTime(uint64_t wakeup);
+
   /**
    * Resets wakeup time of this thread back to zero, should happen before
    * this thread is set back to schedulable.
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "types.h"
+#include "vdso-definitions.h"
+
+class ArchMemory;
+
+/**
+ * Owner of the global, read-only time page that is mapped into every user address
+ * space (see vdso-definitions.h). The libc reads the clock from it without entering
+ * the kernel. The per process page is owned by UserProcess.
+ */
+class Vdso
+{
+  public:
+    static Vdso *instance();
+
+    /**
+     * allocates and fills the time page, call after the clocksource is calibrated
+     */
+    void init();
+
+    /**
+     * called on every timer interrupt
+     */
+    void tick(size_t ticks, uint64 now);
+
+    /**
+     * maps the time page and the given process page read-only into the address space
+     * @param process_page_ppn ppn of the vdso_process_data page of the process
+     */
+    void mapInto(ArchMemory &arch_memory, size_t process_page_ppn);
+
+    static vdso_process_data* processData(size_t process_page_ppn);
+
+    /**
+     * begin/end of a seqlock write section on one of the vdso pages
+     */
+    static void writeBegin(volatile unsigned long &seq);
+    static void writeEnd(volatile unsigned long &seq);
+
+  private:
+    Vdso();
+
+    static Vdso *instance_;
+
+    size_t time_page_ppn_;
+    vdso_time_data *time_data_;
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "types.h"
+#include "Thread.h"
+
+/**
+ * A piece of deferred work, usually embedded in the driver that queues it.
+ * An item is queued at most once at a time, queueing it again before it ran is a no-op.
+ */
+class WorkItem
+{
+  public:
+    typedef void (*WorkFunction)(void* data);
+
+    WorkItem(WorkFunction function, void* data);
+
+    WorkItem(WorkItem const&) = delete;
+    WorkItem &operator=(WorkItem const&) = delete;
+
+    bool isPending() const
+    {
+      return pending_;
+    }
+
+  private:
+    friend class WorkQueue;
+
+    WorkFunction function_;
+    void* data_;
+    WorkItem* next_;
+    size_t pending_;
+};
+
+/**
+ * Kernel thread running the bottom halves of interrupt handlers.
+ * Interrupt handlers only acknowledge their device and queue a WorkItem, the data movement
+ * then happens here with interrupts enabled. Queueing is lock-free (an atomic push onto a
+ * list that the worker takes over as a whole), so it is safe from interrupt context.
+ * There is one worker per cpu, which is a single one for now.
+ */
+class WorkQueue : public Thread
+{
+  public:
+    static WorkQueue* instance();
+
+    /**
+     * Queue the work item, may be called from interrupt context.
+     * As long as the worker does not run yet (during boot) the work is done right away.
+     * @return false if the item was still pending
+     */
+    bool queue(WorkItem* work);
+
+    virtual ~WorkQueue();
+    virtual void kill();
+    virtual void Run();
+
+  private:
+    WorkQueue();
+
+    /**
+     * Take over all queued items and run them in the order they were queued.
+     * @return false if there was nothing to do
+     */
+    bool runPending();
+
+    static WorkQueue* instance_;
+
+    /**
+     * queued items, newest first
+     */
+    WorkItem* pending_;
+
+    /**
+     * set by the worker before it goes to sleep on an empty queue, only the one clearing it wakes the worker
+     */
+    size_t idle_;
+    bool running_;
+};
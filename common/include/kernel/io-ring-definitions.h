@@ -0,0 +1,49 @@
+#pragma once
+
+/**
+ * The submission and completion rings of io_ring_enter(). Shared between the kernel and
+ * the libc, so only plain C types in here.
+ * The program fills submission entries and advances sq_tail, the kernel executes them in
+ * order, advances sq_head and puts one completion entry per submission at cq_tail. The
+ * program consumes completions and advances cq_head. Positions only ever grow and are
+ * taken modulo entries.
+ */
+
+#define IO_RING_MAX_ENTRIES 4096
+
+#define IO_RING_OP_NOP   0
+#define IO_RING_OP_READ  1 // fd, addr = buffer, len = count
+#define IO_RING_OP_WRITE 2 // fd, addr = buffer, len = count
+#define IO_RING_OP_OPEN  3 // addr = path, len = flags, the result is the new fd
+#define IO_RING_OP_CLOSE 4 // fd
+#define IO_RING_OP_FSYNC 5 // fd
+
+struct io_ring_sqe
+{
+  unsigned int opcode;
+  int fd;
+  unsigned long addr;
+  unsigned long len;
+  unsigned long user_data; // copied to the completion
+};
+
+struct io_ring_cqe
+{
+  unsigned long user_data;
+  long res; // what the syscall of the operation returns
+};
+
+struct io_ring
+{
+  unsigned int entries; // a power of two, the size of both rings
+
+  unsigned int sq_head; // advanced by the kernel
+  unsigned int sq_tail; // advanced by the program
+  unsigned int sq_next; // next free submission entry, only used by the program
+
+  unsigned int cq_head; // advanced by the program
+  unsigned int cq_tail; // advanced by the kernel
+
+  struct io_ring_sqe *sqes;
+  struct io_ring_cqe *cqes;
+};
@@ -0,0 +1,19 @@
+#pragma once
+
+/**
+ * Events and the fd entry of poll(). Shared between the kernel and the libc,
+ * so only plain C types in here.
+ */
+
+#define POLLIN   0x0001 // there is data to read, or the end of file
+#define POLLOUT  0x0004 // writing does not block
+#define POLLERR  0x0008 // the other end of a pipe is closed, always reported
+#define POLLHUP  0x0010 // the writing end of a pipe is closed, always reported
+#define POLLNVAL 0x0020 // the fd is not open, always reported
+
+struct pollfd
+{
+  int fd;         // negative fds are ignored
+  short events;   // what the caller waits for
+  short revents;  // what is ready, filled in by poll
+};
@@ -0,0 +1,22 @@
+#pragma once
+
+/**
+ * Address family, socket types and the address of unix domain sockets.
+ * Shared between the kernel and the libc, so only plain C types in here.
+ */
+
+#define AF_UNIX 1
+#define AF_LOCAL AF_UNIX
+
+#define SOCK_STREAM 1 // reliable byte stream over a connection
+#define SOCK_DGRAM 2  // messages keep their boundaries, sent to the connected peer
+
+#define UNIX_PATH_MAX 108 // including the terminating \0
+
+#define SOMAXCONN 128 // upper bound for the listen backlog
+
+struct sockaddr_un
+{
+  unsigned short sun_family; // AF_UNIX
+  char sun_path[UNIX_PATH_MAX];
+};
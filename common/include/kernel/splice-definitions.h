@@ -0,0 +1,20 @@
+#pragma once
+
+/**
+ * Flags and the buffer description of splice() and vmsplice(). Shared between the kernel
+ * and the libc, so only plain C types in here, size_t has to be defined by the includer.
+ */
+
+// hints only, the data is always copied once between the pipe buffer and the other side
+#define SPLICE_F_MOVE     0x01
+#define SPLICE_F_NONBLOCK 0x02
+#define SPLICE_F_MORE     0x04
+#define SPLICE_F_GIFT     0x08
+
+#define UIO_MAXIOV 1024 // most buffers per vmsplice call
+
+struct iovec
+{
+  void* iov_base;
+  size_t iov_len;
+};
@@ -11,8 +11,13 @@
 #define sc_open 5
 #define sc_close 6
 #define sc_lseek 19
+#define sc_getpid 20
+#define sc_dup 41
 #define sc_pseudols 43
+#define sc_ioctl 54
+#define sc_dup2 63
 #define sc_outline 105
+#define sc_fsync 118
 #define sc_sched_yield 158
 #define sc_createprocess 191
 #define sc_trace 252
@@ -25,4 +30,23 @@
 #define sc_sleep 401
 #define sc_waitpid 402
 #define sc_pipe 403
+#define sc_nice 404
+#define sc_clock_gettime 405
+#define sc_nanosleep 406
+#define sc_futex 407
+#define sc_poll 408
+#define sc_splice 409
+#define sc_vmsplice 410
+#define sc_socket 411
+#define sc_bind 412
+#define sc_listen 413
+#define sc_accept 414
+#define sc_connect 415
+#define sc_send 416
+#define sc_recv 417
+#define sc_io_ring_enter 418
+#define sc_sendfile 419
+#define sc_copy_file_range 420
+#define sc_tcgetattr 421
+#define sc_tcsetattr 422
 #define sc_execv 1004
@@ -0,0 +1,32 @@
+#pragma once
+
+/**
+ * Terminal attributes of the line discipline. Shared between the kernel and the libc,
+ * so only plain C types in here.
+ */
+
+typedef unsigned int tcflag_t;
+typedef unsigned char cc_t;
+
+// c_lflag
+#define ICANON 0x0002 // canonical mode: input is edited and read line by line
+#define ECHO   0x0008 // typed characters are echoed to the terminal
+
+// indices into c_cc
+#define VTIME 5 // not supported, ignored
+#define VMIN  6 // raw mode: read waits for this many characters, 0 does not wait at all
+#define NCCS  8
+
+// optional_actions of tcsetattr
+#define TCSANOW   0 // the new attributes apply right away
+#define TCSADRAIN 1 // the same, output is never buffered
+#define TCSAFLUSH 2 // in addition, the input not read yet is discarded
+
+// ioctl requests on the terminal
+#define TIOCSTI 0x5412 // the character arg points to goes through the line discipline as if it was typed
+
+struct termios
+{
+  tcflag_t c_lflag;
+  cc_t c_cc[NCCS];
+};
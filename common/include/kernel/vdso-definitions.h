@@ -0,0 +1,39 @@
+#pragma once
+
+/**
+ * Layout of the two read-only pages the kernel maps into every user address space
+ * (see VDSO_SEGMENT_START in offsets.h). Shared between the kernel and the libc,
+ * so only plain C types in here.
+ *
+ * Both pages are protected by a seqlock: the kernel makes seq odd before it writes
+ * and even again afterwards, readers retry until they saw the same even value before
+ * and after reading.
+ */
+
+#define VDSO_TIME_PAGE_ADDRESS    0x00007fffffffc000UL
+#define VDSO_PROCESS_PAGE_ADDRESS 0x00007fffffffd000UL
+
+/**
+ * global page, updated on every timer tick
+ */
+struct vdso_time_data
+{
+  volatile unsigned long seq;
+  unsigned long tsc_mult;       // ns = (cycles * tsc_mult) >> tsc_shift
+  unsigned long tsc_shift;
+  unsigned long tsc_hz;
+  unsigned long boot_cycles;    // TSC value CLOCK_MONOTONIC counts from
+  unsigned long ticks;          // timer interrupts since boot
+  unsigned long tick_cycles;    // TSC value at the last timer interrupt
+};
+
+/**
+ * per process page, updated whenever a thread of the process is scheduled in or out
+ */
+struct vdso_process_data
+{
+  volatile unsigned long seq;
+  unsigned long pid;
+  unsigned long cpu_cycles;     // cycles consumed by threads that are not running right now
+  unsigned long running_since;  // TSC value when the running thread was scheduled in, 0 if none runs
+};
@@ -170,14 +170,9 @@ template<class T>
 uint32 FiFo<T>::countElementsAhead()
 {
   input_buffer_lock_.acquire();
-  uint32 count = ib_write_pos_ - ib_read_pos_;
+  // the element at ib_read_pos_ was read already, ib_write_pos_ is the next free slot
+  uint32 count = (ib_write_pos_ + input_buffer_size_ - ib_read_pos_ - 1) % input_buffer_size_;
   input_buffer_lock_.release();
-  if (count == 0)
-    return input_buffer_size_;
-  else if (count > 0)
-    return (count - 1);
-  else
-    // count < 0
-    return (input_buffer_size_ + count);
+  return count;
 }
 
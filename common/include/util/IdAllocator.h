@@ -0,0 +1,79 @@
+#pragma once
+
+#include "types.h"
+
+#define ID_ALLOCATOR_BITS_PER_WORD 64
+
+/**
+ * Hands out ids from [0, max_ids), e.g. pids and tids.
+ * One bit per id, plus one summary bit per word of ids that tells whether the word is full,
+ * so finding a free id only touches a few words. Ids are handed out in increasing order
+ * (next fit), a freed id is only reused after the search wrapped around, so a stale id
+ * does not refer to a new object right away.
+ * Not locked, the user has to serialize the accesses.
+ */
+class IdAllocator
+{
+  public:
+    /**
+     * @param max_ids number of ids, has to be a multiple of ID_ALLOCATOR_BITS_PER_WORD
+     */
+    IdAllocator(size_t max_ids);
+    ~IdAllocator();
+
+    IdAllocator(IdAllocator const&) = delete;
+    IdAllocator &operator=(IdAllocator const&) = delete;
+
+    /**
+     * @return the first free id after the last one handed out, -1U if all ids are in use
+     */
+    size_t alloc();
+
+    /**
+     * @return the lowest free id, -1U if all ids are in use, e.g. for file descriptors
+     */
+    size_t allocLowest();
+
+    /**
+     * marks the given id as used
+     * @return false if it is in use already
+     */
+    bool allocId(size_t id);
+
+    void free(size_t id);
+
+    bool isUsed(size_t id) const;
+
+    size_t getNumUsed() const
+    {
+      return num_used_;
+    }
+
+  private:
+    /**
+     * @return the first free id in [start, max_ids_), -1U if there is none
+     */
+    size_t findFree(size_t start) const;
+
+    void markUsed(size_t id);
+
+    size_t max_ids_;
+    size_t num_words_;
+    size_t num_summary_words_;
+
+    /**
+     * one bit per id, set if it is in use
+     */
+    uint64* used_;
+
+    /**
+     * one bit per word of used_, set if the word has no free id left
+     */
+    uint64* full_;
+
+    /**
+     * where the search for the next id starts
+     */
+    size_t next_;
+    size_t num_used_;
+};
@@ -1,50 +1,141 @@
 #pragma once
 
-#ifdef __cplusplus
-extern "C"
-{
-#endif
-
-#ifdef __cplusplus
-}
-#endif
-
+#include "types.h"
 #include "new.h"
-#include "ArchThreads.h"
+#include "kstring.h"
 #include "assert.h"
-#include "Mutex.h"
 
+#ifndef CACHE_LINE_SIZE
+#define CACHE_LINE_SIZE 64
+#endif
+
+/**
+ * Lock-free ring buffer for one producer and one consumer, e.g. an interrupt handler
+ * putting and a thread getting. No other synchronisation is needed between the two.
+ * The capacity is rounded up to a power of two, so positions are masked instead of taken
+ * modulo. The positions only ever grow, all slots are usable.
+ * The producer publishes its position with release semantics after writing the elements and
+ * reads the consumer's with acquire semantics, and vice versa. Both positions live in
+ * cache lines of their own, so producer and consumer do not bounce each other's line.
+ * The bulk operations copy with at most two memcpys, so T has to be trivially copyable.
+ */
 template<class T>
 class RingBuffer
 {
   public:
-    RingBuffer ( uint32 size=128 );
+    RingBuffer(size_t size = 128);
     ~RingBuffer();
-    bool get ( T &c );
-    bool put ( T c );
+
+    RingBuffer(RingBuffer const&) = delete;
+    RingBuffer &operator=(RingBuffer const&) = delete;
+
+    /**
+     * producer side
+     * @return false if the buffer is full
+     */
+    bool put(T c);
+
+    /**
+     * producer side, puts as many elements as fit
+     * @return the number of elements put
+     */
+    size_t putBulk(const T* elements, size_t count);
+
+    /**
+     * consumer side
+     * @return false if the buffer is empty
+     */
+    bool get(T &c);
+
+    /**
+     * consumer side, gets as many elements as there are, up to count
+     * @return the number of elements got
+     */
+    size_t getBulk(T* elements, size_t count);
+
+    /**
+     * producer side, for filling the buffer in place, e.g. by reading from a file into it
+     * @param span set to the first free slot
+     * @return the number of free slots following span without wrapping around
+     */
+    size_t writeSpan(T*& span);
+
+    /**
+     * producer side, publishes count elements written to the span from writeSpan
+     */
+    void produce(size_t count);
+
+    /**
+     * consumer side, for draining the buffer in place, e.g. by writing from it to a file
+     * @param span set to the first used slot
+     * @return the number of used slots following span without wrapping around
+     */
+    size_t readSpan(const T*& span);
+
+    /**
+     * consumer side, frees count elements of the span from readSpan
+     */
+    void consume(size_t count);
+
+    /**
+     * consumer side, drops everything that was put so far
+     */
     void clear();
-    void incProcCount();
-    void decProcCount();
-    size_t getProcCount() const;
+
+    /**
+     * a lower bound on the consumer side, the producer may add more meanwhile,
+     * an upper bound on the producer side, the consumer may drain it meanwhile
+     */
+    size_t size() const
+    {
+      return __atomic_load_n(&write_pos_, __ATOMIC_ACQUIRE) - __atomic_load_n(&read_pos_, __ATOMIC_ACQUIRE);
+    }
+
+    /**
+     * a lower bound on the producer side, the consumer may free more meanwhile,
+     * an upper bound on the consumer side, the producer may fill it meanwhile
+     */
+    size_t freeSpace() const
+    {
+      return capacity() - size();
+    }
+
+    size_t capacity() const
+    {
+      return mask_ + 1;
+    }
 
   private:
-    Mutex proc_counter_;
-    size_t buffer_size_;
-    T *buffer_;
+    /**
+     * copies count elements between the ring at position pos and elements, in at most two pieces
+     */
+    void copyIn(size_t pos, const T* elements, size_t count);
+    void copyOut(size_t pos, T* elements, size_t count) const;
+
+    size_t mask_;
+    T* buffer_;
+
+    char padding0_[CACHE_LINE_SIZE - sizeof(size_t) - sizeof(T*)];
+    // written by the producer only
     size_t write_pos_;
+
+    char padding1_[CACHE_LINE_SIZE - sizeof(size_t)];
+    // written by the consumer only
     size_t read_pos_;
-    size_t connected_proc_counter_; //for pipe usage
+
+    char padding2_[CACHE_LINE_SIZE - sizeof(size_t)];
 };
 
 template <class T>
-RingBuffer<T>::RingBuffer ( uint32 size ): proc_counter_("Pipe's counter lock") 
+RingBuffer<T>::RingBuffer(size_t size) :
+  mask_(0), buffer_(0), write_pos_(0), read_pos_(0)
 {
-  assert ( size>1 );
-  buffer_size_=size;
-  buffer_=new T[buffer_size_];
-  write_pos_=1;
-  read_pos_=0;
-  connected_proc_counter_=0;
+  assert(size > 1);
+  size_t capacity = 1;
+  while (capacity < size)
+    capacity <<= 1;
+  mask_ = capacity - 1;
+  buffer_ = new T[capacity];
 }
 
 template <class T>
@@ -54,54 +145,107 @@ RingBuffer<T>::~RingBuffer()
 }
 
 template <class T>
-bool RingBuffer<T>::put ( T c )
+void RingBuffer<T>::copyIn(size_t pos, const T* elements, size_t count)
 {
-  size_t old_write_pos=write_pos_;
-  if ( old_write_pos == read_pos_ )// || ( old_write_pos + 1 ) % buffer_size_ == 0)
+  size_t offset = pos & mask_;
+  size_t first = (count < capacity() - offset) ? count : capacity() - offset;
+  memcpy(buffer_ + offset, elements, first * sizeof(T));
+  memcpy(buffer_, elements + first, (count - first) * sizeof(T));
+}
+
+template <class T>
+void RingBuffer<T>::copyOut(size_t pos, T* elements, size_t count) const
+{
+  size_t offset = pos & mask_;
+  size_t first = (count < capacity() - offset) ? count : capacity() - offset;
+  memcpy(elements, buffer_ + offset, first * sizeof(T));
+  memcpy(elements + first, buffer_, (count - first) * sizeof(T));
+}
+
+template <class T>
+bool RingBuffer<T>::put(T c)
+{
+  size_t write_pos = __atomic_load_n(&write_pos_, __ATOMIC_RELAXED);
+  if (write_pos - __atomic_load_n(&read_pos_, __ATOMIC_ACQUIRE) == capacity())
     return false;
-  buffer_[old_write_pos]=c;
-  ArchThreads::testSetLock ( write_pos_, ( old_write_pos + 1 ) % buffer_size_ );
+  buffer_[write_pos & mask_] = c;
+  __atomic_store_n(&write_pos_, write_pos + 1, __ATOMIC_RELEASE);
   return true;
 }
 
 template <class T>
-void RingBuffer<T>::clear()
+size_t RingBuffer<T>::putBulk(const T* elements, size_t count)
 {
-  ArchThreads::testSetLock ( write_pos_,1 );
-  // assumed that there is only one reader who can't have called clear and get at the same time.
-  // here get would return garbage.
-  ArchThreads::testSetLock ( read_pos_,0 );
+  size_t write_pos = __atomic_load_n(&write_pos_, __ATOMIC_RELAXED);
+  size_t free_space = capacity() - (write_pos - __atomic_load_n(&read_pos_, __ATOMIC_ACQUIRE));
+  if (count > free_space)
+    count = free_space;
+  copyIn(write_pos, elements, count);
+  __atomic_store_n(&write_pos_, write_pos + count, __ATOMIC_RELEASE);
+  return count;
 }
 
 template <class T>
-bool RingBuffer<T>::get ( T &c )
+bool RingBuffer<T>::get(T &c)
 {
-  uint32 new_read_pos = ( read_pos_ + 1 ) % buffer_size_;
-  if ( write_pos_ == new_read_pos ) //nothing new to read
+  size_t read_pos = __atomic_load_n(&read_pos_, __ATOMIC_RELAXED);
+  if (__atomic_load_n(&write_pos_, __ATOMIC_ACQUIRE) == read_pos) //nothing new to read
     return false;
-  c = buffer_[new_read_pos];
-  ArchThreads::testSetLock ( read_pos_,new_read_pos );
+  c = buffer_[read_pos & mask_];
+  __atomic_store_n(&read_pos_, read_pos + 1, __ATOMIC_RELEASE);
   return true;
 }
 
 template <class T>
-void RingBuffer<T>::incProcCount()
+size_t RingBuffer<T>::getBulk(T* elements, size_t count)
+{
+  size_t read_pos = __atomic_load_n(&read_pos_, __ATOMIC_RELAXED);
+  size_t available = __atomic_load_n(&write_pos_, __ATOMIC_ACQUIRE) - read_pos;
+  if (count > available)
+    count = available;
+  copyOut(read_pos, elements, count);
+  __atomic_store_n(&read_pos_, read_pos + count, __ATOMIC_RELEASE);
+  return count;
+}
+
+template <class T>
+size_t RingBuffer<T>::writeSpan(T*& span)
+{
+  size_t write_pos = __atomic_load_n(&write_pos_, __ATOMIC_RELAXED);
+  size_t free_space = capacity() - (write_pos - __atomic_load_n(&read_pos_, __ATOMIC_ACQUIRE));
+  size_t offset = write_pos & mask_;
+  span = buffer_ + offset;
+  return (free_space < capacity() - offset) ? free_space : capacity() - offset;
+}
+
+template <class T>
+void RingBuffer<T>::produce(size_t count)
+{
+  size_t write_pos = __atomic_load_n(&write_pos_, __ATOMIC_RELAXED);
+  assert(count <= capacity() - (write_pos - __atomic_load_n(&read_pos_, __ATOMIC_ACQUIRE)));
+  __atomic_store_n(&write_pos_, write_pos + count, __ATOMIC_RELEASE);
+}
+
+template <class T>
+size_t RingBuffer<T>::readSpan(const T*& span)
 {
-  proc_counter_.acquire();
-  connected_proc_counter_++;
-  proc_counter_.release();
+  size_t read_pos = __atomic_load_n(&read_pos_, __ATOMIC_RELAXED);
+  size_t available = __atomic_load_n(&write_pos_, __ATOMIC_ACQUIRE) - read_pos;
+  size_t offset = read_pos & mask_;
+  span = buffer_ + offset;
+  return (available < capacity() - offset) ? available : capacity() - offset;
 }
 
 template <class T>
-void RingBuffer<T>::decProcCount()
+void RingBuffer<T>::consume(size_t count)
 {
-  proc_counter_.acquire();
-  connected_proc_counter_--;
-  proc_counter_.release();
+  size_t read_pos = __atomic_load_n(&read_pos_, __ATOMIC_RELAXED);
+  assert(count <= __atomic_load_n(&write_pos_, __ATOMIC_ACQUIRE) - read_pos);
+  __atomic_store_n(&read_pos_, read_pos + count, __ATOMIC_RELEASE);
 }
 
-template <class T> 
-size_t RingBuffer<T>::getProcCount() const
+template <class T>
+void RingBuffer<T>::clear()
 {
-  return connected_proc_counter_;
-}
\ No newline at end of file
+  __atomic_store_n(&read_pos_, __atomic_load_n(&write_pos_, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "types.h"
+#include "assert.h"
+
+#define SPARSE_ARRAY_CHUNK_SIZE 64
+
+/**
+ * Fixed size array for id -> object lookups, e.g. pid -> process.
+ * The entries are allocated in chunks when the first entry of a chunk is set,
+ * so a mostly empty array only costs one pointer per chunk.
+ * Entries that were never set read as T(). Not locked.
+ */
+template<class T>
+class SparseArray
+{
+  public:
+    SparseArray(size_t size);
+    ~SparseArray();
+
+    SparseArray(SparseArray const&) = delete;
+    SparseArray &operator=(SparseArray const&) = delete;
+
+    T get(size_t index) const;
+    void set(size_t index, T value);
+
+    size_t getSize() const
+    {
+      return size_;
+    }
+
+  private:
+    size_t size_;
+    size_t num_chunks_;
+    T** chunks_;
+};
+
+template<class T>
+SparseArray<T>::SparseArray(size_t size) :
+  size_(size), num_chunks_((size + SPARSE_ARRAY_CHUNK_SIZE - 1) / SPARSE_ARRAY_CHUNK_SIZE), chunks_(0)
+{
+  chunks_ = new T*[num_chunks_]{};
+}
+
+template<class T>
+SparseArray<T>::~SparseArray()
+{
+  for (size_t i = 0; i < num_chunks_; ++i)
+    delete[] chunks_[i];
+  delete[] chunks_;
+}
+
+template<class T>
+T SparseArray<T>::get(size_t index) const
+{
+  if (index >= size_)
+    return T();
+  T* chunk = chunks_[index / SPARSE_ARRAY_CHUNK_SIZE];
+  return chunk ? chunk[index % SPARSE_ARRAY_CHUNK_SIZE] : T();
+}
+
+template<class T>
+void SparseArray<T>::set(size_t index, T value)
+{
+  assert(index < size_);
+  T*& chunk = chunks_[index / SPARSE_ARRAY_CHUNK_SIZE];
+  if (!chunk)
+    chunk = new T[SPARSE_ARRAY_CHUNK_SIZE]{};
+  chunk[index % SPARSE_ARRAY_CHUNK_SIZE] = value;
+}
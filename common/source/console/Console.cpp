@@ -63,10 +63,6 @@ void Console::handleKey(uint32 key)
     case KEY_F12:
       Scheduler::instance()->printThreadList();
       break;
-
-    case '\b':
-      terminals_[active_terminal_]->backspace();
-      break;
   }
 }
 
@@ -103,21 +99,33 @@ void Console::Run(void)
 {
   KeyboardManager * km = KeyboardManager::instance();
   uint32 key;
+  char keys[Terminal::TERMINAL_BUFFER_SIZE];
   do
   {
+    // the typed keys go to the line discipline in batches, one lock and at most one wakeup per batch
+    Terminal *terminal = terminals_[active_terminal_];
+    size_t num_keys = 0;
     while (km->getKeyFromKbd(key))
     {
-      if (isDisplayable(key))
+      if (!isDisplayable(key))
       {
-        key = terminals_[active_terminal_]->remap(key);
-        terminals_[active_terminal_]->write(key);
-        terminals_[active_terminal_]->putInBuffer(key);
+        // the keys before a terminal switch belong to the old terminal
+        if (num_keys)
+          terminal->putInBuffer(keys, num_keys);
+        num_keys = 0;
+        handleKey(key);
+        terminal = terminals_[active_terminal_];
+        continue;
       }
-      else
+      keys[num_keys++] = terminal->remap(key);
+      if (num_keys == sizeof(keys))
       {
-        handleKey(key);
+        terminal->putInBuffer(keys, num_keys);
+        num_keys = 0;
       }
     }
+    if (num_keys)
+      terminal->putInBuffer(keys, num_keys);
     Scheduler::instance()->yield();
   } while (1);
 }
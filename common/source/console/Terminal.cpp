@@ -2,14 +2,27 @@
 #include "Console.h"
 
 #include "KeyboardManager.h"
+#include "MutexLock.h"
+#include "UserThread.h"
 
 #include "kprintf.h"
+#include <ualgo.h>
+
+static bool cancelRequested()
+{
+  return currentThread->getType() == Thread::USER_THREAD && ((UserThread*)currentThread)->shouldCancel();
+}
 
 Terminal::Terminal(char *name, Console *console, uint32 num_columns, uint32 num_rows) :
     CharacterDevice(name), console_(console), num_columns_(num_columns), num_rows_(num_rows), len_(
         num_rows * num_columns), current_column_(0), current_state_(0x93), active_(0), mutex_("Terminal::mutex_"), layout_(
-        EN)
+        EN), poll_queue_("Terminal::poll_queue_"), input_lock_("Terminal::input_lock_"),
+        input_ready_(&input_lock_, "Terminal::input_ready_"), input_(CD_BUFFER_SIZE), lines_(0), line_length_(0)
 {
+  memset(&attributes_, 0, sizeof(attributes_));
+  attributes_.c_lflag = ICANON | ECHO;
+  attributes_.c_cc[VMIN] = 1;
+
   characters_ = new uint8[len_];
   character_states_ = new uint8[len_];
 
@@ -24,24 +37,127 @@ Terminal::Terminal(char *name, Console *console, uint32 num_columns, uint32 num_
 
 void Terminal::clearBuffer()
 {
-  in_buffer_.clear();
+  MutexLock lock(input_lock_);
+  input_.clear();
+  lines_ = 0;
+  line_length_ = 0;
+}
+
+void Terminal::putInBuffer(const char *keys, size_t count)
+{
+  char echo[TERMINAL_BUFFER_SIZE];
+  size_t echo_length = 0;
+
+  MutexLock lock(input_lock_);
+  bool canonical = attributes_.c_lflag & ICANON;
+  size_t queued = input_.size();
+  for (size_t i = 0; i < count; ++i)
+  {
+    char key = keys[i];
+    if (canonical)
+    {
+      if (key == '\r')
+        key = '\n';
+      if (key == '\b')
+      {
+        if (!line_length_)
+          continue;
+        --line_length_;
+      }
+      else
+      {
+        // a full line only takes its end
+        if (key != '\n' && line_length_ == TERMINAL_BUFFER_SIZE - 1)
+          continue;
+        line_[line_length_++] = key;
+        if (key == '\n')
+        {
+          // with too little space left the line is cut off, readers then get the full input without a line end
+          if (input_.putBulk(line_, line_length_) == line_length_)
+            ++lines_;
+          line_length_ = 0;
+        }
+      }
+    }
+    else
+    {
+      if (!input_.put(key))
+        continue;
+      if (key == '\n')
+        ++lines_;
+    }
+
+    if (attributes_.c_lflag & ECHO)
+    {
+      echo[echo_length++] = key;
+      if (echo_length == sizeof(echo))
+      {
+        writeBuffer(echo, echo_length);
+        echo_length = 0;
+      }
+    }
+  }
+  if (echo_length)
+    writeBuffer(echo, echo_length);
+
+  if (input_.size() > queued && !readWouldBlock())
+  {
+    input_ready_.broadcast();
+    poll_queue_.wakeUpAll();
+  }
+}
+
+bool Terminal::readWouldBlock()
+{
+  if (attributes_.c_lflag & ICANON)
+    return !lines_ && input_.freeSpace();
+  return input_.size() < attributes_.c_cc[VMIN];
+}
+
+uint32 Terminal::poll(PollEntry* entry)
+{
+  MutexLock lock(input_lock_);
+  if (entry)
+    poll_queue_.add(entry);
+  return (input_.size() && !readWouldBlock()) ? POLLIN : 0;
+}
+
+void Terminal::wakeUpAll()
+{
+  input_lock_.acquire();
+  input_ready_.broadcast();
+  input_lock_.release();
+  poll_queue_.wakeUpAll();
+}
+
+void Terminal::getAttributes(termios &attributes)
+{
+  MutexLock lock(input_lock_);
+  attributes = attributes_;
 }
 
-void Terminal::putInBuffer(uint32 what)
+void Terminal::setAttributes(termios const &attributes)
 {
-  in_buffer_.put(what);
+  MutexLock lock(input_lock_);
+  if ((attributes_.c_lflag & ICANON) && !(attributes.c_lflag & ICANON))
+  {
+    input_.putBulk(line_, line_length_);
+    line_length_ = 0;
+  }
+  attributes_ = attributes;
+  input_ready_.broadcast();
+  poll_queue_.wakeUpAll();
 }
 
 char Terminal::read()
 {
-  return (char) in_buffer_.get();
+  char character = 0;
+  readLine(&character, 1);
+  return character;
 }
 
 void Terminal::backspace(void)
 {
-  if (in_buffer_.countElementsAhead())
-    in_buffer_.get();
-
   if (current_column_)
   {
     --current_column_;
@@ -49,22 +165,51 @@ void Terminal::backspace(void)
   }
 }
 
-uint32 Terminal::readLine(char *line, uint32 size)
+size_t Terminal::readLine(char *line, size_t size)
 {
-  uint32 cchar;
-  uint32 counter = 0;
   if (size < 1)
     return 0;
-  do
+  // line is user memory, a fault on it must not happen with the input locked
+  char buffer[TERMINAL_BUFFER_SIZE];
+  size = ustl::min(size, (size_t) TERMINAL_BUFFER_SIZE);
+
+  input_lock_.acquire();
+  while (readWouldBlock() && !cancelRequested())
+    input_ready_.wait();
+  if (readWouldBlock())
   {
-    cchar = in_buffer_.get();
+    input_lock_.release();
+    return -1;
+  }
 
-    line[counter++] = (char) cchar;
-  } while (cchar != '\n' && cchar != '\r' && counter < size);
+  // copies out of the ring, in canonical mode up to the end of the line
+  bool canonical = attributes_.c_lflag & ICANON;
+  bool line_end = false;
+  size_t num_read = 0;
+  const char* span;
+  size_t span_size;
+  while (!line_end && num_read < size && (span_size = input_.readSpan(span)))
+  {
+    span_size = ustl::min(span_size, size - num_read);
+    size_t taken = 0;
+    while (taken < span_size && !line_end)
+    {
+      if (span[taken++] == '\n')
+      {
+        --lines_;
+        line_end = canonical;
+      }
+    }
+    memcpy(buffer + num_read, span, taken);
+    input_.consume(taken);
+    num_read += taken;
+  }
+  input_lock_.release();
 
-  if (size - counter)
-    line[counter] = '\0';
-  return counter;
+  memcpy(line, buffer, num_read);
+  if (size - num_read)
+    line[num_read] = '\0';
+  return num_read;
 }
 
 void Terminal::writeInternal(char character)
@@ -21,10 +21,12 @@ void flushActiveConsole()
   assert(main_console);
   assert(nosleep_rb_);
   assert(ArchInterrupts::testIFSet());
-  char c = 0;
-  while (nosleep_rb_->get(c))
+  // one terminal lock per chunk instead of per character
+  char chunk[128];
+  size_t num_chars;
+  while ((num_chars = nosleep_rb_->getBulk(chunk, sizeof(chunk))))
   {
-    main_console->getActiveTerminal()->write(c);
+    main_console->getActiveTerminal()->writeBuffer(chunk, num_chars);
   }
   Scheduler::instance()->yield();
 }
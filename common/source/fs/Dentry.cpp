@@ -3,6 +3,11 @@
 #include "Inode.h"
 
 #include "kprintf.h"
+#ifndef EXE2MINIXFS
+#include "RWLock.h"
+#endif
+
+RWLock dentry_tree_lock("dentry_tree_lock");
 
 Dentry::Dentry(const char* name) :
     d_inode_(0), d_parent_(this), d_mounts_(0), d_name_(name)
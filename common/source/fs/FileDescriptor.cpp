@@ -2,24 +2,24 @@
 #include <ulist.h>
 #ifndef EXE2MINIXFS
 #include "ArchThreads.h"
-#include "Mutex.h"
+#include "RWLock.h"
 #endif
 #include "kprintf.h"
 
 ustl::list<FileDescriptor*> global_fd;
-Mutex global_fd_lock("global_fd_lock");
+RWLock global_fd_lock("global_fd_lock");
 
 static size_t fd_num_ = 3;
 
 void FileDescriptor::add(FileDescriptor* fd)
 {
-  MutexLock ml(global_fd_lock);
+  WriteLock wl(global_fd_lock);
   global_fd.push_back(fd);
 }
 
 void FileDescriptor::remove(FileDescriptor* fd)
 {
-  MutexLock ml(global_fd_lock);
+  WriteLock wl(global_fd_lock);
   global_fd.remove(fd);
 }
 
@@ -15,17 +15,20 @@
 #include "VfsMount.h"
 #include "kprintf.h"
 #ifndef EXE2MINIXFS
-#include "Mutex.h"
+#include "RWLock.h"
 #include "Thread.h"
 #endif
 
 #define SEPARATOR '/'
 #define CHAR_DOT '.'
 
+// path walks read the dentry tree, creating and removing entries writes it
+extern RWLock dentry_tree_lock;
+
 FileDescriptor* VfsSyscall::getFileDescriptor(uint32 fd)
 {
-  extern Mutex global_fd_lock;
-  MutexLock mlock(global_fd_lock);
+  extern RWLock global_fd_lock;
+  ReadLock rl(global_fd_lock);
   for (auto it : global_fd)
   {
     if (it->getFd() == fd)
@@ -62,6 +65,7 @@ int32 VfsSyscall::dupChecking(const char* pathname, Dentry*& pw_dentry, VfsMount
 
 int32 VfsSyscall::mkdir(const char* pathname, int32)
 {
+  WriteLock wl(dentry_tree_lock);
   debug(VFSSYSCALL, "(mkdir) \n");
   FileSystemInfo *fs_info = getcwd();
   Dentry* pw_dentry = 0;
@@ -111,6 +115,7 @@ int32 VfsSyscall::mkdir(const char* pathname, int32)
 
 Dirent* VfsSyscall::readdir(const char* pathname)
 {
+  ReadLock rl(dentry_tree_lock);
   FileSystemInfo *fs_info = getcwd();
   Dentry* pw_dentry = 0;
   VfsMount* pw_vfs_mount = 0;
@@ -162,6 +167,7 @@ Dirent* VfsSyscall::readdir(const char* pathname)
 
 int32 VfsSyscall::chdir(const char* pathname)
 {
+  ReadLock rl(dentry_tree_lock);
   FileSystemInfo *fs_info = getcwd();
   Dentry* pw_dentry = 0;
   VfsMount* pw_vfs_mount = 0;
@@ -185,6 +191,7 @@ int32 VfsSyscall::chdir(const char* pathname)
 
 int32 VfsSyscall::rm(const char* pathname)
 {
+  WriteLock wl(dentry_tree_lock);
   debug(VFSSYSCALL, "(rm) name: %s\n", pathname);
   Dentry* pw_dentry = 0;
   VfsMount* pw_vfs_mount = 0;
@@ -221,6 +228,7 @@ int32 VfsSyscall::rm(const char* pathname)
 
 int32 VfsSyscall::rmdir(const char* pathname)
 {
+  WriteLock wl(dentry_tree_lock);
   Dentry* pw_dentry = 0;
   VfsMount* pw_vfs_mount = 0;
   if (dupChecking(pathname, pw_dentry, pw_vfs_mount) != 0)
@@ -259,8 +267,11 @@ int32 VfsSyscall::rmdir(const char* pathname)
 
 int32 VfsSyscall::close(uint32 fd)
 {
-  FileDescriptor* file_descriptor = getFileDescriptor(fd);
+  return close(getFileDescriptor(fd));
+}
 
+int32 VfsSyscall::close(FileDescriptor* file_descriptor)
+{
   if (file_descriptor == 0)
   {
     debug(VFSSYSCALL, "(close) Error: the fd does not exist.\n");
@@ -274,7 +285,6 @@ int32 VfsSyscall::close(uint32 fd)
 int32 VfsSyscall::open(const char* pathname, uint32 flag)
 {
   //debug(VFSSYSCALL, "open: pathname: %s\n", pathname);  // [VFSSYSCALL ]open: pathname: /usr/e.sweb
-  FileSystemInfo *fs_info = getcwd();
   if (flag & ~(O_RDONLY | O_WRONLY | O_CREAT | O_RDWR | O_TRUNC | O_APPEND))
   {
     debug(VFSSYSCALL, "(open) invalid parameter flag\n");
@@ -285,6 +295,19 @@ int32 VfsSyscall::open(const char* pathname, uint32 flag)
     kprintfd("(open) flags not yet implemented\n");
     return -1;
   }
+  // only creating a file changes the dentry tree
+  if (flag & O_CREAT)
+  {
+    WriteLock wl(dentry_tree_lock);
+    return openLocked(pathname, flag);
+  }
+  ReadLock rl(dentry_tree_lock);
+  return openLocked(pathname, flag);
+}
+
+int32 VfsSyscall::openLocked(const char* pathname, uint32 flag)
+{
+  FileSystemInfo *fs_info = getcwd();
   Dentry* pw_dentry = 0;
   VfsMount* pw_vfs_mount = 0;
   if (dupChecking(pathname, pw_dentry, pw_vfs_mount) == 0)
@@ -356,8 +379,11 @@ int32 VfsSyscall::open(const char* pathname, uint32 flag)
 
 int32 VfsSyscall::read(uint32 fd, char* buffer, uint32 count)
 {
-  FileDescriptor* file_descriptor = getFileDescriptor(fd);
+  return read(getFileDescriptor(fd), buffer, count);
+}
 
+int32 VfsSyscall::read(FileDescriptor* file_descriptor, char* buffer, uint32 count)
+{
   if (file_descriptor == 0)
   {
     debug(VFSSYSCALL, "(read) Error: the fd does not exist.\n");
@@ -376,9 +402,11 @@ int32 VfsSyscall::read(uint32 fd, char* buffer, uint32 count)
 
 int32 VfsSyscall::write(uint32 fd, const char *buffer, uint32 count)
 {
-  FileDescriptor* file_descriptor = getFileDescriptor(fd);
-  
+  return write(getFileDescriptor(fd), buffer, count);
+}
 
+int32 VfsSyscall::write(FileDescriptor* file_descriptor, const char *buffer, uint32 count)
+{
   if (file_descriptor == 0)
   {
     debug(VFSSYSCALL, "(write) Error: the fd does not exist.\n");
@@ -397,8 +425,11 @@ int32 VfsSyscall::write(uint32 fd, const char *buffer, uint32 count)
 
 l_off_t VfsSyscall::lseek(uint32 fd, l_off_t offset, uint8 origin)
 {
-  FileDescriptor* file_descriptor = getFileDescriptor(fd);
+  return lseek(getFileDescriptor(fd), offset, origin);
+}
 
+l_off_t VfsSyscall::lseek(FileDescriptor* file_descriptor, l_off_t offset, uint8 origin)
+{
   if (file_descriptor == 0)
   {
     debug(VFSSYSCALL, "(lseek) Error: the fd does not exist.\n");
@@ -408,10 +439,80 @@ l_off_t VfsSyscall::lseek(uint32 fd, l_off_t offset, uint8 origin)
   return file_descriptor->getFile()->lseek(offset, origin);
 }
 
+int32 VfsSyscall::copyFileRange(FileDescriptor* in, l_off_t* in_position, FileDescriptor* out,
+                                l_off_t* out_position, uint32 count)
+{
+  if (in == 0 || out == 0)
+  {
+    debug(VFSSYSCALL, "(copyFileRange) Error: the fd does not exist.\n");
+    return -1;
+  }
+  File* in_file = in->getFile();
+  File* out_file = out->getFile();
+  l_off_t read_position = in_position ? *in_position : in_file->lseek(0, SEEK_CUR);
+  l_off_t write_position = out_position ? *out_position : out_file->lseek(0, SEEK_CUR);
+  if (count > 0x7fffffff)
+    count = 0x7fffffff;
+  if (in_file->getInode() == out_file->getInode() &&
+      read_position < write_position + count && write_position < read_position + count)
+  {
+    debug(VFSSYSCALL, "(copyFileRange) Error: the ranges overlap.\n");
+    return -1;
+  }
+  if (count == 0)
+    return 0;
+
+  char* buffer = new char[count < VFS_COPY_CHUNK_SIZE ? count : VFS_COPY_CHUNK_SIZE];
+  int32 copied = 0;
+  while ((uint32) copied < count)
+  {
+    // the first chunk ends at a chunk boundary of the source, the following ones are aligned
+    uint32 chunk = VFS_COPY_CHUNK_SIZE - read_position % VFS_COPY_CHUNK_SIZE;
+    if (chunk > count - copied)
+      chunk = count - copied;
+    int32 num_read = in_file->readAt(buffer, chunk, read_position);
+    if (num_read <= 0)
+    {
+      if (num_read < 0 && !copied)
+        copied = -1;
+      break;
+    }
+    int32 written = out_file->writeAt(buffer, num_read, write_position);
+    if (written <= 0)
+    {
+      if (!copied)
+        copied = -1;
+      break;
+    }
+    read_position += written;
+    write_position += written;
+    copied += written;
+    if (written < num_read)
+      break;
+  }
+  delete[] buffer;
+
+  if (copied > 0)
+  {
+    if (in_position)
+      *in_position = read_position;
+    else
+      in_file->lseek(read_position, SEEK_SET);
+    if (out_position)
+      *out_position = write_position;
+    else
+      out_file->lseek(write_position, SEEK_SET);
+  }
+  return copied;
+}
+
 int32 VfsSyscall::flush(uint32 fd)
 {
-  FileDescriptor* file_descriptor = getFileDescriptor(fd);
+  return flush(getFileDescriptor(fd));
+}
 
+int32 VfsSyscall::flush(FileDescriptor* file_descriptor)
+{
   if (file_descriptor == 0)
   {
     debug(VFSSYSCALL, "(read) Error: the fd does not exist.\n");
@@ -424,6 +525,7 @@ int32 VfsSyscall::flush(uint32 fd)
 #ifndef EXE2MINIXFS
 int32 VfsSyscall::mount(const char *device_name, const char *dir_name, const char *file_system_name, int32 flag)
 {
+  WriteLock wl(dentry_tree_lock);
   FileSystemType* type = vfs.getFsType(file_system_name);
   if (!type && strcmp(file_system_name, "minixfs") == 0)
   {
@@ -437,6 +539,7 @@ int32 VfsSyscall::mount(const char *device_name, const char *dir_name, const cha
 
 int32 VfsSyscall::umount(const char *dir_name, int32 flag)
 {
+  WriteLock wl(dentry_tree_lock);
   return vfs.umount(dir_name, flag);
 }
 #endif
@@ -395,6 +395,10 @@ void MinixFSInode::loadChildren()
     debug(M_INODE, "loadChildren: Children allready loaded\n");
     return;
   }
+  // lookups only hold the dentry tree for reading, the first one loads and the others wait for it
+  MutexLock lock(((MinixFSSuperblock *) superblock_)->inode_list_lock_);
+  if (children_loaded_)
+    return;
   char dbuffer[ZONE_SIZE];
   for (uint32 zone = 0; zone < i_zones_->getNumZones(); zone++)
   {
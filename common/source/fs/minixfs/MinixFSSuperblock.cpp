@@ -16,7 +16,7 @@
 #define ROOT_NAME "/"
 
 MinixFSSuperblock::MinixFSSuperblock(Dentry* s_root, size_t s_dev, uint64 offset) :
-    Superblock(s_root, s_dev), superblock_(this)
+    Superblock(s_root, s_dev), superblock_(this), inode_list_lock_("MinixFSSuperblock::inode_list_lock_")
 {
   offset_ = offset;
   //read Superblock data from disc
@@ -324,6 +324,7 @@ int32 MinixFSSuperblock::createFd(Inode* inode, uint32 flag)
 {
   assert(inode);
 
+  MutexLock lock(inode_list_lock_);
   File* file = inode->link(flag);
   FileDescriptor* fd = new FileDescriptor(file);
   s_files_.push_back(fd);
@@ -342,6 +343,7 @@ int32 MinixFSSuperblock::removeFd(Inode* inode, FileDescriptor* fd)
   assert(inode);
   assert(fd);
 
+  MutexLock lock(inode_list_lock_);
   s_files_.remove(fd);
   FileDescriptor::remove(fd);
 
@@ -7,6 +7,7 @@ COWManager* COWManager::instance_ = nullptr;
 
 COWManager::COWManager() : cow_map_lock_("cow_list_lock")
 {
+  Mutex::setSpinLimit(cow_map_lock_.getName(), MUTEX_SHORT_SECTION_SPIN_YIELDS);
   debug(COWMANAGER, "cow manager constructed!\n");
 }
 
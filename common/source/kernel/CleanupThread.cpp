@@ -1,7 +1,9 @@
 #include "CleanupThread.h"
 #include "Scheduler.h"
+#include "ArchInterrupts.h"
+#include "ArchThreads.h"
 
-CleanupThread::CleanupThread() : Thread(0, "CleanupThread", Thread::KERNEL_THREAD)
+CleanupThread::CleanupThread() : Thread(0, "CleanupThread", Thread::KERNEL_THREAD), idle_(0)
 {
 }
 
@@ -19,8 +21,27 @@ void CleanupThread::Run()
 {
   while (1)
   {
-    Scheduler::instance()->cleanupDeadThreads();
+    if (Scheduler::instance()->cleanupDeadThreads())
+      continue;
+
+    // nothing died, sleep until addDeadThread wakes us up
+    ArchInterrupts::disableInterrupts();
+    if (!Scheduler::instance()->hasDeadThreads())
+    {
+      idle_ = 1;
+      setState(Sleeping);
+    }
+    ArchInterrupts::enableInterrupts();
     Scheduler::instance()->yield();
   }
 }
 
+void CleanupThread::wakeUp()
+{
+  bool interrupts = ArchInterrupts::disableInterrupts();
+  if (ArchThreads::testSetLock(idle_, 0))
+    setState(Running);
+  if (interrupts)
+    ArchInterrupts::enableInterrupts();
+}
+
@@ -0,0 +1,147 @@
+#include "Clocksource.h"
+#include "ArchInterrupts.h"
+#include "ports.h"
+#include "kprintf.h"
+#include "debug.h"
+
+#define PIT_CHANNEL2_DATA 0x42
+#define PIT_COMMAND 0x43
+#define PIT_CHANNEL2_GATE 0x61
+#define PIT_CHANNEL2_OUT 0x20
+#define PIT_MAX_POLLS 10000000
+
+Clocksource *Clocksource::instance_ = 0;
+
+Clocksource *Clocksource::instance()
+{
+  if (unlikely(!instance_))
+    instance_ = new Clocksource();
+  return instance_;
+}
+
+Clocksource::Clocksource() :
+  tsc_hz_(0), mult_(0), boot_cycles_(0), tick_ns_(0), tick_cycles_(0), invariant_(false)
+{
+}
+
+void Clocksource::calibrate()
+{
+  invariant_ = detectInvariantTSC();
+  if (!invariant_)
+    debug(CLOCKSOURCE, "calibrate: WARNING TSC is not invariant, times may drift with the cpu frequency\n");
+
+  uint64 best = 0;
+  for (size_t run = 0; run < TSC_CALIBRATION_RUNS; ++run)
+  {
+    uint64 cycles = measureCyclesPerWindow();
+    if (cycles != 0 && (best == 0 || cycles < best))
+      best = cycles;
+  }
+
+  if (best == 0)
+  {
+    debug(CLOCKSOURCE, "calibrate: PIT did not respond, assuming a 1 GHz TSC\n");
+    best = 1000000000ULL * TSC_CALIBRATION_MS / 1000;
+  }
+
+  tsc_hz_ = best * 1000 / TSC_CALIBRATION_MS;
+  mult_ = (NS_PER_SEC << TSC_MULT_SHIFT) / tsc_hz_;
+
+  // same divisor as ArchInterrupts::setTimerFrequency programs into channel 0
+  uint32 freq = IRQ0_TIMER_FREQUENCY;
+  uint64 divisor = (freq < PIT_FREQUENCY / (1 << 16) + 1) ? (1 << 16) : PIT_FREQUENCY / freq;
+  tick_ns_ = divisor * NS_PER_SEC / PIT_FREQUENCY;
+  tick_cycles_ = nsToCycles(tick_ns_);
+
+  boot_cycles_ = getCycles();
+
+  debug(CLOCKSOURCE, "calibrate: TSC runs at %zu kHz, mult %zu, one tick is %zu ns / %zu cycles\n",
+        tsc_hz_ / 1000, mult_, tick_ns_, tick_cycles_);
+}
+
+uint64 Clocksource::measureCyclesPerWindow()
+{
+  uint64 latch = PIT_FREQUENCY * TSC_CALIBRATION_MS / 1000;
+  uint8 gate = inportb(PIT_CHANNEL2_GATE);
+
+  // channel 2 gate high, speaker off, then mode 0: OUT goes high once the count hits zero
+  outportb(PIT_CHANNEL2_GATE, (gate & ~0x02) | 0x01);
+  outportb(PIT_COMMAND, 0xB0);
+  outportb(PIT_CHANNEL2_DATA, latch & 0xFF);
+  outportb(PIT_CHANNEL2_DATA, (latch >> 8) & 0xFF);
+
+  uint64 start = getCycles();
+  size_t polls = 0;
+  while (!(inportb(PIT_CHANNEL2_GATE) & PIT_CHANNEL2_OUT) && polls < PIT_MAX_POLLS)
+    ++polls;
+  uint64 end = getCycles();
+
+  outportb(PIT_CHANNEL2_GATE, gate);
+
+  if (polls == PIT_MAX_POLLS)
+    return 0;
+  return end - start;
+}
+
+bool Clocksource::detectInvariantTSC()
+{
+  uint32 eax, ebx, ecx, edx;
+  asm volatile ("cpuid" : "=a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx) : "a"(0x80000000));
+  if (eax < 0x80000007)
+    return false;
+  asm volatile ("cpuid" : "=a"(eax), "=b"(ebx), "=c"(ecx), "=d"(edx) : "a"(0x80000007));
+  return edx & (1 << 8);
+}
+
+uint64 Clocksource::getCycles()
+{
+  uint32 low, high;
+  asm volatile ("rdtsc" : "=a"(low), "=d"(high));
+  return ((uint64)high << 32) | low;
+}
+
+uint64 Clocksource::getMonotonicNs()
+{
+  return cyclesToNs(getCycles() - boot_cycles_);
+}
+
+uint64 Clocksource::cyclesToNs(uint64 cycles)
+{
+  return (uint64)(((unsigned __int128)cycles * mult_) >> TSC_MULT_SHIFT);
+}
+
+uint64 Clocksource::nsToCycles(uint64 ns)
+{
+  // split into seconds and the rest so that nothing overflows 64 bits
+  return (ns / NS_PER_SEC) * tsc_hz_ + ((ns % NS_PER_SEC) * tsc_hz_) / NS_PER_SEC;
+}
+
+bool Clocksource::isInvariant()
+{
+  return invariant_;
+}
+
+uint64 Clocksource::getTSCFrequency()
+{
+  return tsc_hz_;
+}
+
+uint64 Clocksource::getMult()
+{
+  return mult_;
+}
+
+uint64 Clocksource::getBootCycles()
+{
+  return boot_cycles_;
+}
+
+uint64 Clocksource::getTickNs()
+{
+  return tick_ns_;
+}
+
+uint64 Clocksource::getTickCycles()
+{
+  return tick_cycles_;
+}
@@ -50,10 +50,15 @@ void Condition::wait(bool re_acquire_mutex, pointer called_by)
   lockWaitersList();
   last_accessed_at_ = called_by;
   // The mutex can be released here, because for waking up another thread, the list lock is needed, which is still held by the thread.
+  uint64 wait_start = profileStart();
+  currentThread->reacquire_after_wait_ = re_acquire_mutex;
   mutex_->release(called_by);
   sleepAndRelease();
-  // Thread has been woken up again
+  // Thread has been woken up again, either by a signal or by the mutex it was moved to
   currentThread->lock_waiting_on_ = 0;
+  currentThread->reacquire_after_wait_ = false;
+  // time spent sleeping on a condition is waiting time, a condition is never held
+  profileWait(called_by, wait_start);
 
   if(re_acquire_mutex)
   {
@@ -86,20 +91,34 @@ void Condition::signal(pointer called_by, bool broadcast)
     Thread* thread_to_be_woken_up = popBackThreadFromWaitersList();
     unlockWaitersList();
 
-    if(thread_to_be_woken_up)
+    if(!thread_to_be_woken_up)
     {
-      //debug(LOCK, "Condition: Thread %s (%p) being signaled for condition %s (%p).\n",
-      //      thread_to_be_woken_up->getName(), thread_to_be_woken_up, getName(), this);
+      break;
+    }
+    //debug(LOCK, "Condition: Thread %s (%p) being signaled for condition %s (%p).\n",
+    //      thread_to_be_woken_up->getName(), thread_to_be_woken_up, getName(), this);
 
-      Scheduler::instance()->wake(thread_to_be_woken_up);
+    if(thread_to_be_woken_up->reacquire_after_wait_)
+    {
+      // We hold the mutex, so waking the thread up now would only make it sleep on the mutex right away.
+      // Let it wait there instead, the release of the mutex wakes it up (wait morphing).
+      moveToMutex(thread_to_be_woken_up);
     }
     else
     {
-      break;
+      Scheduler::instance()->wake(thread_to_be_woken_up);
     }
   } while (broadcast);
 }
 
+void Condition::moveToMutex(Thread* thread)
+{
+  mutex_->lockWaitersList();
+  thread->lock_waiting_on_ = mutex_;
+  mutex_->pushFrontThreadToWaitersList(thread);
+  mutex_->unlockWaitersList();
+}
+
 void Condition::broadcast(pointer called_by)
 {
   signal(called_by, true);
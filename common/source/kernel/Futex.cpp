@@ -0,0 +1,141 @@
+#include "Futex.h"
+#include "Thread.h"
+#include "Scheduler.h"
+#include "Loader.h"
+#include "ArchMemory.h"
+#include "offsets.h"
+#include "kprintf.h"
+#include "debug.h"
+
+Futex *Futex::instance_ = 0;
+
+Futex *Futex::instance()
+{
+  if (unlikely(!instance_))
+    instance_ = new Futex();
+  return instance_;
+}
+
+Futex::Futex()
+{
+}
+
+bool Futex::getKey(uint32* address, Key& key)
+{
+  if ((size_t)address >= USER_BREAK || ((size_t)address % sizeof(uint32)) || !currentThread->t_loader_)
+    return false;
+  key.space = currentThread->t_loader_;
+  key.address = (size_t)address;
+  return true;
+}
+
+Futex::Bucket& Futex::getBucket(Key const& key)
+{
+  return buckets_[(key.address / sizeof(uint32) + (size_t)key.space / sizeof(size_t)) % FUTEX_HASH_BUCKETS];
+}
+
+size_t Futex::wait(uint32* address, uint32 expected)
+{
+  Key key;
+  if (!getKey(address, key))
+    return -1U;
+
+  Bucket& bucket = getBucket(key);
+  Waiter waiter = { key, currentThread };
+
+  // a fault on this read pages the word in, or ends the thread while no lock is held
+  __atomic_load_n(address, __ATOMIC_SEQ_CST);
+
+  bucket.lock_.acquire();
+  // checked under the bucket lock, a waker changes the value before it takes the lock.
+  // Read through the identity mapping of the page the word is mapped to now, this cannot fault.
+  size_t word = currentThread->t_loader_->arch_memory_.checkAddressValid((size_t)address);
+  if (!word || *(volatile uint32*)word != expected)
+  {
+    bucket.lock_.release();
+    return -1U;
+  }
+  bucket.waiters_.push_back(&waiter);
+  bucket.lock_.release();
+  // a waker that already dequeued us waits in Scheduler::wake until we sleep
+  Scheduler::instance()->sleep();
+  return 0;
+}
+
+size_t Futex::wake(uint32* address, size_t count)
+{
+  return requeue(address, count, 0, 0);
+}
+
+size_t Futex::requeue(uint32* address, size_t count, uint32* address2, size_t requeue_count)
+{
+  Key key;
+  if (!getKey(address, key))
+    return -1U;
+  Key key2 = { 0, 0 };
+  if (requeue_count && !getKey(address2, key2))
+    return -1U;
+
+  Bucket& bucket = getBucket(key);
+  Bucket* bucket2 = requeue_count ? &getBucket(key2) : 0;
+  // fixed order, so two concurrent requeues cannot deadlock
+  Mutex* first = &bucket.lock_;
+  Mutex* second = (bucket2 && bucket2 != &bucket) ? &bucket2->lock_ : 0;
+  if (second && second < first)
+    ustl::swap(first, second);
+  first->acquire();
+  if (second)
+    second->acquire();
+
+  size_t woken = 0;
+  ustl::list<Waiter*> moved;
+  for (auto it = bucket.waiters_.begin(); it != bucket.waiters_.end() && (woken < count || moved.size() < requeue_count);)
+  {
+    Waiter* waiter = *it;
+    if (!(waiter->key == key))
+    {
+      ++it;
+      continue;
+    }
+    it = bucket.waiters_.erase(it);
+    if (woken < count)
+    {
+      Scheduler::instance()->wake(waiter->thread);
+      ++woken;
+    }
+    else
+    {
+      waiter->key = key2;
+      moved.push_back(waiter);
+    }
+  }
+  // appended afterwards, bucket2 may be the list we just walked
+  for (Waiter* waiter : moved)
+    bucket2->waiters_.push_back(waiter);
+
+  if (second)
+    second->release();
+  first->release();
+  debug(FUTEX, "requeue: address %zx woke %zu, moved %zu to %zx\n", key.address, woken, moved.size(), key2.address);
+  return woken;
+}
+
+void Futex::wakeThread(Thread* thread)
+{
+  for (size_t i = 0; i < FUTEX_HASH_BUCKETS; ++i)
+  {
+    Bucket& bucket = buckets_[i];
+    bucket.lock_.acquire();
+    for (auto it = bucket.waiters_.begin(); it != bucket.waiters_.end(); ++it)
+    {
+      if ((*it)->thread == thread)
+      {
+        bucket.waiters_.erase(it);
+        Scheduler::instance()->wake(thread);
+        bucket.lock_.release();
+        return;
+      }
+    }
+    bucket.lock_.release();
+  }
+}
@@ -14,6 +14,7 @@
 #include <umemory.h>
 #include "File.h"
 #include "FileDescriptor.h"
+#include "Vdso.h"
 
 Loader::Loader(ssize_t fd) :
   fd_(fd), hdr_(0), phdrs_(),
@@ -155,6 +156,12 @@ bool Loader::loadExecutableAndInitProcess()
   return true;
 }
 
+void Loader::mapVdso(size_t process_page_ppn)
+{
+  debug(LOADER, "Loader::mapVdso: mapping vdso pages, process page ppn %zx\n", process_page_ppn);
+  Vdso::instance()->mapInto(arch_memory_, process_page_ppn);
+}
+
 bool Loader::loadDebugInfoIfAvailable()
 {
   assert(!userspace_debug_info_ && "You may not load User Debug Info twice!");
@@ -6,14 +6,30 @@
 #include "ArchInterrupts.h"
 #include "Scheduler.h"
 #include "Stabs2DebugInfo.h"
+#include "Clocksource.h"
+#include "kstring.h"
 extern Stabs2DebugInfo const* kernel_debug_info;
 
+LockClass Lock::classes_[LOCK_MAX_CLASSES];
+size_t Lock::num_classes_ = 0;
+
+static void printCallPoint(pointer address)
+{
+  if (kernel_debug_info)
+    kernel_debug_info->printCallInformation(address);
+  else
+    kprintfd("%zx\n", address);
+}
+
 Lock::Lock(const char *name) :
   held_by_(0),
   next_lock_on_holding_list_(0),
   last_accessed_at_(0),
+  class_(getClass(name)),
+  acquired_at_(0),
   name_(name ? name : ""),
   waiters_list_(0),
+  waiters_list_tail_(0),
   waiters_list_lock_(0)
 {
 }
@@ -62,6 +78,131 @@ void Lock::printHoldingList(Thread* thread)
   }
 }
 
+LockClass* Lock::getClass(const char* name)
+{
+  // locks are created everywhere, even before the scheduler runs, a short irq-off section is simplest
+  if (!name || !name[0])
+    name = "(unnamed)";
+  bool interrupts = ArchInterrupts::disableInterrupts();
+  LockClass* lock_class = 0;
+  for (size_t i = 0; i < num_classes_ && !lock_class; ++i)
+  {
+    if (strncmp(classes_[i].name, name, LOCK_CLASS_NAME_LENGTH - 1) == 0)
+      lock_class = &classes_[i];
+  }
+  if (!lock_class)
+  {
+    // the last slot collects everything that did not fit
+    lock_class = &classes_[num_classes_ < LOCK_MAX_CLASSES ? num_classes_++ : LOCK_MAX_CLASSES - 1];
+    if (!lock_class->name[0])
+    {
+      strncpy(lock_class->name, name, LOCK_CLASS_NAME_LENGTH - 1);
+      lock_class->spin_limit = MUTEX_DEFAULT_SPIN_YIELDS;
+    }
+    else
+    {
+      lock_class->shared = true;
+    }
+  }
+  if (interrupts)
+    ArchInterrupts::enableInterrupts();
+  return lock_class;
+}
+
+uint64 Lock::profileStart()
+{
+  return Clocksource::instance()->getCycles();
+}
+
+void Lock::profileWait(pointer called_by, uint64 wait_start)
+{
+  ++class_->acquisitions;
+  if (!wait_start)
+    return;
+  uint64 waited = profileStart() - wait_start;
+  // several waiters of the same class may be woken up in a row, keep the call site table consistent
+  bool interrupts = ArchInterrupts::disableInterrupts();
+  ++class_->contended;
+  class_->wait_cycles += waited;
+  if (waited > class_->max_wait_cycles)
+    class_->max_wait_cycles = waited;
+  // keep the call sites that waited most often, a new one replaces the least frequent one
+  LockCallSite* site = &class_->call_sites[0];
+  for (size_t i = 0; i < LOCK_CLASS_CALL_SITES; ++i)
+  {
+    if (class_->call_sites[i].address == called_by)
+    {
+      site = &class_->call_sites[i];
+      break;
+    }
+    if (class_->call_sites[i].count < site->count)
+      site = &class_->call_sites[i];
+  }
+  if (site->address != called_by)
+  {
+    site->address = called_by;
+    site->count = 0;
+    site->wait_cycles = 0;
+  }
+  ++site->count;
+  site->wait_cycles += waited;
+  if (interrupts)
+    ArchInterrupts::enableInterrupts();
+}
+
+void Lock::profileAcquired(pointer called_by, uint64 wait_start)
+{
+  profileWait(called_by, wait_start);
+  acquired_at_ = profileStart();
+}
+
+void Lock::profileReleased()
+{
+  if (!acquired_at_)
+    return;
+  // only the holder gets here, and the next holder cannot overwrite acquired_at_ before we gave up the lock
+  uint64 held = profileStart() - acquired_at_;
+  acquired_at_ = 0;
+  class_->hold_cycles += held;
+  if (held > class_->max_hold_cycles)
+    class_->max_hold_cycles = held;
+}
+
+void Lock::printStatistics()
+{
+  // snapshot the order, the counters themselves keep running while we print
+  LockClass* sorted[LOCK_MAX_CLASSES];
+  size_t count = 0;
+  for (size_t i = 0; i < num_classes_; ++i)
+  {
+    LockClass* lock_class = &classes_[i];
+    if (!lock_class->acquisitions)
+      continue;
+    size_t j = count++;
+    for (; j > 0 && sorted[j - 1]->wait_cycles < lock_class->wait_cycles; --j)
+      sorted[j] = sorted[j - 1];
+    sorted[j] = lock_class;
+  }
+  debug(LOCK, "Lock contention profile (cycles), longest total wait first:\n");
+  kprintfd("%-31s %10s %10s %14s %12s %14s %12s %8s %8s\n", "name", "acquired", "contended", "wait", "max wait",
+           "hold", "max hold", "spun", "yields");
+  for (size_t i = 0; i < count; ++i)
+  {
+    LockClass* c = sorted[i];
+    kprintfd("%-31s %10zu %10zu %14zu %12zu %14zu %12zu %8zu %8zu\n", c->name, c->acquisitions, c->contended,
+             c->wait_cycles, c->max_wait_cycles, c->hold_cycles, c->max_hold_cycles, c->acquired_spinning,
+             c->spin_yields);
+    for (size_t s = 0; s < LOCK_CLASS_CALL_SITES; ++s)
+    {
+      LockCallSite& site = c->call_sites[s];
+      if (!site.count)
+        continue;
+      kprintfd("    %8zu waits, %14zu cycles at ", site.count, site.wait_cycles);
+      printCallPoint(site.address);
+    }
+  }
+}
+
 void Lock::pushFrontToCurrentThreadHoldingList()
 {
   if(!currentThread)
@@ -96,7 +237,7 @@ void Lock::printStatus()
   }
 }
 
-void Lock::checkForDeadLock()
+void Lock::checkForDeadLock(pointer called_by)
 {
   if(!currentThread)
     return;
@@ -107,9 +248,73 @@ void Lock::checkForDeadLock()
     printStatus();
     assert(false);
   }
-  checkForCircularDeadLock(currentThread, this);
+#ifdef LOCKDEP
+  checkLockOrder(called_by);
+#else
+  (void)called_by;
+#endif
 }
 
+#ifdef LOCKDEP
+void Lock::checkLockOrder(pointer called_by)
+{
+  if(class_->shared)
+    return;
+  size_t index = class_ - classes_;
+  uint64 bit = 1ULL << (index % 64);
+  for(Lock* held = currentThread->holding_lock_list_; held != 0; held = held->next_lock_on_holding_list_)
+  {
+    LockClass* held_class = held->class_;
+    // nesting two locks of one class (e.g. of two processes) cannot be told apart by name
+    if(held_class == class_ || held_class->shared || (held_class->nested[index / 64] & bit))
+      continue;
+
+    // an order we have not seen yet, the graph only changes here
+    bool interrupts = ArchInterrupts::disableInterrupts();
+    size_t held_index = held_class - classes_;
+    if(!(held_class->nested[index / 64] & bit))
+    {
+      uint64 visited[LOCK_CLASS_WORDS] = {};
+      if(findLockOrderPath(index, held_index, visited, false))
+      {
+        debug(LOCK, "Lock order inversion: %s (%p) is acquired while holding %s (%p) by thread %s (%p) at ",
+              class_->name, this, held_class->name, held, currentThread->getName(), currentThread);
+        printCallPoint(called_by);
+        debug(LOCK, "but the opposite order has been seen before (last step first), this may deadlock:\n");
+        uint64 printed[LOCK_CLASS_WORDS] = {};
+        findLockOrderPath(index, held_index, printed, true);
+      }
+      held_class->nested[index / 64] |= bit;
+      held_class->nested_at[index] = called_by;
+    }
+    if(interrupts)
+      ArchInterrupts::enableInterrupts();
+  }
+}
+
+bool Lock::findLockOrderPath(size_t from, size_t to, uint64* visited, bool print)
+{
+  visited[from / 64] |= 1ULL << (from % 64);
+  LockClass& from_class = classes_[from];
+  for(size_t next = 0; next < num_classes_; ++next)
+  {
+    uint64 bit = 1ULL << (next % 64);
+    if(!(from_class.nested[next / 64] & bit))
+      continue;
+    if(next == to || (!(visited[next / 64] & bit) && findLockOrderPath(next, to, visited, print)))
+    {
+      if(print)
+      {
+        kprintfd("    %s -> %s first at ", from_class.name, classes_[next].name);
+        printCallPoint(from_class.nested_at[next]);
+      }
+      return true;
+    }
+  }
+  return false;
+}
+#endif
+
 void Lock::removeFromCurrentThreadHoldingList()
 {
   if(!currentThread)
@@ -153,68 +358,17 @@ void Lock::checkCurrentThreadStillWaitingOnAnotherLock()
   }
 }
 
-void Lock::doChecksBeforeWaiting()
+void Lock::doChecksBeforeWaiting(pointer called_by)
 {
   // Check if the interrupts are set. Else, we maybe wait forever
   checkInterrupts("Lock::doChecksBeforeWaiting");
   // Check if the thread has been waken up even if he is already waiting on another lock.
   checkCurrentThreadStillWaitingOnAnotherLock();
   // Check if locking this lock would result in a deadlock.
-  checkForDeadLock();
+  checkForDeadLock(called_by);
 }
 
 
-void Lock::checkForCircularDeadLock(Thread* thread_waiting, Lock* start)
-{
-  // Check all locks which are held by the target thread.
-  // This can be done, because we know that the list may not be modified
-  // (accept of an atomic push front, which does not matter at all)
-  for(Lock* lock = thread_waiting->holding_lock_list_; lock != 0; lock = lock->next_lock_on_holding_list_)
-  {
-    // In case a thread which is indirectly waiting for the current thread
-    // holds the lock, a deadlock happened.
-    if(lock == start)
-    {
-      printOutCircularDeadLock(thread_waiting);
-      assert(false);
-    }
-    for(Thread* thread_waiting = lock->waiters_list_; thread_waiting != 0;
-        thread_waiting = thread_waiting->next_thread_in_lock_waiters_list_)
-    {
-      // The method has to be called recursively, so it is possible to check indirect
-      // deadlocks. The recursive approach may be slower than other checking methods,
-      // but it is safe and more precise
-      checkForCircularDeadLock(thread_waiting, start);
-    }
-  }
-}
-
-void Lock::printOutCircularDeadLock(Thread* starting)
-{
-  debug(LOCK, "CIRCULAR DEADLOCK when waiting for %s (%p) with thread %s (%p)!\n",
-        getName(), this, currentThread->getName(), currentThread);
-  debug(LOCK, "Printing out the circular deadlock:\n");
-  currentThread->lock_waiting_on_ = this;
-  // in this case we can access the other threads, because we KNOW that they are indirectly waiting on the current thread.
-  for(Thread* thread = starting; thread != 0; thread = thread->lock_waiting_on_->held_by_)
-  {
-    Thread * holding = thread->lock_waiting_on_->held_by_;
-    Lock* lock = thread->lock_waiting_on_;
-    debug(LOCK, "Thread %-40.40s (%p) holding lock %-40.40s (%p), waiting for lock %-40.40s (%p)\n",
-          holding->getName(), holding, lock->getName(),
-          lock, holding->lock_waiting_on_->getName(),
-          holding->lock_waiting_on_);
-    if(kernel_debug_info)
-    {
-      debug(LOCK, "This lock has been locked at ");
-      kernel_debug_info->printCallInformation(lock->last_accessed_at_);
-    }
-    // In the thread we are looking at is the current one, we have to stop.
-    // It would result in an endless loop (circular print out ^^).
-    if(thread == currentThread) break;
-  }
-}
-
 void Lock::checkInterrupts(const char* method)
 {
   // it would be nice to assert Scheduler::instance()->isSchedulingEnabled() as well.
@@ -249,40 +403,44 @@ void Lock::unlockWaitersList()
 void Lock::pushFrontCurrentThreadToWaitersList()
 {
   assert(currentThread);
+  pushFrontThreadToWaitersList(currentThread);
+}
+
+void Lock::pushFrontThreadToWaitersList(Thread* thread)
+{
   assert(waitersListIsLocked());
-  currentThread->next_thread_in_lock_waiters_list_ = waiters_list_;
+  thread->prev_thread_in_lock_waiters_list_ = 0;
+  thread->next_thread_in_lock_waiters_list_ = waiters_list_;
+  if(waiters_list_)
+    waiters_list_->prev_thread_in_lock_waiters_list_ = thread;
+  else
+    waiters_list_tail_ = thread;
   // the following set has to be atomic
-  // waiters_list_ = currentThread;
-  ArchThreads::atomic_set((pointer&)(waiters_list_), (pointer)(currentThread));
+  // waiters_list_ = thread;
+  ArchThreads::atomic_set((pointer&)(waiters_list_), (pointer)(thread));
 }
 
 Thread* Lock::popBackThreadFromWaitersList()
 {
   assert(waitersListIsLocked());
-  Thread* thread = 0;
-  if(waiters_list_ == 0)
+  Thread* thread = waiters_list_tail_;
+  if(thread == 0)
   {
     // the waiters list is empty
+    return 0;
   }
-  else if(waiters_list_->next_thread_in_lock_waiters_list_ == 0)
+  waiters_list_tail_ = thread->prev_thread_in_lock_waiters_list_;
+  if(waiters_list_tail_ == 0)
   {
-    // this thread is the only one in the waiters list
-    thread = waiters_list_;
+    // this thread was the only one in the waiters list
     ArchThreads::atomic_set((pointer&)(waiters_list_), (pointer)(0));
-    waiters_list_ = 0;
   }
   else
   {
-    // there is more than one thread in the waiters list
-    // search for the thread before the last thread in the list
-    Thread* previos;
-    for(previos = waiters_list_; previos->next_thread_in_lock_waiters_list_->next_thread_in_lock_waiters_list_ != 0;
-        previos = previos->next_thread_in_lock_waiters_list_);
-
-    thread = previos->next_thread_in_lock_waiters_list_;
     // remove the last element
-    ArchThreads::atomic_set((pointer&)(previos->next_thread_in_lock_waiters_list_), (pointer)(0));
+    ArchThreads::atomic_set((pointer&)(waiters_list_tail_->next_thread_in_lock_waiters_list_), (pointer)(0));
   }
+  thread->prev_thread_in_lock_waiters_list_ = 0;
   return thread;
 }
 
@@ -292,28 +450,24 @@ void Lock::removeCurrentThreadFromWaitersList()
     return;
   assert(waitersListIsLocked());
   assert(waiters_list_);
-  if(currentThread == waiters_list_)
+  Thread* previous = currentThread->prev_thread_in_lock_waiters_list_;
+  Thread* next = currentThread->next_thread_in_lock_waiters_list_;
+  if(previous == 0)
   {
     // the current thread is the first element
-    ArchThreads::atomic_set((pointer&)(waiters_list_), (pointer)(currentThread->next_thread_in_lock_waiters_list_));
+    assert(currentThread == waiters_list_);
+    ArchThreads::atomic_set((pointer&)(waiters_list_), (pointer)(next));
   }
   else
   {
-
-    for(Thread* thread = waiters_list_; thread->next_thread_in_lock_waiters_list_ != 0;
-        thread = thread->next_thread_in_lock_waiters_list_)
-    {
-      if(thread->next_thread_in_lock_waiters_list_ == currentThread)
-      {
-
-        ArchThreads::atomic_set((pointer&)(thread->next_thread_in_lock_waiters_list_),
-                                (pointer)(currentThread->next_thread_in_lock_waiters_list_));
-        break;
-      }
-    }
+    ArchThreads::atomic_set((pointer&)(previous->next_thread_in_lock_waiters_list_), (pointer)(next));
   }
+  if(next == 0)
+    waiters_list_tail_ = previous;
+  else
+    next->prev_thread_in_lock_waiters_list_ = previous;
   ArchThreads::atomic_set((pointer&)(currentThread->next_thread_in_lock_waiters_list_ ), (pointer)0);
-  return;
+  currentThread->prev_thread_in_lock_waiters_list_ = 0;
 }
 
 void Lock::checkInvalidRelease(const char* method)
@@ -15,6 +15,11 @@ Mutex::Mutex(const char* name) :
 {
 }
 
+void Mutex::setSpinLimit(const char* name, size_t yields)
+{
+  getClass(name)->spin_limit = yields;
+}
+
 bool Mutex::acquireNonBlocking(pointer called_by)
 {
   if(unlikely(system_state != RUNNING))
@@ -32,7 +37,7 @@ bool Mutex::acquireNonBlocking(pointer called_by)
   // There may be some cases where the pre-checks may not be wished here.
   // But these cases are usually dirty implemented, and it would not be necessary to call this method there.
   // So in case you see this comment, re-think your implementation and don't just comment out this line!
-  doChecksBeforeWaiting();
+  doChecksBeforeWaiting(called_by);
 
   if(ArchThreads::testSetLock(mutex_, 1))
   {
@@ -41,6 +46,7 @@ bool Mutex::acquireNonBlocking(pointer called_by)
     return false;
   }
   assert(held_by_ == 0);
+  profileAcquired(called_by, 0);
   last_accessed_at_ = called_by;
   held_by_ = currentThread;
   pushFrontToCurrentThreadHoldingList();
@@ -61,8 +67,58 @@ void Mutex::acquire(pointer called_by)
 //    kernel_debug_info->printCallInformation(called_by);
 //  }
   // check for deadlocks, interrupts...
-  doChecksBeforeWaiting();
+  doChecksBeforeWaiting(called_by);
+
+  uint64 wait_start = 0;
+  if(ArchThreads::testSetLock(mutex_, 1))
+  {
+    wait_start = profileStart();
+    if(spin(class_->spin_limit))
+      ++class_->acquired_spinning;
+    else
+      acquireSleeping();
+  }
 
+  assert(held_by_ == 0);
+  profileAcquired(called_by, wait_start);
+  pushFrontToCurrentThreadHoldingList();
+  last_accessed_at_ = called_by;
+  held_by_ = currentThread;
+}
+
+bool Mutex::spin(size_t limit)
+{
+  // There is only one cpu: "spinning" means handing it to the holder, so a short
+  // critical section can finish without the sleep/wake round trip. A holder that
+  // sleeps itself will not be done soon, then we go to sleep right away.
+  size_t yields = 0;
+  bool acquired = false;
+  while(yields < limit)
+  {
+    // Snapshot of the holder with interrupts off: on the single cpu nothing else runs meanwhile,
+    // so the holder cannot release the mutex, exit and be deleted by the cleanup thread in between.
+    bool interrupts = ArchInterrupts::disableInterrupts();
+    Thread* holder = held_by_;
+    bool holder_running = !holder || holder->getState() == Running;
+    if(interrupts)
+      ArchInterrupts::enableInterrupts();
+    if(!holder_running)
+      break;
+    Scheduler::instance()->yield();
+    ++yields;
+    if(!ArchThreads::testSetLock(mutex_, 1))
+    {
+      acquired = true;
+      break;
+    }
+  }
+  // only updated while holding the mutex, or racing with a holder that cannot run
+  class_->spin_yields += yields;
+  return acquired;
+}
+
+void Mutex::acquireSleeping()
+{
   while(ArchThreads::testSetLock(mutex_, 1))
   {
     checkCurrentThreadStillWaitingOnAnotherLock();
@@ -79,11 +135,6 @@ void Mutex::acquire(pointer called_by)
     // We have been waken up again.
     currentThread->lock_waiting_on_ = 0;
   }
-
-  assert(held_by_ == 0);
-  pushFrontToCurrentThreadHoldingList();
-  last_accessed_at_ = called_by;
-  held_by_ = currentThread;
 }
 
 void Mutex::release(pointer called_by)
@@ -100,6 +151,7 @@ void Mutex::release(pointer called_by)
 //    kernel_debug_info->printCallInformation(called_by);
 //  }
   checkInvalidRelease("Mutex::release");
+  profileReleased();
   removeFromCurrentThreadHoldingList();
   last_accessed_at_ = called_by;
   held_by_ = 0;
@@ -0,0 +1,155 @@
+#include "OpenFile.h"
+#include "VfsSyscall.h"
+#include "Terminal.h"
+#include "Thread.h"
+#include "kprintf.h"
+#include "assert.h"
+
+OpenFile::OpenFile(Type type) :
+  type_(type), refs_(1)
+{
+}
+
+OpenFile::~OpenFile()
+{
+  assert(!refs_);
+}
+
+void OpenFile::ref()
+{
+  size_t old_refs = __atomic_fetch_add(&refs_, 1, __ATOMIC_RELAXED);
+  assert(old_refs && "OpenFile::ref: the open file is already closed");
+}
+
+void OpenFile::unref()
+{
+  if (__atomic_sub_fetch(&refs_, 1, __ATOMIC_ACQ_REL) == 0)
+    delete this;
+}
+
+VfsOpenFile::VfsOpenFile(FileDescriptor* descriptor) :
+  OpenFile(VFS_FILE), descriptor_(descriptor)
+{
+  assert(descriptor_);
+}
+
+VfsOpenFile::~VfsOpenFile()
+{
+  VfsSyscall::close(descriptor_);
+}
+
+size_t VfsOpenFile::read(char* buffer, size_t count)
+{
+  return VfsSyscall::read(descriptor_, buffer, count);
+}
+
+size_t VfsOpenFile::write(const char* buffer, size_t count)
+{
+  return VfsSyscall::write(descriptor_, buffer, count);
+}
+
+l_off_t VfsOpenFile::lseek(l_off_t offset, uint8 origin)
+{
+  return VfsSyscall::lseek(descriptor_, offset, origin);
+}
+
+size_t VfsOpenFile::fsync()
+{
+  return VfsSyscall::flush(descriptor_) == 0 ? 0 : -1;
+}
+
+PipeOpenFile::PipeOpenFile(Pipe* pipe, Pipe::End end) :
+  OpenFile(PIPE_END), pipe_(pipe), end_(end)
+{
+  assert(pipe_);
+}
+
+PipeOpenFile::~PipeOpenFile()
+{
+  if (pipe_->close(end_))
+    delete pipe_;
+}
+
+size_t PipeOpenFile::read(char* buffer, size_t count)
+{
+  if (end_ != Pipe::READ_END)
+    return -1;
+  return pipe_->read(buffer, count);
+}
+
+size_t PipeOpenFile::write(const char* buffer, size_t count)
+{
+  if (end_ != Pipe::WRITE_END)
+    return -1;
+  return pipe_->write(buffer, count);
+}
+
+uint32 PipeOpenFile::poll(PollEntry* entry)
+{
+  return pipe_->poll(end_, entry);
+}
+
+void PipeOpenFile::wakeUpAll()
+{
+  pipe_->wakeUpAll();
+}
+
+SocketOpenFile::SocketOpenFile(UnixSocket* socket) :
+  OpenFile(SOCKET), socket_(socket)
+{
+  assert(socket_);
+}
+
+SocketOpenFile::~SocketOpenFile()
+{
+  socket_->close();
+  socket_->unref();
+}
+
+size_t SocketOpenFile::read(char* buffer, size_t count)
+{
+  return socket_->recv(buffer, count);
+}
+
+size_t SocketOpenFile::write(const char* buffer, size_t count)
+{
+  return socket_->send(buffer, count);
+}
+
+uint32 SocketOpenFile::poll(PollEntry* entry)
+{
+  return socket_->poll(entry);
+}
+
+void SocketOpenFile::wakeUpAll()
+{
+  socket_->wakeUpAll();
+}
+
+TerminalOpenFile::TerminalOpenFile() :
+  OpenFile(TERMINAL)
+{
+}
+
+size_t TerminalOpenFile::read(char* buffer, size_t count)
+{
+  //this doesn't! terminate a string with \0, gotta do that yourself
+  return currentThread->getTerminal()->readLine(buffer, count);
+}
+
+size_t TerminalOpenFile::write(const char* buffer, size_t count)
+{
+  debug(SYSCALL, "Syscall::write: %.*s\n", (int)count, buffer);
+  kprintf("%.*s", (int)count, buffer);
+  return count;
+}
+
+uint32 TerminalOpenFile::poll(PollEntry* entry)
+{
+  return currentThread->getTerminal()->poll(entry) | POLLOUT;
+}
+
+void TerminalOpenFile::wakeUpAll()
+{
+  currentThread->getTerminal()->wakeUpAll();
+}
@@ -0,0 +1,193 @@
+#include "Pipe.h"
+#include "MutexLock.h"
+#include "UserThread.h"
+#include "OpenFile.h"
+#include "kprintf.h"
+#include "assert.h"
+#include <ualgo.h>
+
+static bool cancelRequested()
+{
+  return currentThread->getType() == Thread::USER_THREAD && ((UserThread*)currentThread)->shouldCancel();
+}
+
+Pipe::Pipe(size_t capacity, PollWaitQueue* poll_queue) :
+  buffer_(capacity), readers_(1), writers_(1), splicing_in_(false), splicing_out_(false),
+  lock_("Pipe::lock_"), not_empty_(&lock_, "Pipe::not_empty_"), not_full_(&lock_, "Pipe::not_full_"),
+  own_poll_queue_("Pipe::poll_queue_"), poll_queue_(poll_queue ? poll_queue : &own_poll_queue_)
+{
+  assert(buffer_.capacity() >= PIPE_ATOMIC_WRITE_SIZE);
+}
+
+Pipe::~Pipe()
+{
+  assert(!readers_ && !writers_);
+}
+
+bool Pipe::close(End end)
+{
+  MutexLock lock(lock_);
+  if (end == READ_END)
+  {
+    assert(readers_);
+    // blocked writers fail now
+    if (!--readers_)
+    {
+      not_full_.broadcast();
+      poll_queue_->wakeUpAll();
+    }
+  }
+  else
+  {
+    assert(writers_);
+    // blocked readers see the end of file now
+    if (!--writers_)
+    {
+      not_empty_.broadcast();
+      poll_queue_->wakeUpAll();
+    }
+  }
+  return !readers_ && !writers_;
+}
+
+size_t Pipe::read(char* buffer, size_t count)
+{
+  if (!count)
+    return 0;
+  MutexLock lock(lock_);
+  while ((splicing_out_ || (!buffer_.size() && writers_)) && !cancelRequested())
+    not_empty_.wait();
+  if (!buffer_.size() || splicing_out_)
+    return (writers_ || splicing_out_) ? -1 : 0;
+
+  size_t num_read = buffer_.getBulk(buffer, count);
+
+  not_full_.broadcast();
+  poll_queue_->wakeUpAll();
+  return num_read;
+}
+
+size_t Pipe::write(const char* buffer, size_t count)
+{
+  if (!count)
+    return 0;
+  MutexLock lock(lock_);
+  // a small write waits until it fits as a whole, a large one goes in piece by piece
+  size_t needed = (count <= PIPE_ATOMIC_WRITE_SIZE) ? count : 1;
+  size_t written = 0;
+  while (written < count)
+  {
+    while (readers_ && (buffer_.freeSpace() < needed || splicing_in_) && !cancelRequested())
+      not_full_.wait();
+    if (!readers_ || buffer_.freeSpace() < needed || splicing_in_)
+      break;
+
+    written += buffer_.putBulk(buffer + written, count - written);
+
+    not_empty_.broadcast();
+    poll_queue_->wakeUpAll();
+  }
+  return written ? written : -1;
+}
+
+size_t Pipe::spliceFrom(OpenFile* file, size_t count)
+{
+  if (!count)
+    return 0;
+  lock_.acquire();
+  while (readers_ && (!buffer_.freeSpace() || splicing_in_) && !cancelRequested())
+    not_full_.wait();
+  if (!readers_ || !buffer_.freeSpace() || splicing_in_)
+  {
+    lock_.release();
+    return -1;
+  }
+
+  // the free space belongs to this thread until it is produced, so the file is read without the lock,
+  // if the free space wraps around the file is read in two pieces
+  splicing_in_ = true;
+  size_t spliced = 0;
+  ssize_t num_read = 0;
+  char* span;
+  size_t span_size;
+  while (spliced < count && (span_size = buffer_.writeSpan(span)))
+  {
+    span_size = ustl::min(span_size, count - spliced);
+    lock_.release();
+    num_read = (ssize_t) file->read(span, span_size);
+    lock_.acquire();
+    if (num_read < 0)
+      break;
+    buffer_.produce(num_read);
+    spliced += num_read;
+    if ((size_t) num_read < span_size)
+      break;
+  }
+  splicing_in_ = false;
+
+  not_empty_.broadcast();
+  not_full_.broadcast();
+  poll_queue_->wakeUpAll();
+  lock_.release();
+  return (num_read < 0 && !spliced) ? -1 : spliced;
+}
+
+size_t Pipe::spliceTo(OpenFile* file, size_t count)
+{
+  if (!count)
+    return 0;
+  lock_.acquire();
+  while ((splicing_out_ || (!buffer_.size() && writers_)) && !cancelRequested())
+    not_empty_.wait();
+  if (!buffer_.size() || splicing_out_)
+  {
+    lock_.release();
+    return (writers_ || splicing_out_) ? -1 : 0;
+  }
+
+  // the data belongs to this thread until it is consumed, so the file is written without the lock
+  splicing_out_ = true;
+  size_t spliced = 0;
+  ssize_t num_written = 0;
+  const char* span;
+  size_t span_size;
+  while (spliced < count && (span_size = buffer_.readSpan(span)))
+  {
+    span_size = ustl::min(span_size, count - spliced);
+    lock_.release();
+    num_written = (ssize_t) file->write(span, span_size);
+    lock_.acquire();
+    if (num_written < 0)
+      break;
+    buffer_.consume(num_written);
+    spliced += num_written;
+    if ((size_t) num_written < span_size)
+      break;
+  }
+  splicing_out_ = false;
+
+  not_empty_.broadcast();
+  not_full_.broadcast();
+  poll_queue_->wakeUpAll();
+  lock_.release();
+  return (num_written < 0 && !spliced) ? -1 : spliced;
+}
+
+uint32 Pipe::poll(End end, PollEntry* entry)
+{
+  MutexLock lock(lock_);
+  if (entry)
+    poll_queue_->add(entry);
+  if (end == READ_END)
+    return (buffer_.size() && !splicing_out_ ? POLLIN : 0) | (!writers_ ? POLLIN | POLLHUP : 0);
+  // like a write of PIPE_ATOMIC_WRITE_SIZE bytes, writable means it does not block
+  return (buffer_.freeSpace() >= PIPE_ATOMIC_WRITE_SIZE && !splicing_in_ ? POLLOUT : 0) | (!readers_ ? POLLERR : 0);
+}
+
+void Pipe::wakeUpAll()
+{
+  MutexLock lock(lock_);
+  not_empty_.broadcast();
+  not_full_.broadcast();
+  poll_queue_->wakeUpAll();
+}
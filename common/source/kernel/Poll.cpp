@@ -0,0 +1,88 @@
+#include "Poll.h"
+#include "UserThread.h"
+#include "Scheduler.h"
+#include "MutexLock.h"
+#include "ArchInterrupts.h"
+#include "ArchThreads.h"
+#include "assert.h"
+
+PollWaitQueue::PollWaitQueue(const char* name) :
+  lock_(name), entries_(), num_entries_(0)
+{
+}
+
+void PollWaitQueue::add(PollEntry* entry)
+{
+  assert(!entry->queue_);
+  MutexLock lock(lock_);
+  entry->queue_ = this;
+  entries_.push_back(entry);
+  __atomic_store_n(&num_entries_, entries_.size(), __ATOMIC_SEQ_CST);
+}
+
+void PollWaitQueue::remove(PollEntry* entry)
+{
+  assert(entry->queue_ == this);
+  MutexLock lock(lock_);
+  entries_.remove(entry);
+  entry->queue_ = 0;
+  __atomic_store_n(&num_entries_, entries_.size(), __ATOMIC_SEQ_CST);
+}
+
+void PollWaitQueue::wakeUpAll()
+{
+  // the state change of the caller happened before, a poller registering now sees it anyway
+  if (!__atomic_load_n(&num_entries_, __ATOMIC_SEQ_CST))
+    return;
+  MutexLock lock(lock_);
+  for (PollEntry* entry : entries_)
+    entry->poller_->wakeUp();
+}
+
+Poller::Poller() :
+  thread_(currentThread), woken_(0), sleeping_(0)
+{
+  assert(thread_->getType() == Thread::USER_THREAD);
+}
+
+void Poller::arm()
+{
+  __atomic_store_n(&woken_, 0, __ATOMIC_SEQ_CST);
+}
+
+void Poller::sleep(uint64 deadline)
+{
+  assert(currentThread == thread_);
+  UserThread* thread = (UserThread*)thread_;
+
+  // wakeUp runs with interrupts disabled, so nobody can wake us in between
+  ArchInterrupts::disableInterrupts();
+  if (!__atomic_load_n(&woken_, __ATOMIC_SEQ_CST))
+  {
+    sleeping_ = 1;
+    // the scheduler ends the sleep once the wakeup time elapsed
+    thread->setWakeUpTime(deadline);
+    thread->setState(Sleeping);
+  }
+  ArchInterrupts::enableInterrupts();
+  Scheduler::instance()->yield();
+
+  ArchInterrupts::disableInterrupts();
+  sleeping_ = 0;
+  thread->resetWakeUp();
+  ArchInterrupts::enableInterrupts();
+}
+
+void Poller::wakeUp()
+{
+  __atomic_store_n(&woken_, 1, __ATOMIC_SEQ_CST);
+  bool interrupts = ArchInterrupts::disableInterrupts();
+  if (ArchThreads::testSetLock(sleeping_, 0))
+  {
+    // otherwise the scheduler keeps the thread off the cpu until the deadline
+    ((UserThread*)thread_)->resetWakeUp();
+    thread_->setState(Running);
+  }
+  if (interrupts)
+    ArchInterrupts::enableInterrupts();
+}
@@ -12,9 +12,12 @@ ProcessRegistry::ProcessRegistry(FileSystemInfo *root_fs_info, char const *progs
     Thread(root_fs_info, "ProcessRegistry", Thread::KERNEL_THREAD), waitpid_map_lock_("ProcessRegistry::waitpid_map_lock_"),
     any_process_died_(&waitpid_map_lock_, "ProcessRegistry::any_process_died"), progs_(progs), progs_running_(0),
     counter_lock_("ProcessRegistry::counter_lock_"), all_processes_killed_(&counter_lock_, "ProcessRegistry::all_processes_killed_"),
-    pid_counter_(0), last_dead_pid_(0), pid_counter_lock_("pid_counter_lock"), process_list_lock_("process_list_lock")
+    pid_allocator_(PROCESS_REGISTRY_MAX_PIDS), last_dead_pid_(0), pid_allocator_lock_("ProcessRegistry::pid_allocator_lock_"),
+    process_list_(PROCESS_REGISTRY_MAX_PIDS), process_list_lock_("process_list_lock")
 {
   instance_ = this; // instance_ is static! -> Singleton-like behaviour
+  // the fd tables of all processes share one lock class, its critical sections are a few lookups
+  Mutex::setSpinLimit(PROCESS_FDS_LOCK_NAME, MUTEX_SHORT_SECTION_SPIN_YIELDS);
 //  pid_list_ = new ustl::vector<size_t>;
 //  pid_list_lock_ = new Mutex("pid_list_lock");
 }
@@ -71,6 +74,10 @@ void ProcessRegistry::processExit(size_t pid)
 {
   eraseFromProcessList(pid);
 
+  pid_allocator_lock_.acquire();
+  pid_allocator_.free(pid);
+  pid_allocator_lock_.release();
+
   counter_lock_.acquire();
 
   if (--progs_running_ == 0)
@@ -110,9 +117,10 @@ void ProcessRegistry::createProcess(const char* path)
 }
 
 size_t ProcessRegistry::getNewPID() {
-  pid_counter_lock_.acquire();
-  size_t temp = pid_counter_++;
-  pid_counter_lock_.release();
+  pid_allocator_lock_.acquire();
+  size_t temp = pid_allocator_.alloc();
+  pid_allocator_lock_.release();
+  assert(temp != -1U && "ProcessRegistry::getNewPID: out of pids");
   return temp;
 }
 
@@ -136,34 +144,21 @@ UserProcess* ProcessRegistry::createProcessOnFork() {
 }
 
 void ProcessRegistry::insertIntoProcessList(UserProcess *proc) {
-  process_list_lock_.acquire();
-  process_list_[proc->getPid()] = proc;
-  process_list_lock_.release();
+  process_list_lock_.acquireWrite();
+  process_list_.set(proc->getPid(), proc);
+  process_list_lock_.releaseWrite();
 }
 
 void ProcessRegistry::eraseFromProcessList(size_t pid) {
-  process_list_lock_.acquire();
-  if(pidInProcessList(pid)) {
-    process_list_.erase(pid);
-  }
-  process_list_lock_.release();
-}
-
-bool ProcessRegistry::pidInProcessList(size_t pid) {
-  if(process_list_.find(pid) == process_list_.end())
-    return false;
-
-  return true;
+  process_list_lock_.acquireWrite();
+  process_list_.set(pid, nullptr);
+  process_list_lock_.releaseWrite();
 }
 
 UserProcess *ProcessRegistry::getUserProcessFromPid(size_t pid) {
-  UserProcess* temp = nullptr;
-
-  process_list_lock_.acquire();
-  if(pidInProcessList(pid)) {
-    temp = process_list_[pid];
-  }
-  process_list_lock_.release();
+  process_list_lock_.acquireRead();
+  UserProcess* temp = process_list_.get(pid);
+  process_list_lock_.releaseRead();
 
   return temp;
 }
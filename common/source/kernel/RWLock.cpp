@@ -0,0 +1,236 @@
+#include "RWLock.h"
+#include "kprintf.h"
+#include "ArchThreads.h"
+#include "Scheduler.h"
+#include "Thread.h"
+#include "backtrace.h"
+#include "assert.h"
+
+RWLock::RWLock(const char* name) :
+  Lock::Lock(name), readers_(0), writers_waiting_(0), waiters_(0), reader_threads_(), untracked_readers_(0)
+{
+}
+
+void RWLock::acquireRead(pointer called_by)
+{
+  if(unlikely(system_state != RUNNING))
+    return;
+  if(!called_by)
+    called_by = getCalledBefore(1);
+
+  // check for deadlocks (a writer reading its own lock), interrupts...
+  doChecksBeforeWaiting(called_by);
+  if(unlikely(isTrackedReader(currentThread)))
+  {
+    debug(LOCK, "Deadlock: RWLock %s (%p) is already read by currentThread %s (%p), "
+          "a waiting writer would block the second read forever.\n",
+          getName(), this, currentThread->getName(), currentThread);
+    printStatus();
+    assert(false);
+  }
+
+  uint64 wait_start = 0;
+  lockWaitersList();
+  while(held_by_ || writers_waiting_)
+  {
+    if(!wait_start)
+      wait_start = profileStart();
+    waitForRelease();
+  }
+  ++readers_;
+  trackReader();
+  unlockWaitersList();
+
+  profileWait(called_by, wait_start);
+  last_accessed_at_ = called_by;
+}
+
+void RWLock::releaseRead(pointer called_by)
+{
+  if(unlikely(system_state != RUNNING))
+    return;
+  if(!called_by)
+    called_by = getCalledBefore(1);
+
+  lockWaitersList();
+  if(unlikely(readers_ == 0))
+  {
+    unlockWaitersList();
+    debug(LOCK, "RWLock::releaseRead: RWLock %s (%p) is not read by anybody, currentThread is %s (%p)\n",
+          getName(), this, currentThread->getName(), currentThread);
+    printStatus();
+    assert(false);
+  }
+  untrackReader();
+  last_accessed_at_ = called_by;
+  bool wake = (--readers_ == 0) && waiters_;
+  unlockWaitersList();
+  // only a writer can be waiting for the last reader
+  if(wake)
+    wakeWaiters();
+}
+
+void RWLock::acquireWrite(pointer called_by)
+{
+  if(unlikely(system_state != RUNNING))
+    return;
+  if(!called_by)
+    called_by = getCalledBefore(1);
+
+  // check for deadlocks, interrupts...
+  doChecksBeforeWaiting(called_by);
+  if(unlikely(isTrackedReader(currentThread)))
+  {
+    debug(LOCK, "Deadlock: currentThread %s (%p) wants to write RWLock %s (%p) while reading it.\n",
+          currentThread->getName(), currentThread, getName(), this);
+    printReaders();
+    assert(false);
+  }
+
+  uint64 wait_start = 0;
+  lockWaitersList();
+  if(held_by_ || readers_)
+  {
+    wait_start = profileStart();
+    // from now on no new reader gets in
+    ++writers_waiting_;
+    while(held_by_ || readers_)
+      waitForRelease();
+    --writers_waiting_;
+  }
+  assert(held_by_ == 0);
+  held_by_ = currentThread;
+  unlockWaitersList();
+
+  pushFrontToCurrentThreadHoldingList();
+  profileAcquired(called_by, wait_start);
+  last_accessed_at_ = called_by;
+}
+
+void RWLock::releaseWrite(pointer called_by)
+{
+  if(unlikely(system_state != RUNNING))
+    return;
+  if(!called_by)
+    called_by = getCalledBefore(1);
+
+  checkInvalidRelease("RWLock::releaseWrite");
+  profileReleased();
+  removeFromCurrentThreadHoldingList();
+  last_accessed_at_ = called_by;
+  lockWaitersList();
+  held_by_ = 0;
+  bool wake = waiters_;
+  unlockWaitersList();
+  if(wake)
+    wakeWaiters();
+}
+
+void RWLock::waitForRelease()
+{
+  checkCurrentThreadStillWaitingOnAnotherLock();
+  ++waiters_;
+  sleepAndRelease();
+  // We have been waken up again.
+  currentThread->lock_waiting_on_ = 0;
+  lockWaitersList();
+}
+
+void RWLock::wakeWaiters()
+{
+  // Threads that have to wait again are pushed to the front of the list while we pop from
+  // the back, so waking up exactly the number of threads waiting now cannot loop forever.
+  lockWaitersList();
+  size_t count = waiters_;
+  unlockWaitersList();
+  for(size_t i = 0; i < count; ++i)
+  {
+    lockWaitersList();
+    Thread* thread_to_be_woken_up = popBackThreadFromWaitersList();
+    if(thread_to_be_woken_up)
+      --waiters_;
+    unlockWaitersList();
+    if(!thread_to_be_woken_up)
+      break;
+    Scheduler::instance()->wake(thread_to_be_woken_up);
+  }
+}
+
+bool RWLock::isTrackedReader(Thread* thread) const
+{
+  for(size_t i = 0; i < RWLOCK_TRACKED_READERS; ++i)
+  {
+    if(reader_threads_[i] == thread)
+      return true;
+  }
+  return false;
+}
+
+void RWLock::trackReader()
+{
+  assert(waitersListIsLocked());
+  for(size_t i = 0; i < RWLOCK_TRACKED_READERS; ++i)
+  {
+    if(!reader_threads_[i])
+    {
+      reader_threads_[i] = currentThread;
+      return;
+    }
+  }
+  ++untracked_readers_;
+}
+
+void RWLock::untrackReader()
+{
+  assert(waitersListIsLocked());
+  for(size_t i = 0; i < RWLOCK_TRACKED_READERS; ++i)
+  {
+    if(reader_threads_[i] == currentThread)
+    {
+      reader_threads_[i] = 0;
+      return;
+    }
+  }
+  if(unlikely(untracked_readers_ == 0))
+  {
+    debug(LOCK, "RWLock::releaseRead: RWLock %s (%p) is not read by currentThread %s (%p)!\n",
+          getName(), this, currentThread->getName(), currentThread);
+    printReaders();
+    assert(false);
+  }
+  --untracked_readers_;
+}
+
+void RWLock::printReaders()
+{
+  debug(LOCK, "RWLock %s (%p) is read by %zu threads:", getName(), this, readers_);
+  for(size_t i = 0; i < RWLOCK_TRACKED_READERS; ++i)
+  {
+    Thread* thread = reader_threads_[i];
+    if(thread)
+      kprintfd(" %s (%p)", thread->getName(), thread);
+  }
+  kprintfd(untracked_readers_ ? " and %zu more.\n" : ".\n", untracked_readers_);
+}
+
+ReadLock::ReadLock(RWLock &lock) :
+  lock_(lock)
+{
+  lock_.acquireRead(getCalledBefore(1));
+}
+
+ReadLock::~ReadLock()
+{
+  lock_.releaseRead(getCalledBefore(1));
+}
+
+WriteLock::WriteLock(RWLock &lock) :
+  lock_(lock)
+{
+  lock_.acquireWrite(getCalledBefore(1));
+}
+
+WriteLock::~WriteLock()
+{
+  lock_.releaseWrite(getCalledBefore(1));
+}
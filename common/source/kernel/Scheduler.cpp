@@ -13,12 +13,28 @@
 #include "umap.h"
 #include "ustring.h"
 #include "Lock.h"
+#include "Clocksource.h"
+#include "Vdso.h"
 
 ArchThreadRegisters *currentThreadRegisters;
 Thread *currentThread;
 
 Scheduler *Scheduler::instance_ = 0;
 
+// load weight per nice level (-20 .. 19), every level is ~1.25 times the next one,
+// so one nice level makes a difference of ~10% cpu time between two busy threads
+static const uint32 sched_nice_to_weight[SCHED_NICE_MAX - SCHED_NICE_MIN + 1] =
+{
+  88761, 71755, 56483, 46273, 36291,
+  29154, 23254, 18705, 14949, 11916,
+   9548,  7620,  6100,  4904,  3906,
+   3121,  2501,  1991,  1586,  1277,
+   1024,   820,   655,   526,   423,
+    335,   272,   215,   172,   137,
+    110,    87,    70,    56,    45,
+     36,    29,    23,    18,    15,
+};
+
 Scheduler *Scheduler::instance()
 {
   if (unlikely(!instance_))
@@ -29,15 +45,13 @@ Scheduler *Scheduler::instance()
 Scheduler::Scheduler()
 {
   block_scheduling_ = 0;
+  need_resched_ = false;
   ticks_ = 0;
-  clocks_per_interrupt_ = 0;
-  old_clocks_per_interrupt_ = 0;
-  prev_time_ = 0;
-  calibrated_ = false;
   uthread_start_ = 0;
   uthread_end_ = 0;
-  calibr_ticks_ = 0;
-
+  min_vruntime_ = 0;
+  slice_start_ = 0;
+  dead_threads_ = 0;
 
   addNewThread(&cleanup_thread_);
   addNewThread(&idle_thread_);
@@ -52,56 +66,41 @@ uint32 Scheduler::schedule()
     return 0;
   }
 
-  auto it = threads_.begin();
-  for(; it != threads_.end(); ++it)
-  {
-    if((*it)->getType() == Thread::USER_THREAD)
-    {
-      UserThread* userThread = reinterpret_cast<UserThread*>((*it));
-      if(userThread->getWakeUpTime() != 0 && userThread->getWakeUpTime() > getCurrentTime())
-      {
-        continue;
-      } 
-      if(/*userThread->getState() == Sleeping && */ userThread->getWakeUpTime() != 0 && userThread->getWakeUpTime() <= getCurrentTime())
-      {
-        userThread->resetWakeUp();
-        //userThread->setState(Running);
-      }
-    }
+  size_t now = getCurrentTime();
+  if (currentThread != NULL)
+    chargeCurrentThread(now);
 
-    if((*it)->schedulable())
-    {
-      if(currentThread != NULL && currentThread->getType() == Thread::USER_THREAD)
-      {
-        auto* userThread = reinterpret_cast<UserThread*>(currentThread);
-        uthread_end_ = uthread_start_ == 0 ? 0 : getCurrentTime();
-        //debug(USERPROCESS, "ADD TO ACCUMULATOR of PID %ld caused by thread %s: %ld - %ld = %ld\n", userThread->getParentProc()->getPid(), userThread->getName(), uthread_end_, uthread_start_, uthread_end_ - uthread_start_);
-        userThread->getParentProc()->incAccTime(uthread_end_ - uthread_start_); 
-      }
-
-      currentThread = *it;
-      //Check if the user thread should be cancelled at this point
-      if(currentThread->getType() == Thread::USER_THREAD)
-      {
-        uthread_start_ = getCurrentTime();
-        auto* thread = static_cast<UserThread*>(currentThread);
-
-        //We have to be in userspace to perform this, to not leak any resources
-        if(thread->shouldCancel() && thread->switch_to_userspace_ == 1)
-        {
-          debug(SCHEDULER, "T[%ld] CANCELLATION OF THREAD happening in schedule()\n", thread->getTID());
-          thread->setCancelled();
-          thread->prepareCancellation();
-        }
-      }
+  need_resched_ = false;
+  Thread* next = (SCHEDULING_POLICY == SCHED_FAIR) ? pickNextFair() : pickNextRoundRobin();
 
-      break;
-    }
+  assert(next && "No schedulable thread found");
+
+  if(currentThread != NULL && currentThread->getType() == Thread::USER_THREAD)
+  {
+    auto* userThread = reinterpret_cast<UserThread*>(currentThread);
+    uthread_end_ = uthread_start_ == 0 ? 0 : now;
+    //debug(USERPROCESS, "ADD TO ACCUMULATOR of PID %ld caused by thread %s: %ld - %ld = %ld\n", userThread->getParentProc()->getPid(), userThread->getName(), uthread_end_, uthread_start_, uthread_end_ - uthread_start_);
+    userThread->getParentProc()->incAccTime(uthread_end_ - uthread_start_);
+    userThread->getParentProc()->updateVdsoCpuTime(0);
   }
 
-  assert(it != threads_.end() && "No schedulable thread found");
+  currentThread = next;
+  slice_start_ = now;
+  //Check if the user thread should be cancelled at this point
+  if(currentThread->getType() == Thread::USER_THREAD)
+  {
+    uthread_start_ = now;
+    auto* thread = static_cast<UserThread*>(currentThread);
+    thread->getParentProc()->updateVdsoCpuTime(now);
 
-  ustl::rotate(threads_.begin(), it + 1, threads_.end()); // no new/delete here - important because interrupts are disabled
+    //We have to be in userspace to perform this, to not leak any resources
+    if(thread->shouldCancel() && thread->switch_to_userspace_ == 1)
+    {
+      debug(SCHEDULER, "T[%ld] CANCELLATION OF THREAD happening in schedule()\n", thread->getTID());
+      thread->setCancelled();
+      thread->prepareCancellation();
+    }
+  }
 
   //debug(SCHEDULER, "Scheduler::schedule: new currentThread is %p %s, switch_to_userspace: %d\n", currentThread, currentThread->getName(), currentThread->switch_to_userspace_);
 
@@ -120,6 +119,219 @@ uint32 Scheduler::schedule()
   return ret;
 }
 
+uint32 Scheduler::preempt()
+{
+  assert(!ArchInterrupts::testIFSet() && "Tried to schedule with Interrupts enabled");
+  if (block_scheduling_ != 0 ||
+      (currentThread && currentThread->preempt_count_ && !currentThread->switch_to_userspace_ && currentThread->schedulable()))
+  {
+    need_resched_ = true;
+    return 0;
+  }
+  return schedule();
+}
+
+void Scheduler::preemptDisable()
+{
+  if (currentThread)
+    ++currentThread->preempt_count_;
+}
+
+void Scheduler::preemptEnable()
+{
+  if (!currentThread)
+    return;
+  assert(currentThread->preempt_count_ > 0 && "preemptEnable without preemptDisable");
+  if (--currentThread->preempt_count_ == 0)
+    condResched();
+}
+
+void Scheduler::condResched()
+{
+  if (need_resched_ && currentThread && currentThread->preempt_count_ == 0 &&
+      ArchInterrupts::testIFSet() && isSchedulingEnabled())
+    yield();
+}
+
+bool Scheduler::isRunnable(Thread *thread)
+{
+  if(thread->getType() == Thread::USER_THREAD)
+  {
+    UserThread* userThread = reinterpret_cast<UserThread*>(thread);
+    if(userThread->getWakeUpTime() != 0 && userThread->getWakeUpTime() > getCurrentTime())
+    {
+      return false;
+    }
+    if(/*userThread->getState() == Sleeping && */ userThread->getWakeUpTime() != 0 && userThread->getWakeUpTime() <= getCurrentTime())
+    {
+      userThread->resetWakeUp();
+      // the timeout of a sleep with a timeout elapsed (see UserThread::setWakeUpTime)
+      if(userThread->getState() == Sleeping)
+        userThread->setState(Running);
+    }
+  }
+  return thread->schedulable();
+}
+
+Thread* Scheduler::pickNextRoundRobin()
+{
+  auto it = threads_.begin();
+  for(; it != threads_.end(); ++it)
+  {
+    if(isRunnable(*it))
+      break;
+  }
+
+  if(it == threads_.end())
+    return NULL;
+
+  Thread* next = *it;
+  ustl::rotate(threads_.begin(), it + 1, threads_.end()); // no new/delete here - important because interrupts are disabled
+  return next;
+}
+
+Thread* Scheduler::pickNextFair()
+{
+  Thread* best = NULL;
+  if (!fair_queue_.empty())
+    fairQueueFindMin(0, best);
+
+  if (best == NULL)
+    return isRunnable(&idle_thread_) ? &idle_thread_ : NULL;
+
+  // a thread that slept for a long time must not monopolize the cpu until it has caught up,
+  // it gets at most one tick worth of credit compared to the threads which kept running
+  size_t credit = Clocksource::instance()->getTickCycles();
+  if (best->vruntime_ + credit < min_vruntime_)
+  {
+    best->vruntime_ = min_vruntime_ - credit;
+    fairQueueSiftDown(best->sched_queue_index_);
+  }
+  if (best->vruntime_ > min_vruntime_)
+    min_vruntime_ = best->vruntime_;
+
+  return best;
+}
+
+void Scheduler::fairQueueFindMin(size_t index, Thread *&best)
+{
+  // every node is <= its children, so a subtree can be skipped as soon as its root is not
+  // better than the best runnable thread found so far. Sleeping threads stay in the heap,
+  // their subtrees are searched instead. Recursion depth is the heap height.
+  if (index >= fair_queue_.size())
+    return;
+  Thread* thread = fair_queue_[index];
+  if (best != NULL && thread->vruntime_ >= best->vruntime_)
+    return;
+  if (isRunnable(thread))
+  {
+    best = thread;
+    return;
+  }
+  fairQueueFindMin(2 * index + 1, best);
+  fairQueueFindMin(2 * index + 2, best);
+}
+
+void Scheduler::chargeCurrentThread(size_t now)
+{
+  if (currentThread->sched_queue_index_ < 0 || slice_start_ == 0 || now <= slice_start_)
+    return;
+
+  uint64 delta = ((uint64)(now - slice_start_) * SCHED_NICE_0_WEIGHT) /
+                 sched_nice_to_weight[currentThread->nice_ - SCHED_NICE_MIN];
+#if SCHED_FAIR_GROUPS
+  // threads blocked in read, futex or sleep do not count, they do not compete for the slice.
+  // The current thread competed during the slice, even if it just went to sleep.
+  if (currentThread->getType() == Thread::USER_THREAD)
+  {
+    size_t runnable = reinterpret_cast<UserThread*>(currentThread)->getParentProc()->getRunnableThreadCount();
+    if (currentThread->getState() != Running)
+      ++runnable;
+    delta *= runnable;
+  }
+#endif
+  currentThread->vruntime_ += delta;
+  fairQueueSiftDown(currentThread->sched_queue_index_);
+}
+
+void Scheduler::fairQueueSwap(size_t a, size_t b)
+{
+  Thread* tmp = fair_queue_[a];
+  fair_queue_[a] = fair_queue_[b];
+  fair_queue_[b] = tmp;
+  fair_queue_[a]->sched_queue_index_ = a;
+  fair_queue_[b]->sched_queue_index_ = b;
+}
+
+void Scheduler::fairQueueSiftUp(size_t index)
+{
+  while (index > 0)
+  {
+    size_t parent = (index - 1) / 2;
+    if (fair_queue_[parent]->vruntime_ <= fair_queue_[index]->vruntime_)
+      break;
+    fairQueueSwap(parent, index);
+    index = parent;
+  }
+}
+
+void Scheduler::fairQueueSiftDown(size_t index)
+{
+  size_t size = fair_queue_.size();
+  while (true)
+  {
+    size_t smallest = index;
+    size_t left = 2 * index + 1;
+    size_t right = left + 1;
+    if (left < size && fair_queue_[left]->vruntime_ < fair_queue_[smallest]->vruntime_)
+      smallest = left;
+    if (right < size && fair_queue_[right]->vruntime_ < fair_queue_[smallest]->vruntime_)
+      smallest = right;
+    if (smallest == index)
+      break;
+    fairQueueSwap(index, smallest);
+    index = smallest;
+  }
+}
+
+void Scheduler::fairQueueInsert(Thread *thread)
+{
+  assert(thread->sched_queue_index_ < 0);
+  // new threads start at the current minimum, so they neither starve nor get starved
+  thread->vruntime_ = min_vruntime_;
+  thread->sched_queue_index_ = fair_queue_.size();
+  fair_queue_.push_back(thread);
+  fairQueueSiftUp(thread->sched_queue_index_);
+}
+
+void Scheduler::fairQueueRemove(Thread *thread)
+{
+  if (thread->sched_queue_index_ < 0)
+    return;
+  size_t index = thread->sched_queue_index_;
+  size_t last = fair_queue_.size() - 1;
+  if (index != last)
+    fairQueueSwap(index, last);
+  fair_queue_.pop_back(); // no realloc on shrinking
+  thread->sched_queue_index_ = -1;
+  if (index < fair_queue_.size())
+  {
+    fairQueueSiftUp(index);
+    fairQueueSiftDown(fair_queue_[index]->sched_queue_index_);
+  }
+}
+
+int32 Scheduler::setNice(Thread *thread, int32 nice)
+{
+  if (nice < SCHED_NICE_MIN)
+    nice = SCHED_NICE_MIN;
+  if (nice > SCHED_NICE_MAX)
+    nice = SCHED_NICE_MAX;
+  thread->nice_ = nice; // only read by chargeCurrentThread, a torn update is impossible for an int32
+  debug(SCHEDULER, "setNice: %zd:%s now has nice level %d\n", thread->getTID(), thread->getName(), nice);
+  return nice;
+}
+
 void Scheduler::addNewThread(Thread *thread)
 {
   assert(thread);
@@ -130,6 +342,8 @@ void Scheduler::addNewThread(Thread *thread)
   lockScheduling();
   KernelMemoryManager::instance()->getKMMLock().release();
   threads_.push_back(thread);
+  if (thread != &idle_thread_)
+    fairQueueInsert(thread); // the idle thread only runs if nothing else is runnable
   unlockScheduling();
 }
 
@@ -164,46 +378,51 @@ void Scheduler::yield()
   ArchThreads::yield();
 }
 
-void Scheduler::cleanupDeadThreads()
+void Scheduler::addDeadThread(Thread *thread)
+{
+  Thread* head = __atomic_load_n(&dead_threads_, __ATOMIC_RELAXED);
+  do
+  {
+    thread->next_dead_thread_ = head;
+  } while (!__atomic_compare_exchange_n(&dead_threads_, &head, thread, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+  cleanup_thread_.wakeUp();
+}
+
+bool Scheduler::hasDeadThreads()
+{
+  return __atomic_load_n(&dead_threads_, __ATOMIC_ACQUIRE) != 0;
+}
+
+bool Scheduler::cleanupDeadThreads()
 {
   /* Before adding new functionality to this function, consider if that
      functionality could be implemented more cleanly in another place.
      (e.g. Thread/Process destructor) */
-//  debug(SCHEDULER, "starting cleanup\n");
-//  debug(SCHEDULER, "ToBeDestroyed: %d\n", ThreadState::ToBeDestroyed);
-//  debug(SCHEDULER, "Running: %d\n", ThreadState::Running);
-//  debug(SCHEDULER, "Sleeping: %d\n", ThreadState::Sleeping);
-//  debug(SCHEDULER, "Terminated: %d\n", ThreadState::Terminated);
+  Thread* dead = __atomic_exchange_n(&dead_threads_, (Thread*)0, __ATOMIC_ACQUIRE);
+  if (!dead)
+    return false;
 
+  // the whole batch leaves the scheduler at once, the dead threads cannot run anymore
   lockScheduling();
-  uint32 thread_count_max = threads_.size();
-  if (thread_count_max > 1024)
-    thread_count_max = 1024;
-  Thread* destroy_list[thread_count_max];
-  uint32 thread_count = 0;
-  for (uint32 i = 0; i < threads_.size(); ++i)
+  for (Thread* thread = dead; thread; thread = thread->next_dead_thread_)
   {
-    Thread* tmp = threads_[i];
-    if (tmp->getState() == ToBeDestroyed)
-    {
-      destroy_list[thread_count++] = tmp;
-      threads_.erase(threads_.begin() + i); // Note: erase will not realloc!
-      --i;
-    }
-    if (thread_count >= thread_count_max)
-      break;
+    ThreadList::iterator it = ustl::find(threads_.begin(), threads_.end(), thread);
+    assert(it != threads_.end() && "Dead thread was never added to the scheduler");
+    threads_.erase(it); // Note: erase will not realloc!
+    fairQueueRemove(thread);
   }
   unlockScheduling();
-  if (thread_count > 0)
+
+  size_t thread_count = 0;
+  while (dead)
   {
-    for (uint32 i = 0; i < thread_count; ++i)
-    {
-//      if(destroy_list[i]->getType() == Thread::USER_THREAD &&
-//        ((UserThread*)destroy_list[i])->getP)
-      delete destroy_list[i];
-    }
-    debug(SCHEDULER, "cleanupDeadThreads: done\n");
+    Thread* thread = dead;
+    dead = thread->next_dead_thread_;
+    delete thread;
+    ++thread_count;
   }
+  debug(SCHEDULER, "cleanupDeadThreads: done, %zu threads destroyed\n", thread_count);
+  return true;
 }
 
 void Scheduler::printThreadList()
@@ -211,8 +430,9 @@ void Scheduler::printThreadList()
   lockScheduling();
   debug(SCHEDULER, "Scheduler::printThreadList: %zd Threads in List\n", threads_.size());
   for (size_t c = 0; c < threads_.size(); ++c)
-    debug(SCHEDULER, "Scheduler::printThreadList: threads_[%zd]: %p  %zd:%s     [%s]\n", c, threads_[c],
-          threads_[c]->getTID(), threads_[c]->getName(), Thread::threadStatePrintable[threads_[c]->state_]);
+    debug(SCHEDULER, "Scheduler::printThreadList: threads_[%zd]: %p  %zd:%s     [%s] nice %d vruntime %zd\n", c,
+          threads_[c], threads_[c]->getTID(), threads_[c]->getName(), Thread::threadStatePrintable[threads_[c]->state_],
+          threads_[c]->nice_, threads_[c]->vruntime_);
   unlockScheduling();
 }
 
@@ -247,30 +467,8 @@ uint32 Scheduler::getTicks()
 
 void Scheduler::incTicks()
 {
-  if(ticks_ % CALIBRATION_FREQUENCY == 0)
-  {
-    calibrated_ = false;
-    calibr_ticks_ = 0;
-    prev_time_ = 0;
-    old_clocks_per_interrupt_ = clocks_per_interrupt_;
-    clocks_per_interrupt_ = 0;
-    //debug(SCHEDULER, "Scheduler::::::::::::::::::::::::::::::::TICKS %ld\n",ticks_);
-  }
-  if(calibr_ticks_ < CALIBRATION_INTERRUPTS && !calibrated_)
-  {
-    size_t time = getCurrentTime();
-    clocks_per_interrupt_ += prev_time_ == 0 ? 0 : (time - prev_time_);
-    prev_time_ = time;
-    calibr_ticks_++;
-  }
-  if(calibr_ticks_ == CALIBRATION_INTERRUPTS && !calibrated_)
-  {
-    clocks_per_interrupt_ /= (CALIBRATION_INTERRUPTS - 1);
-    calibrated_ = true;
-    //debug(SCHEDULER, "Scheduler::::::::::::::::::::::::::::AVG_TICKS %ld | %ld\n",ticks_, clocks_per_interrupt_);
-  } 
-
   ++ticks_;
+  Vdso::instance()->tick(ticks_, getCurrentTime());
 }
 
 void Scheduler::printStackTraces()
@@ -312,41 +510,14 @@ void Scheduler::printLockingInformation()
             thread->lock_waiting_on_ ->getName(), thread->lock_waiting_on_ );
     }
   }
+  Lock::printStatistics();
   debug(LOCK, "Scheduler::printLockingInformation finished\n");
   unlockScheduling();
 }
 
 size_t Scheduler::getCurrentTime()
 {
-  size_t temp0 = 0;
-  asm volatile ("rdtsc;"
-              "shl  $32, %%rdx;"
-              "or %%rdx, %%rax"
-              : "=a" (temp0)
-              :
-              : "rdx","rcx");
-  return temp0;
-}
-
-size_t Scheduler::getCurrentAVGClocksPerInterrupt()
-{
-  if(calibrated_)
-  {
-    return clocks_per_interrupt_;
-  } 
-  else if(!calibrated_ && old_clocks_per_interrupt_ == 0) //first ticks
-  {
-    return clocks_per_interrupt_/ticks_;
-  }
-  else
-  {
-    return old_clocks_per_interrupt_;
-  }
-}
-
-bool Scheduler::getCalibrated()
-{
-  return calibrated_;
+  return Clocksource::instance()->getCycles();
 }
 
 size_t Scheduler::getUThreadStartTime()
@@ -32,15 +32,18 @@ bool SpinLock::acquireNonBlocking(pointer called_by)
   // There may be some cases where the pre-checks may not be wished here.
   // But these cases are usually dirty implemented, and it would not be necessary to call this method there.
   // So in case you see this comment, re-think your implementation and don't just comment out this line!
-  doChecksBeforeWaiting();
+  doChecksBeforeWaiting(called_by);
 
+  Scheduler::instance()->preemptDisable();
   if(ArchThreads::testSetLock(lock_, 1))
   {
     // The spinlock is held by another thread at the moment
+    Scheduler::instance()->preemptEnable();
     return false;
   }
   // The spinlock is now held by the current thread.
   assert(held_by_ == 0);
+  profileAcquired(called_by, 0);
   last_accessed_at_ = called_by;
   held_by_ = currentThread;
   pushFrontToCurrentThreadHoldingList();
@@ -60,11 +63,16 @@ void SpinLock::acquire(pointer called_by)
 //    debug(LOCK, "The acquire is called by: ");
 //    kernel_debug_info->printCallInformation(called_by);
 //  }
+  // check for deadlocks and the lock order, interrupts...
+  doChecksBeforeWaiting(called_by);
+
+  // the holder must not be preempted by the tick, everybody else would spin until it runs again
+  Scheduler::instance()->preemptDisable();
+  uint64 wait_start = 0;
   if(ArchThreads::testSetLock(lock_, 1))
   {
-    // We did not directly managed to acquire the spinlock, need to check for deadlocks and
-    // to push the current thread to the waiters list.
-    doChecksBeforeWaiting();
+    wait_start = profileStart();
+    // We did not directly managed to acquire the spinlock, need to push the current thread to the waiters list.
 
     currentThread->lock_waiting_on_ = this;
     lockWaitersList();
@@ -84,6 +92,7 @@ void SpinLock::acquire(pointer called_by)
     currentThread->lock_waiting_on_ = 0;
   }
   // The current thread is now holding the spinlock
+  profileAcquired(called_by, wait_start);
   last_accessed_at_ = called_by;
   held_by_ = currentThread;
   pushFrontToCurrentThreadHoldingList();
@@ -113,9 +122,11 @@ void SpinLock::release(pointer called_by)
 //    kernel_debug_info->printCallInformation(called_by);
 //  }
   checkInvalidRelease("SpinLock::release");
+  profileReleased();
   removeFromCurrentThreadHoldingList();
   last_accessed_at_ = called_by;
   held_by_ = 0;
   lock_ = 0;
+  Scheduler::instance()->preemptEnable();
 }
 
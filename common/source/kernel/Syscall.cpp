@@ -10,12 +10,19 @@
 #include "ProcessRegistry.h"
 #include "File.h"
 #include "UThreadManager.h"
+#include "Clocksource.h"
+#include "Futex.h"
+#include "OpenFile.h"
+#include "Poll.h"
+#include "splice-definitions.h"
+#include "io-ring-definitions.h"
+#include "termios-definitions.h"
 
 size_t Syscall::syscallException(size_t syscall_number, size_t arg1, size_t arg2, size_t arg3, size_t arg4, size_t arg5)
 {
   size_t return_value = 0;
 
-  if ((syscall_number != sc_sched_yield) && (syscall_number != sc_outline)) // no debug print because these might occur very often
+  if ((syscall_number != sc_sched_yield) && (syscall_number != sc_outline) && (syscall_number != sc_futex)) // no debug print because these might occur very often
   {
     debug(SYSCALL, "Syscall %zd called with arguments %zd(=%zx) %zd(=%zx) %zd(=%zx) %zd(=%zx) %zd(=%zx)\n",
           syscall_number, arg1, arg1, arg2, arg2, arg3, arg3, arg4, arg4, arg5, arg5);
@@ -44,6 +51,18 @@ size_t Syscall::syscallException(size_t syscall_number, size_t arg1, size_t arg2
     case sc_close:
       return_value = close(arg1);
       break;
+    case sc_lseek:
+      return_value = lseek(arg1, arg2, arg3);
+      break;
+    case sc_dup:
+      return_value = dup(arg1);
+      break;
+    case sc_dup2:
+      return_value = dup2(arg1, arg2);
+      break;
+    case sc_fsync:
+      return_value = fsync(arg1);
+      break;
     case sc_outline:
       outline(arg1, arg2);
       break;
@@ -86,6 +105,69 @@ size_t Syscall::syscallException(size_t syscall_number, size_t arg1, size_t arg2
     case sc_pipe:
       return_value = pipe(arg1, arg2);
       break;
+    case sc_nice:
+      return_value = nice(arg1);
+      break;
+    case sc_clock_gettime:
+      return_value = clock_gettime(arg1, arg2);
+      break;
+    case sc_nanosleep:
+      return_value = nanosleep(arg1, arg2);
+      break;
+    case sc_getpid:
+      return_value = getpid();
+      break;
+    case sc_futex:
+      return_value = futex(arg1, arg2, arg3, arg4, arg5);
+      break;
+    case sc_poll:
+      return_value = poll(arg1, arg2, arg3);
+      break;
+    case sc_splice:
+      return_value = splice(arg1, arg2, arg3, arg4);
+      break;
+    case sc_vmsplice:
+      return_value = vmsplice(arg1, arg2, arg3, arg4);
+      break;
+    case sc_socket:
+      return_value = socket(arg1, arg2, arg3);
+      break;
+    case sc_bind:
+      return_value = bind(arg1, arg2);
+      break;
+    case sc_listen:
+      return_value = listen(arg1, arg2);
+      break;
+    case sc_accept:
+      return_value = accept(arg1);
+      break;
+    case sc_connect:
+      return_value = connect(arg1, arg2);
+      break;
+    case sc_send:
+      return_value = send(arg1, arg2, arg3, arg4);
+      break;
+    case sc_recv:
+      return_value = recv(arg1, arg2, arg3, arg4);
+      break;
+    case sc_io_ring_enter:
+      return_value = io_ring_enter(arg1, arg2);
+      break;
+    case sc_sendfile:
+      return_value = sendfile(arg1, arg2, arg3, arg4);
+      break;
+    case sc_copy_file_range:
+      return_value = copy_file_range(arg1, arg2, arg3, arg4, arg5);
+      break;
+    case sc_tcgetattr:
+      return_value = tcgetattr(arg1, arg2);
+      break;
+    case sc_tcsetattr:
+      return_value = tcsetattr(arg1, arg2, arg3);
+      break;
+    case sc_ioctl:
+      return_value = ioctl(arg1, arg2, arg3);
+      break;
     case sc_execv:
       return_value = Syscall::execv(arg1, arg2);
       break;
@@ -109,24 +191,13 @@ size_t Syscall::write(size_t fd, pointer buffer, size_t size)
     return -1U;
   }
 
-  size_t num_written = 0;
-
-  if (fd == fd_stdout) //stdout
-  {
-    debug(SYSCALL, "Syscall::write: %.*s\n", (int)size, (char*) buffer);
-    kprintf("%.*s", (int)size, (char*) buffer);
-    num_written = size;
-  }
-  else if (((UserThread*)currentThread)->getParentProc()->isPipe(fd))
-  {
-    num_written = ((UserThread*)currentThread)->getParentProc()->writeToPipe(fd, buffer, size);
-  }
-  else
+  OpenFile* file = ((UserThread*)currentThread)->getParentProc()->getFD(fd);
+  if (!file)
   {
-    auto proc = ((UserThread*)currentThread)->getParentProc();
-    size_t global_fd = proc->getGlobalFD(fd);
-    num_written = (global_fd == -1U) ? -1 : VfsSyscall::write(global_fd, (char*) buffer, size);
+    return -1;
   }
+  size_t num_written = file->write((const char*) buffer, size);
+  file->unref();
   return num_written;
 }
 
@@ -137,43 +208,55 @@ size_t Syscall::read(size_t fd, pointer buffer, size_t count)
     return -1U;
   }
 
-  size_t num_read = 0;
-
-  if (fd == fd_stdin)
-  {
-    //this doesn't! terminate a string with \0, gotta do that yourself
-    num_read = currentThread->getTerminal()->readLine((char*) buffer, count);
-    debug(SYSCALL, "Syscall::read: %.*s\n", (int)num_read, (char*) buffer);
-  }
-  else if (((UserThread*)currentThread)->getParentProc()->isPipe(fd))
-  {
-    num_read = ((UserThread*)currentThread)->getParentProc()->readFromPipe(fd, buffer, count);
-  }
-  else
+  OpenFile* file = ((UserThread*)currentThread)->getParentProc()->getFD(fd);
+  if (!file)
   {
-    auto proc = ((UserThread*)currentThread)->getParentProc();
-    size_t global_fd = proc->getGlobalFD(fd);
-    //debug(SYSCALL, "Syscall::READ___________________________________________________ %ld\n", global_fd);
-    num_read = (global_fd == -1U) ? -1 : VfsSyscall::read(global_fd, (char*) buffer, count);
+    return -1;
   }
+  size_t num_read = file->read((char*) buffer, count);
+  file->unref();
   return num_read;
 }
 
-size_t Syscall::close(size_t fd)
+size_t Syscall::lseek(size_t fd, size_t offset, size_t origin)
 {
-  auto proc = ((UserThread*)currentThread)->getParentProc();
-  size_t global_fd = proc->getGlobalFD(fd);
-  if (proc->isPipe(fd))
+  OpenFile* file = ((UserThread*)currentThread)->getParentProc()->getFD(fd);
+  if (!file)
   {
-    proc->removeLocalFD(fd);
-    return 0;
+    return -1;
   }
-  int32 retval = (global_fd == -1U) ? -1 : VfsSyscall::close(global_fd);
-  if(retval != -1)
+  l_off_t new_offset = file->lseek((l_off_t) offset, (uint8) origin);
+  file->unref();
+  return new_offset;
+}
+
+size_t Syscall::close(size_t fd)
+{
+  return ((UserThread*)currentThread)->getParentProc()->closeFD(fd) == 0 ? 0 : -1;
+}
+
+size_t Syscall::dup(size_t fd)
+{
+  size_t new_fd = ((UserThread*)currentThread)->getParentProc()->dupFD(fd);
+  return new_fd == -1U ? -1 : new_fd;
+}
+
+size_t Syscall::dup2(size_t old_fd, size_t new_fd)
+{
+  size_t fd = ((UserThread*)currentThread)->getParentProc()->dup2FD(old_fd, new_fd);
+  return fd == -1U ? -1 : fd;
+}
+
+size_t Syscall::fsync(size_t fd)
+{
+  OpenFile* file = ((UserThread*)currentThread)->getParentProc()->getFD(fd);
+  if (!file)
   {
-    proc->removeLocalFD(fd);
+    return -1;
   }
-  return retval;
+  size_t result = file->fsync();
+  file->unref();
+  return result;
 }
 
 size_t Syscall::open(size_t path, size_t flags)
@@ -183,9 +266,14 @@ size_t Syscall::open(size_t path, size_t flags)
     return -1U;
   }
   auto proc = ((UserThread*)currentThread)->getParentProc();
-  int32 fd = VfsSyscall::open((char*) path, flags);
-  debug(SYSCALL, "Syscall::open[%ld]: %d\n", proc->getPid(), fd);
-  return proc->addLocalFD(fd);
+  int32 global_fd = VfsSyscall::open((char*) path, flags);
+  if (global_fd == -1)
+  {
+    return -1;
+  }
+  size_t fd = proc->addFD(new VfsOpenFile(VfsSyscall::getFileDescriptor(global_fd)));
+  debug(SYSCALL, "Syscall::open[%ld]: %zd\n", proc->getPid(), fd);
+  return fd == -1U ? -1 : fd;
 }
 
 void Syscall::outline(size_t port, pointer text)
@@ -211,14 +299,13 @@ size_t Syscall::createprocess(size_t path, size_t sleep)
   {
     return -1U;
   }
-  auto proc = ((UserThread*)currentThread)->getParentProc();
   debug(SYSCALL, "Syscall::createprocess: path:%s sleep:%zd\n", (char*) path, sleep);
-  ssize_t fd = proc->addLocalFD(VfsSyscall::open((const char*) path, O_RDONLY));
+  ssize_t fd = VfsSyscall::open((const char*) path, O_RDONLY);
   if (fd == -1)
   {
     return -1U;
   }
-  VfsSyscall::close(proc->getGlobalFD(fd));
+  VfsSyscall::close(fd);
 
   // parameter check end
 
@@ -260,31 +347,634 @@ size_t Syscall::fork()
 size_t Syscall::clock()
 {
   assert((currentThread->getType() == Thread::USER_THREAD) && "Conversion to UThread will fail");
-  auto sc = Scheduler::instance();
-  auto uprocess = reinterpret_cast<UserThread*>(currentThread)->getParentProc();
-  //uint64_t acc = uprocess->getAccTime() + (sc->getCurrentTime() - sc->getUThreadStartTime());
-  //uint64_t div = (acc * 549254);
-  //uint64_t by = (sc->getCurrentAVGClocksPerInterrupt() * 10);
-  //size_t ret = div/by;
-  //debug(SYSCALL, "Syscall::clock: FOR %ld : %s\n", uprocess->getPid(), currentThread->getName());
-  //debug(SYSCALL, "Syscall::clock: acc: %ld\n", acc);
-  //debug(SYSCALL, "Syscall::clock: %ld / %ld = %ld\n", div, by, ret);
-  // 54.9254ms per interrupt
-  return ((uprocess->getAccTime() + (sc->getCurrentTime() - sc->getUThreadStartTime())) * 549254) / (sc->getCurrentAVGClocksPerInterrupt() * 10);
+  // CLOCKS_PER_SEC is 1000000 in userspace, so a clock is one microsecond
+  return processCpuTimeNs() / NS_PER_USEC;
 }
 
 size_t Syscall::sleep(size_t seconds)
 {
   assert((currentThread->getType() == Thread::USER_THREAD) && "Conversion to UThread will fail");
-  auto sc = Scheduler::instance();
-  //18.2065 Hz, i.e. interrupts per second
-  uint64_t rdtsc_wakeup_increment = ((uint64_t)182065 * seconds * sc->getCurrentAVGClocksPerInterrupt()) / 10000 + sc->getCurrentTime();
-  debug(SYSCALL, "Syscall::sleep: TID %ld will sleep from now: %ld until  %ld\n", currentThread->getTID(), sc->getCurrentTime(), rdtsc_wakeup_increment);
-  reinterpret_cast<UserThread*>(currentThread)->sleepUntil(rdtsc_wakeup_increment);
+  debug(SYSCALL, "Syscall::sleep: TID %ld will sleep for %zd seconds\n", currentThread->getTID(), seconds);
+  sleepNs(seconds * NS_PER_SEC);
   return 0;
   // 0 if elapsed
 }
 
+size_t Syscall::clock_gettime(size_t clock_id, pointer time_spec)
+{
+  if (time_spec >= USER_BREAK || time_spec + sizeof(kernel_timespec) > USER_BREAK)
+  {
+    return -1U;
+  }
+
+  uint64 ns;
+  switch (clock_id)
+  {
+    case CLOCK_MONOTONIC:
+      ns = Clocksource::instance()->getMonotonicNs();
+      break;
+    case CLOCK_PROCESS_CPUTIME_ID:
+      ns = processCpuTimeNs();
+      break;
+    default:
+      return -1U;
+  }
+
+  kernel_timespec* ts = (kernel_timespec*) time_spec;
+  ts->tv_sec = ns / NS_PER_SEC;
+  ts->tv_nsec = ns % NS_PER_SEC;
+  return 0;
+}
+
+size_t Syscall::nanosleep(pointer request, pointer remain)
+{
+  if (request == 0 || request >= USER_BREAK || request + sizeof(kernel_timespec) > USER_BREAK ||
+      remain >= USER_BREAK || remain + sizeof(kernel_timespec) > USER_BREAK)
+  {
+    return -1U;
+  }
+
+  kernel_timespec req = *(kernel_timespec*) request;
+  if (req.tv_sec < 0 || req.tv_nsec < 0 || req.tv_nsec >= (int64)NS_PER_SEC)
+  {
+    return -1U;
+  }
+
+  sleepNs(req.tv_sec * NS_PER_SEC + req.tv_nsec);
+
+  // there are no signals, so the sleep is never interrupted
+  if (remain)
+  {
+    ((kernel_timespec*) remain)->tv_sec = 0;
+    ((kernel_timespec*) remain)->tv_nsec = 0;
+  }
+  return 0;
+}
+
+size_t Syscall::getpid()
+{
+  // the libc reads the pid from the vdso page, this is the fallback
+  return ((UserThread*)currentThread)->getParentProc()->getPid();
+}
+
+size_t Syscall::futex(size_t address, size_t op, size_t value, size_t address2, size_t value2)
+{
+  switch (op)
+  {
+    case FUTEX_WAIT:
+      return Futex::instance()->wait((uint32*)address, value);
+    case FUTEX_WAKE:
+      return Futex::instance()->wake((uint32*)address, value);
+    case FUTEX_REQUEUE:
+      return Futex::instance()->requeue((uint32*)address, value, (uint32*)address2, value2);
+    default:
+      return -1U;
+  }
+}
+
+size_t Syscall::poll(pointer fds, size_t nfds, size_t timeout_ms)
+{
+  if (nfds > PROCESS_MAX_FDS || fds >= USER_BREAK || fds + nfds * sizeof(pollfd) > USER_BREAK)
+  {
+    return -1;
+  }
+  pollfd* user_fds = (pollfd*) fds;
+  UserProcess* process = ((UserThread*)currentThread)->getParentProc();
+
+  // timeout < 0 waits forever, 0 only checks once
+  int timeout = (int) timeout_ms;
+  uint64 deadline = 0;
+  if (timeout > 0)
+    deadline = Clocksource::instance()->getCycles() + Clocksource::instance()->nsToCycles(timeout * 1000000ULL);
+
+  Poller poller;
+  OpenFile** files = new OpenFile*[nfds];
+  PollEntry* entries = new PollEntry[nfds];
+  for (size_t i = 0; i < nfds; ++i)
+  {
+    files[i] = (user_fds[i].fd >= 0) ? process->getFD(user_fds[i].fd) : 0;
+    entries[i] = {&poller, 0};
+  }
+
+  size_t num_ready = 0;
+  for (bool first_pass = true;; first_pass = false)
+  {
+    // a wakeup while checking makes the sleep below return right away
+    poller.arm();
+    num_ready = 0;
+    for (size_t i = 0; i < nfds; ++i)
+    {
+      short revents = 0;
+      if (files[i])
+        revents = files[i]->poll(first_pass ? &entries[i] : 0) & (user_fds[i].events | POLLERR | POLLHUP);
+      else if (user_fds[i].fd >= 0)
+        revents = POLLNVAL;
+      user_fds[i].revents = revents;
+      if (revents)
+        ++num_ready;
+    }
+    if (num_ready || !timeout || ((UserThread*)currentThread)->shouldCancel() ||
+        (deadline && Clocksource::instance()->getCycles() >= deadline))
+      break;
+    poller.sleep(deadline);
+  }
+
+  for (size_t i = 0; i < nfds; ++i)
+  {
+    if (entries[i].queue_)
+      entries[i].queue_->remove(&entries[i]);
+    if (files[i])
+      files[i]->unref();
+  }
+  delete[] entries;
+  delete[] files;
+  debug(SYSCALL, "Syscall::poll: %zu of %zu fds ready\n", num_ready, nfds);
+  return num_ready;
+}
+
+size_t Syscall::splice(size_t fd_in, size_t fd_out, size_t count, size_t flags)
+{
+  UserProcess* process = ((UserThread*)currentThread)->getParentProc();
+  OpenFile* in = process->getFD(fd_in);
+  OpenFile* out = process->getFD(fd_out);
+  size_t spliced = -1;
+  // exactly one side has to be a pipe. The other side is accessed with the pipe locked, so it must not block:
+  // only vfs files are spliced into a pipe, and a pipe is only spliced to a vfs file or the terminal.
+  // A socket could wait for its peer, which may wait for the pipe.
+  if (in && out && ((in->getType() == OpenFile::PIPE_END) != (out->getType() == OpenFile::PIPE_END)))
+  {
+    if (in->getType() == OpenFile::PIPE_END && ((PipeOpenFile*)in)->getEnd() == Pipe::READ_END &&
+        (out->getType() == OpenFile::VFS_FILE || out->getType() == OpenFile::TERMINAL))
+      spliced = ((PipeOpenFile*)in)->getPipe()->spliceTo(out, count);
+    else if (out->getType() == OpenFile::PIPE_END && ((PipeOpenFile*)out)->getEnd() == Pipe::WRITE_END &&
+             in->getType() == OpenFile::VFS_FILE)
+      spliced = ((PipeOpenFile*)out)->getPipe()->spliceFrom(in, count);
+  }
+  if (in)
+    in->unref();
+  if (out)
+    out->unref();
+  debug(SYSCALL, "Syscall::splice: %zd bytes from fd %zu to fd %zu, flags %zx\n", spliced, fd_in, fd_out, flags);
+  return spliced;
+}
+
+size_t Syscall::vmsplice(size_t fd, pointer iov, size_t nr_segs, size_t flags)
+{
+  if (nr_segs > UIO_MAXIOV || iov >= USER_BREAK || iov + nr_segs * sizeof(iovec) > USER_BREAK)
+  {
+    return -1;
+  }
+  // the iovecs are copied once, so another thread cannot change them after they are checked
+  iovec* segments = new iovec[nr_segs];
+  memcpy(segments, (const void*) iov, nr_segs * sizeof(iovec));
+  for (size_t i = 0; i < nr_segs; ++i)
+  {
+    pointer base = (pointer) segments[i].iov_base;
+    if (base >= USER_BREAK || segments[i].iov_len > USER_BREAK - base)
+    {
+      delete[] segments;
+      return -1;
+    }
+  }
+
+  OpenFile* file = ((UserThread*)currentThread)->getParentProc()->getFD(fd);
+  if (!file)
+  {
+    delete[] segments;
+    return -1;
+  }
+  size_t written = -1;
+  if (file->getType() == OpenFile::PIPE_END && ((PipeOpenFile*)file)->getEnd() == Pipe::WRITE_END)
+  {
+    // the pages are not gifted, each buffer is copied once into the pipe
+    written = 0;
+    for (size_t i = 0; i < nr_segs; ++i)
+    {
+      size_t num_written = file->write((const char*) segments[i].iov_base, segments[i].iov_len);
+      if ((ssize_t) num_written < 0)
+      {
+        if (!written)
+          written = -1;
+        break;
+      }
+      written += num_written;
+      if (num_written < segments[i].iov_len)
+        break;
+    }
+  }
+  delete[] segments;
+  file->unref();
+  debug(SYSCALL, "Syscall::vmsplice: %zd bytes to fd %zu, flags %zx\n", written, fd, flags);
+  return written;
+}
+
+/**
+ * @return the open socket behind fd with a reference taken, nullptr if fd is not a socket
+ */
+static OpenFile* getSocketFile(size_t fd)
+{
+  OpenFile* file = ((UserThread*)currentThread)->getParentProc()->getFD(fd);
+  if (file && file->getType() != OpenFile::SOCKET)
+  {
+    file->unref();
+    return 0;
+  }
+  return file;
+}
+
+/**
+ * copies the \0 terminated socket name from user space
+ * @return false if it is not terminated within UNIX_PATH_MAX bytes
+ */
+static bool copySocketName(pointer path, ustl::string& name)
+{
+  for (size_t i = 0; i < UNIX_PATH_MAX && path + i < USER_BREAK; ++i)
+  {
+    if (!((const char*) path)[i])
+    {
+      name.assign((const char*) path, i);
+      return true;
+    }
+  }
+  return false;
+}
+
+size_t Syscall::socket(size_t domain, size_t type, size_t protocol)
+{
+  if (domain != AF_UNIX || (type != SOCK_STREAM && type != SOCK_DGRAM) || protocol)
+  {
+    return -1;
+  }
+  UnixSocket* socket = new UnixSocket((UnixSocket::Type) type);
+  size_t fd = ((UserThread*)currentThread)->getParentProc()->addFD(new SocketOpenFile(socket));
+  return fd == -1U ? -1 : fd;
+}
+
+size_t Syscall::bind(size_t fd, pointer path)
+{
+  ustl::string name;
+  if (!copySocketName(path, name))
+  {
+    return -1;
+  }
+  OpenFile* file = getSocketFile(fd);
+  if (!file)
+  {
+    return -1;
+  }
+  size_t result = ((SocketOpenFile*)file)->getSocket()->bind(name);
+  file->unref();
+  return result;
+}
+
+size_t Syscall::listen(size_t fd, size_t backlog)
+{
+  OpenFile* file = getSocketFile(fd);
+  if (!file)
+  {
+    return -1;
+  }
+  size_t result = ((SocketOpenFile*)file)->getSocket()->listen(backlog);
+  file->unref();
+  return result;
+}
+
+size_t Syscall::accept(size_t fd)
+{
+  OpenFile* file = getSocketFile(fd);
+  if (!file)
+  {
+    return -1;
+  }
+  UnixSocket* socket = ((SocketOpenFile*)file)->getSocket()->accept();
+  file->unref();
+  if (!socket)
+  {
+    return -1;
+  }
+  size_t new_fd = ((UserThread*)currentThread)->getParentProc()->addFD(new SocketOpenFile(socket));
+  return new_fd == -1U ? -1 : new_fd;
+}
+
+size_t Syscall::connect(size_t fd, pointer path)
+{
+  ustl::string name;
+  if (!copySocketName(path, name))
+  {
+    return -1;
+  }
+  OpenFile* file = getSocketFile(fd);
+  if (!file)
+  {
+    return -1;
+  }
+  size_t result = ((SocketOpenFile*)file)->getSocket()->connect(name);
+  file->unref();
+  return result;
+}
+
+size_t Syscall::send(size_t fd, pointer buffer, size_t count, size_t /*flags*/)
+{
+  if ((buffer >= USER_BREAK) || (buffer + count > USER_BREAK))
+  {
+    return -1;
+  }
+  OpenFile* file = getSocketFile(fd);
+  if (!file)
+  {
+    return -1;
+  }
+  size_t num_sent = ((SocketOpenFile*)file)->getSocket()->send((const char*) buffer, count);
+  file->unref();
+  return num_sent;
+}
+
+size_t Syscall::recv(size_t fd, pointer buffer, size_t count, size_t /*flags*/)
+{
+  if ((buffer >= USER_BREAK) || (buffer + count > USER_BREAK))
+  {
+    return -1;
+  }
+  OpenFile* file = getSocketFile(fd);
+  if (!file)
+  {
+    return -1;
+  }
+  size_t num_received = ((SocketOpenFile*)file)->getSocket()->recv((char*) buffer, count);
+  file->unref();
+  return num_received;
+}
+
+size_t Syscall::io_ring_enter(pointer ring, size_t to_submit)
+{
+  if (ring >= USER_BREAK || ring + sizeof(io_ring) > USER_BREAK)
+  {
+    return -1;
+  }
+  io_ring* shared = (io_ring*) ring;
+  uint32 entries = shared->entries;
+  pointer sqes = (pointer) shared->sqes;
+  pointer cqes = (pointer) shared->cqes;
+  if (!entries || entries > IO_RING_MAX_ENTRIES || (entries & (entries - 1)) ||
+      sqes >= USER_BREAK || sqes + entries * sizeof(io_ring_sqe) > USER_BREAK ||
+      cqes >= USER_BREAK || cqes + entries * sizeof(io_ring_cqe) > USER_BREAK)
+  {
+    return -1;
+  }
+
+  // the entries are executed one after the other by the calling thread, a blocking one delays the rest
+  uint32 mask = entries - 1;
+  uint32 sq_head = __atomic_load_n(&shared->sq_head, __ATOMIC_RELAXED);
+  uint32 sq_tail = __atomic_load_n(&shared->sq_tail, __ATOMIC_ACQUIRE);
+  uint32 cq_tail = __atomic_load_n(&shared->cq_tail, __ATOMIC_RELAXED);
+  size_t submitted = 0;
+  while (submitted < to_submit && sq_head != sq_tail &&
+         cq_tail - __atomic_load_n(&shared->cq_head, __ATOMIC_ACQUIRE) < entries &&
+         !((UserThread*)currentThread)->shouldCancel())
+  {
+    // the program may scribble on the entry meanwhile, so work on a copy
+    io_ring_sqe sqe = ((io_ring_sqe*) sqes)[sq_head & mask];
+    size_t result;
+    switch (sqe.opcode)
+    {
+      case IO_RING_OP_NOP:
+        result = 0;
+        break;
+      case IO_RING_OP_READ:
+        result = read(sqe.fd, sqe.addr, sqe.len);
+        break;
+      case IO_RING_OP_WRITE:
+        result = write(sqe.fd, sqe.addr, sqe.len);
+        break;
+      case IO_RING_OP_OPEN:
+        result = open(sqe.addr, sqe.len);
+        break;
+      case IO_RING_OP_CLOSE:
+        result = close(sqe.fd);
+        break;
+      case IO_RING_OP_FSYNC:
+        result = fsync(sqe.fd);
+        break;
+      default:
+        result = -1;
+    }
+
+    io_ring_cqe* cqe = &((io_ring_cqe*) cqes)[cq_tail & mask];
+    cqe->user_data = sqe.user_data;
+    cqe->res = (ssize_t) result;
+    __atomic_store_n(&shared->cq_tail, ++cq_tail, __ATOMIC_RELEASE);
+    __atomic_store_n(&shared->sq_head, ++sq_head, __ATOMIC_RELEASE);
+    ++submitted;
+  }
+  return submitted;
+}
+
+/**
+ * sendfile to a pipe, a socket or the terminal, the file is read into a kernel buffer instead of a user one
+ */
+static size_t sendFileToStream(OpenFile* in, l_off_t* position, OpenFile* out, size_t count)
+{
+  l_off_t saved_offset = 0;
+  if (position)
+  {
+    saved_offset = in->lseek(0, SEEK_CUR);
+    in->lseek(*position, SEEK_SET);
+  }
+
+  char* buffer = new char[ustl::min(count, (size_t) VFS_COPY_CHUNK_SIZE)];
+  size_t sent = 0;
+  while (sent < count)
+  {
+    ssize_t num_read = (ssize_t) in->read(buffer, ustl::min(count - sent, (size_t) VFS_COPY_CHUNK_SIZE));
+    if (num_read <= 0)
+    {
+      if (num_read < 0 && !sent)
+        sent = -1;
+      break;
+    }
+    ssize_t written = (ssize_t) out->write(buffer, num_read);
+    if (written <= 0)
+    {
+      if (!sent)
+        sent = -1;
+      in->lseek(-num_read, SEEK_CUR);
+      break;
+    }
+    sent += written;
+    if (written < num_read)
+    {
+      // what did not fit is sent next time
+      in->lseek(written - num_read, SEEK_CUR);
+      break;
+    }
+  }
+  delete[] buffer;
+
+  if (position)
+  {
+    *position = in->lseek(0, SEEK_CUR);
+    in->lseek(saved_offset, SEEK_SET);
+  }
+  return sent;
+}
+
+size_t Syscall::sendfile(size_t out_fd, size_t in_fd, pointer offset, size_t count)
+{
+  if (offset && (offset >= USER_BREAK || offset + sizeof(l_off_t) > USER_BREAK))
+  {
+    return -1;
+  }
+  UserProcess* process = ((UserThread*)currentThread)->getParentProc();
+  OpenFile* in = process->getFD(in_fd);
+  OpenFile* out = process->getFD(out_fd);
+  size_t sent = -1;
+  if (in && out && in->getType() == OpenFile::VFS_FILE)
+  {
+    l_off_t position = offset ? *(l_off_t*) offset : 0;
+    if (out->getType() == OpenFile::VFS_FILE)
+      sent = VfsSyscall::copyFileRange(((VfsOpenFile*)in)->getDescriptor(), offset ? &position : 0,
+                                       ((VfsOpenFile*)out)->getDescriptor(), 0, ustl::min(count, (size_t) 0x7fffffff));
+    else
+      sent = sendFileToStream(in, offset ? &position : 0, out, count);
+    if (offset && (ssize_t) sent > 0)
+      *(l_off_t*) offset = position;
+  }
+  if (in)
+    in->unref();
+  if (out)
+    out->unref();
+  return sent;
+}
+
+size_t Syscall::copy_file_range(size_t in_fd, pointer in_offset, size_t out_fd, pointer out_offset, size_t count)
+{
+  if ((in_offset && (in_offset >= USER_BREAK || in_offset + sizeof(l_off_t) > USER_BREAK)) ||
+      (out_offset && (out_offset >= USER_BREAK || out_offset + sizeof(l_off_t) > USER_BREAK)))
+  {
+    return -1;
+  }
+  UserProcess* process = ((UserThread*)currentThread)->getParentProc();
+  OpenFile* in = process->getFD(in_fd);
+  OpenFile* out = process->getFD(out_fd);
+  size_t copied = -1;
+  if (in && out && in->getType() == OpenFile::VFS_FILE && out->getType() == OpenFile::VFS_FILE)
+  {
+    l_off_t in_position = in_offset ? *(l_off_t*) in_offset : 0;
+    l_off_t out_position = out_offset ? *(l_off_t*) out_offset : 0;
+    copied = VfsSyscall::copyFileRange(((VfsOpenFile*)in)->getDescriptor(), in_offset ? &in_position : 0,
+                                       ((VfsOpenFile*)out)->getDescriptor(), out_offset ? &out_position : 0,
+                                       ustl::min(count, (size_t) 0x7fffffff));
+    if ((ssize_t) copied > 0)
+    {
+      if (in_offset)
+        *(l_off_t*) in_offset = in_position;
+      if (out_offset)
+        *(l_off_t*) out_offset = out_position;
+    }
+  }
+  if (in)
+    in->unref();
+  if (out)
+    out->unref();
+  return copied;
+}
+
+size_t Syscall::tcgetattr(size_t fd, pointer attributes)
+{
+  if (attributes >= USER_BREAK || attributes + sizeof(termios) > USER_BREAK)
+  {
+    return -1;
+  }
+  OpenFile* file = ((UserThread*)currentThread)->getParentProc()->getFD(fd);
+  if (!file)
+  {
+    return -1;
+  }
+  size_t result = -1;
+  if (file->getType() == OpenFile::TERMINAL)
+  {
+    termios current;
+    currentThread->getTerminal()->getAttributes(current);
+    *(termios*) attributes = current;
+    result = 0;
+  }
+  file->unref();
+  return result;
+}
+
+size_t Syscall::tcsetattr(size_t fd, size_t optional_actions, pointer attributes)
+{
+  if (optional_actions > TCSAFLUSH || attributes >= USER_BREAK || attributes + sizeof(termios) > USER_BREAK)
+  {
+    return -1;
+  }
+  OpenFile* file = ((UserThread*)currentThread)->getParentProc()->getFD(fd);
+  if (!file)
+  {
+    return -1;
+  }
+  size_t result = -1;
+  if (file->getType() == OpenFile::TERMINAL)
+  {
+    // copied before taking the terminal's lock, the user page may fault
+    termios requested = *(termios*) attributes;
+    Terminal* terminal = currentThread->getTerminal();
+    if (optional_actions == TCSAFLUSH)
+      terminal->clearBuffer();
+    terminal->setAttributes(requested);
+    result = 0;
+  }
+  file->unref();
+  return result;
+}
+
+size_t Syscall::ioctl(size_t fd, size_t request, pointer arg)
+{
+  if (request != TIOCSTI || arg >= USER_BREAK)
+  {
+    return -1;
+  }
+  OpenFile* file = ((UserThread*)currentThread)->getParentProc()->getFD(fd);
+  if (!file)
+  {
+    return -1;
+  }
+  size_t result = -1;
+  if (file->getType() == OpenFile::TERMINAL)
+  {
+    char key = *(char*) arg;
+    currentThread->getTerminal()->putInBuffer(&key, 1);
+    result = 0;
+  }
+  file->unref();
+  return result;
+}
+
+uint64 Syscall::processCpuTimeNs()
+{
+  auto sc = Scheduler::instance();
+  auto uprocess = reinterpret_cast<UserThread*>(currentThread)->getParentProc();
+  return Clocksource::instance()->cyclesToNs(uprocess->getAccTime() + (sc->getCurrentTime() - sc->getUThreadStartTime()));
+}
+
+void Syscall::sleepNs(uint64 ns)
+{
+  auto clock = Clocksource::instance();
+  uint64 deadline = clock->getCycles() + clock->nsToCycles(ns);
+
+  // the scheduler checks wakeup times whenever it picks a thread, at the latest on the next timer tick.
+  // Sleeping lets the cpu idle and is not charged as runtime, only a short remainder is polled by yielding.
+  uint64 spin_cycles = clock->nsToCycles(SLEEP_SPIN_NS);
+  uint64 now;
+  while ((now = clock->getCycles()) < deadline)
+  {
+    if (deadline - now > spin_cycles)
+      reinterpret_cast<UserThread*>(currentThread)->sleepUntil(deadline);
+    else
+      Scheduler::instance()->yield();
+  }
+}
+
 size_t Syscall::waitpid(size_t pid, size_t status, size_t options)
 {
   if (status >= USER_BREAK || pid == 0 || (int)pid < -1 || pid == ((UserThread*)currentThread)->getParentProc()->getPid())
@@ -327,6 +1017,12 @@ size_t Syscall::pipe(size_t read, size_t write)
   return ((UserThread*)currentThread)->getParentProc()->openPipe(read, write);
 }
 
+size_t Syscall::nice(size_t increment)
+{
+  // applies to the calling thread only, the new level is inherited on fork
+  return Scheduler::instance()->setNice(currentThread, currentThread->getNice() + (int32)increment);
+}
+
 size_t Syscall::execv(pointer path, pointer args)
 {
   debug(SYSCALL, "Restructuring UserThread '%s'\n", currentThread->getName());
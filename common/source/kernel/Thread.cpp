@@ -31,9 +31,11 @@ extern "C" void threadStartHack()
 }
 
 Thread::Thread(FileSystemInfo *working_dir, ustl::string name, Thread::TYPE type) :
-        kernel_registers_(0), user_registers_(0), switch_to_userspace_(type == Thread::USER_THREAD ? 1 : 0), t_loader_(0),
-        next_thread_in_lock_waiters_list_(0), lock_waiting_on_(0), holding_lock_list_(0), state_(Running), type_(type),
-        my_terminal_(0), tid_(0), working_dir_(working_dir), name_(name)
+        kernel_registers_(0), user_registers_(0), switch_to_userspace_(type == Thread::USER_THREAD ? 1 : 0), preempt_count_(0), t_loader_(0),
+        next_thread_in_lock_waiters_list_(0), prev_thread_in_lock_waiters_list_(0), lock_waiting_on_(0),
+        reacquire_after_wait_(false), holding_lock_list_(0), state_(Running), type_(type),
+        my_terminal_(0), vruntime_(0), sched_queue_index_(-1),
+        next_dead_thread_(0), dead_queued_(0), tid_(0), nice_(0), working_dir_(working_dir), name_(name)
 {
   debug(THREAD, "Thread ctor, this is %p, stack is %p, fs_info ptr: %p\n", this, kernel_stack_, working_dir_);
   ArchThreads::createKernelRegisters(kernel_registers_, (void*) (type == Thread::USER_THREAD ? 0 : threadStartHack), getKernelStackStartPointer());
@@ -199,6 +201,16 @@ ThreadState Thread::getState() const
   return state_;
 }
 
+int32 Thread::getNice() const
+{
+  return nice_;
+}
+
+uint64 Thread::getVRuntime() const
+{
+  return vruntime_;
+}
+
 void Thread::setState(ThreadState new_state)
 {
   if(new_state == ThreadState::ToBeDestroyed)
@@ -206,7 +218,12 @@ void Thread::setState(ThreadState new_state)
   assert(!((state_ == ToBeDestroyed) && (new_state != ToBeDestroyed)) && "Tried to change thread state when thread was already set to be destroyed");
   assert(!((new_state == Sleeping) && (currentThread != this)) && "Setting other threads to sleep is not thread-safe");
 
+  ThreadState old_state = state_;
   state_ = new_state;
+  if(type_ == Thread::USER_THREAD && ((old_state == Running) != (new_state == Running)))
+    static_cast<UserThread*>(this)->getParentProc()->runnableThreadsChanged(new_state == Running);
+  if(new_state == ToBeDestroyed && !ArchThreads::testSetLock(dead_queued_, 1))
+    Scheduler::instance()->addDeadThread(this);
 }
 
 
@@ -0,0 +1,392 @@
+#include "UnixSocket.h"
+#include "MutexLock.h"
+#include "UserThread.h"
+#include "kprintf.h"
+#include "assert.h"
+#include <ualgo.h>
+
+static bool cancelRequested()
+{
+  return currentThread->getType() == Thread::USER_THREAD && ((UserThread*)currentThread)->shouldCancel();
+}
+
+UnixConnection::UnixConnection() :
+  poll_queue_("UnixConnection::poll_queue_"), to_acceptor_(UNIX_SOCKET_BUFFER_SIZE, &poll_queue_),
+  to_connector_(UNIX_SOCKET_BUFFER_SIZE, &poll_queue_), refs_(2)
+{
+}
+
+void UnixConnection::ref()
+{
+  __atomic_fetch_add(&refs_, 1, __ATOMIC_RELAXED);
+}
+
+void UnixConnection::unref()
+{
+  if (__atomic_sub_fetch(&refs_, 1, __ATOMIC_ACQ_REL) == 0)
+    delete this;
+}
+
+UnixSocket::UnixSocket(Type type) :
+  type_(type), state_(UNCONNECTED), refs_(1), lock_("UnixSocket::lock_"), changed_(&lock_, "UnixSocket::changed_"),
+  poll_queue_("UnixSocket::poll_queue_"), name_(), pending_(), backlog_(0), connection_(0), rx_(0), tx_(0),
+  messages_(0), peer_(0)
+{
+  if (type_ == DGRAM)
+    messages_ = new RingBuffer<char>(UNIX_SOCKET_BUFFER_SIZE);
+}
+
+UnixSocket::~UnixSocket()
+{
+  assert(!refs_);
+  assert(state_ == CLOSED && "UnixSocket::~UnixSocket: the socket has to be closed first");
+  delete messages_;
+}
+
+void UnixSocket::ref()
+{
+  size_t old_refs = __atomic_fetch_add(&refs_, 1, __ATOMIC_RELAXED);
+  assert(old_refs && "UnixSocket::ref: the socket is already deleted");
+}
+
+void UnixSocket::unref()
+{
+  if (__atomic_sub_fetch(&refs_, 1, __ATOMIC_ACQ_REL) == 0)
+    delete this;
+}
+
+void UnixSocket::close()
+{
+  lock_.acquire();
+  if (state_ == CLOSED)
+  {
+    lock_.release();
+    return;
+  }
+  state_ = CLOSED;
+  ustl::string name;
+  name.swap(name_);
+  ustl::list<UnixSocket*> pending;
+  pending.swap(pending_);
+  UnixSocket* peer = peer_;
+  peer_ = 0;
+  if (connection_)
+    detach();
+  changed_.broadcast();
+  lock_.release();
+  poll_queue_.wakeUpAll();
+
+  if (!name.empty())
+    UnixSocketNames::instance()->remove(name);
+  // connections nobody accepted see the end of file
+  for (UnixSocket* socket : pending)
+  {
+    socket->close();
+    socket->unref();
+  }
+  if (peer)
+    peer->unref();
+}
+
+void UnixSocket::attach(UnixConnection* connection, bool acceptor)
+{
+  connection_ = connection;
+  rx_ = acceptor ? &connection->to_acceptor_ : &connection->to_connector_;
+  tx_ = acceptor ? &connection->to_connector_ : &connection->to_acceptor_;
+  state_ = CONNECTED;
+}
+
+void UnixSocket::detach()
+{
+  rx_->close(Pipe::READ_END);
+  tx_->close(Pipe::WRITE_END);
+  connection_->unref();
+  connection_ = 0;
+  rx_ = 0;
+  tx_ = 0;
+}
+
+UnixConnection* UnixSocket::connection(Pipe*& rx, Pipe*& tx)
+{
+  MutexLock lock(lock_);
+  if (state_ != CONNECTED || !connection_)
+    return 0;
+  connection_->ref();
+  rx = rx_;
+  tx = tx_;
+  return connection_;
+}
+
+size_t UnixSocket::bind(const ustl::string& name)
+{
+  if (name.empty() || name.size() >= UNIX_PATH_MAX)
+    return -1;
+  MutexLock lock(lock_);
+  if (!name_.empty() || state_ == CLOSED || (type_ == STREAM && state_ != UNCONNECTED))
+    return -1;
+  if (!UnixSocketNames::instance()->add(name, this))
+    return -1;
+  name_ = name;
+  return 0;
+}
+
+size_t UnixSocket::listen(size_t backlog)
+{
+  MutexLock lock(lock_);
+  if (type_ != STREAM || name_.empty() || (state_ != UNCONNECTED && state_ != LISTENING))
+    return -1;
+  backlog_ = ustl::max((size_t) 1, ustl::min(backlog, (size_t) SOMAXCONN));
+  state_ = LISTENING;
+  return 0;
+}
+
+bool UnixSocket::enqueue(UnixSocket* socket)
+{
+  MutexLock lock(lock_);
+  if (state_ != LISTENING || pending_.size() >= backlog_)
+    return false;
+  pending_.push_back(socket);
+  changed_.broadcast();
+  poll_queue_.wakeUpAll();
+  return true;
+}
+
+UnixSocket* UnixSocket::accept()
+{
+  MutexLock lock(lock_);
+  while (state_ == LISTENING && pending_.empty() && !cancelRequested())
+    changed_.wait();
+  if (state_ != LISTENING || pending_.empty())
+    return 0;
+  UnixSocket* socket = pending_.front();
+  pending_.pop_front();
+  return socket;
+}
+
+size_t UnixSocket::connect(const ustl::string& name)
+{
+  UnixSocket* target = UnixSocketNames::instance()->lookup(name);
+  if (!target)
+    return -1;
+  if (target == this || target->type_ != type_)
+  {
+    target->unref();
+    return -1;
+  }
+
+  if (type_ == DGRAM)
+  {
+    // the reference to the target moves to peer_
+    lock_.acquire();
+    UnixSocket* old_peer = 0;
+    bool connected = (state_ != CLOSED);
+    if (connected)
+    {
+      old_peer = peer_;
+      peer_ = target;
+      state_ = CONNECTED;
+    }
+    lock_.release();
+    if (old_peer)
+      old_peer->unref();
+    if (!connected)
+      target->unref();
+    return connected ? 0 : -1;
+  }
+
+  MutexLock lock(lock_);
+  size_t result = -1;
+  if (state_ == UNCONNECTED)
+  {
+    // both sockets exist right away, the connector may send before the connection is accepted
+    UnixConnection* connection = new UnixConnection();
+    UnixSocket* acceptor = new UnixSocket(STREAM);
+    acceptor->attach(connection, true);
+    attach(connection, false);
+    if (target->enqueue(acceptor))
+    {
+      result = 0;
+    }
+    else
+    {
+      acceptor->close();
+      acceptor->unref();
+      detach();
+      state_ = UNCONNECTED;
+    }
+  }
+  target->unref();
+  return result;
+}
+
+size_t UnixSocket::send(const char* buffer, size_t count)
+{
+  if (type_ == STREAM)
+  {
+    Pipe* rx;
+    Pipe* tx;
+    UnixConnection* connection = this->connection(rx, tx);
+    if (!connection)
+      return -1;
+    size_t sent = tx->write(buffer, count);
+    connection->unref();
+    return sent;
+  }
+
+  lock_.acquire();
+  UnixSocket* peer = peer_;
+  if (peer)
+    peer->ref();
+  lock_.release();
+  if (!peer)
+    return -1;
+  size_t sent = peer->deliver(buffer, count);
+  peer->unref();
+  return sent;
+}
+
+size_t UnixSocket::deliver(const char* buffer, size_t count)
+{
+  // a message is its length followed by the data, and only goes in as a whole
+  size_t needed = sizeof(count) + count;
+  if (needed > messages_->capacity())
+    return -1;
+  MutexLock lock(lock_);
+  while (state_ != CLOSED && messages_->freeSpace() < needed && !cancelRequested())
+    changed_.wait();
+  if (state_ == CLOSED || messages_->freeSpace() < needed)
+    return -1;
+  messages_->putBulk((const char*) &count, sizeof(count));
+  messages_->putBulk(buffer, count);
+  changed_.broadcast();
+  poll_queue_.wakeUpAll();
+  return count;
+}
+
+size_t UnixSocket::recv(char* buffer, size_t count)
+{
+  if (type_ == STREAM)
+  {
+    Pipe* rx;
+    Pipe* tx;
+    UnixConnection* connection = this->connection(rx, tx);
+    if (!connection)
+      return -1;
+    size_t received = rx->read(buffer, count);
+    connection->unref();
+    return received;
+  }
+
+  MutexLock lock(lock_);
+  while (state_ != CLOSED && !messages_->size() && !cancelRequested())
+    changed_.wait();
+  if (!messages_->size())
+    return -1;
+
+  size_t length;
+  messages_->getBulk((char*) &length, sizeof(length));
+  size_t num_read = messages_->getBulk(buffer, ustl::min(count, length));
+  // the rest of a truncated message is dropped
+  for (size_t rest = length - num_read; rest;)
+  {
+    const char* span;
+    size_t dropped = ustl::min(messages_->readSpan(span), rest);
+    messages_->consume(dropped);
+    rest -= dropped;
+  }
+  changed_.broadcast();
+  poll_queue_.wakeUpAll();
+  return num_read;
+}
+
+uint32 UnixSocket::poll(PollEntry* entry)
+{
+  Pipe* rx;
+  Pipe* tx;
+  UnixConnection* connection = (type_ == STREAM) ? this->connection(rx, tx) : 0;
+  if (connection)
+  {
+    if (entry)
+      connection->poll_queue_.add(entry);
+    uint32 events = rx->poll(Pipe::READ_END, 0) | tx->poll(Pipe::WRITE_END, 0);
+    connection->unref();
+    return events;
+  }
+
+  MutexLock lock(lock_);
+  if (entry)
+    poll_queue_.add(entry);
+  if (state_ == LISTENING)
+    return pending_.empty() ? 0 : POLLIN;
+  if (type_ == DGRAM && state_ != CLOSED)
+    return (messages_->size() ? POLLIN : 0) | POLLOUT;
+  return POLLHUP;
+}
+
+void UnixSocket::wakeUpAll()
+{
+  lock_.acquire();
+  changed_.broadcast();
+  UnixSocket* peer = peer_;
+  if (peer)
+    peer->ref();
+  lock_.release();
+  poll_queue_.wakeUpAll();
+
+  Pipe* rx;
+  Pipe* tx;
+  UnixConnection* connection = (type_ == STREAM) ? this->connection(rx, tx) : 0;
+  if (connection)
+  {
+    rx->wakeUpAll();
+    tx->wakeUpAll();
+    connection->unref();
+  }
+  // a sender waits for space in the buffer of its peer
+  if (peer)
+  {
+    peer->lock_.acquire();
+    peer->changed_.broadcast();
+    peer->lock_.release();
+    peer->unref();
+  }
+}
+
+UnixSocketNames *UnixSocketNames::instance_ = 0;
+
+UnixSocketNames *UnixSocketNames::instance()
+{
+  if (unlikely(!instance_))
+    instance_ = new UnixSocketNames();
+  return instance_;
+}
+
+UnixSocketNames::UnixSocketNames() :
+  lock_("UnixSocketNames::lock_")
+{
+}
+
+bool UnixSocketNames::add(const ustl::string& name, UnixSocket* socket)
+{
+  MutexLock lock(lock_);
+  if (sockets_.find(name) != sockets_.end())
+    return false;
+  sockets_[name] = socket;
+  return true;
+}
+
+void UnixSocketNames::remove(const ustl::string& name)
+{
+  MutexLock lock(lock_);
+  sockets_.erase(name);
+}
+
+UnixSocket* UnixSocketNames::lookup(const ustl::string& name)
+{
+  MutexLock lock(lock_);
+  auto it = sockets_.find(name);
+  if (it == sockets_.end())
+    return 0;
+  it->second->ref();
+  return it->second;
+}
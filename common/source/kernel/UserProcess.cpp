@@ -12,21 +12,29 @@
 #include "offsets.h"
 #include "UThreadManager.h"
 #include "syscall-definitions.h"
-#include "FileDescriptor.h"
+#include "Vdso.h"
+#include "kstring.h"
+#include "Futex.h"
 
 UserProcess::UserProcess(size_t pid, ustl::string filename, FileSystemInfo *fs_info, uint32 terminal_number) :
     pid_(pid),
-    filename_(filename), fs_info_(fs_info), terminal_number_(terminal_number), next_tid_(0),
+    filename_(filename), fs_info_(fs_info), terminal_number_(terminal_number), tid_allocator_(PROCESS_MAX_THREADS),
     thread_list_(), user_stack_list_(), thread_list_lock_("thread_list_lock"), user_stack_list_lock_("user_stack_list_lock"),
-    waiting_list_(), ret_values_(), waiters_lock_("waiters_lock"), called_exit_(false), accumulated_incs_(0), fd_num_(3), fds_lock_("locking local fd"), 
-    pipes_lock_("locking pipes"), tid_list_()
+    waiting_list_(), ret_values_(), waiters_lock_("waiters_lock"), called_exit_(false), accumulated_incs_(0), vdso_ppn_(0), runnable_threads_(0), fd_allocator_(PROCESS_MAX_FDS), fds_(PROCESS_MAX_FDS), fds_lock_(PROCESS_FDS_LOCK_NAME),
+    tid_list_()
 {
   ProcessRegistry::instance()->processStart(this); //should also be called if you fork a process
-  fd_ = addLocalFD(VfsSyscall::open(filename, O_RDONLY));
 
-  if(getGlobalFD(fd_) != -1U) {
-    loader_ = new Loader(getGlobalFD(fd_));
-  }
+  // the table is empty, so these become fd_stdin, fd_stdout and fd_stderr
+  OpenFile* terminal = new TerminalOpenFile();
+  addFD(terminal);
+  terminal->ref();
+  addFD(terminal);
+  terminal->ref();
+  addFD(terminal);
+
+  fd_ = VfsSyscall::open(filename, O_RDONLY);
+  loader_ = (fd_ != -1) ? new Loader(fd_) : nullptr;
 
   if (!loader_ || !loader_->loadExecutableAndInitProcess())
   {
@@ -53,6 +61,8 @@ UserProcess::UserProcess(size_t pid, ustl::string filename, FileSystemInfo *fs_i
   // TODO: free resources in case of error
   debug(USERPROCESS, "Mapping done! args_seg_addr_: %zx\n", args_seg_addr_);
 
+  setupVdsoPage();
+
 
   if(addNewThread(filename, loader_->getEntryFunction(), false) == nullptr)
   {
@@ -64,10 +74,9 @@ UserProcess::UserProcess(size_t pid, ustl::string filename, FileSystemInfo *fs_i
 }
 
 UserProcess::UserProcess(const UserProcess &proc) :
-    fd_(VfsSyscall::open(proc.getFilename(), O_RDONLY)), filename_(proc.getFilename()),
+    fd_(VfsSyscall::open(proc.getFilename(), O_RDONLY)), filename_(proc.getFilename()), tid_allocator_(PROCESS_MAX_THREADS),
     thread_list_(), user_stack_list_(), thread_list_lock_("thread_list_lock"), user_stack_list_lock_("user_stack_list_lock"),
-    waiting_list_(), ret_values_(), waiters_lock_("waiters_lock"), called_exit_(false), accumulated_incs_(0), fds_lock_("locking local fd"),
-    pipes_lock_("locking pipes")
+    waiting_list_(), ret_values_(), waiters_lock_("waiters_lock"), called_exit_(false), accumulated_incs_(0), vdso_ppn_(0), runnable_threads_(0), fd_allocator_(PROCESS_MAX_FDS), fds_(PROCESS_MAX_FDS), fds_lock_(PROCESS_FDS_LOCK_NAME)
 {
   assert((currentThread->getType() == Thread::USER_THREAD) && "can't call fork on a kernelthread");
 
@@ -77,30 +86,20 @@ UserProcess::UserProcess(const UserProcess &proc) :
   // pid has to be set before this function can be called!
   ProcessRegistry::instance()->processStart(this);
   filename_ = proc.getFilename();
-  fd_num_ = proc.getFdNum();
-  fd_ = proc.getOrigLocalFD();
-  ustl::map<int, int> copy_fds = proc.getLocalFDs();
-  for(auto entry : copy_fds)
-  {
-    File* f = new File(*VfsSyscall::getFileDescriptor(entry.second)->getFile());
-    auto copy_fd = new FileDescriptor(f);
-    FileDescriptor::add(copy_fd);
-    fds_[entry.first] = (int)copy_fd->getFd();
-  }
-  ustl::map<ustl::pair<int, int>, RingBuffer<char>*> copy_pipes = proc.getPipes();
-  for(auto entry : copy_pipes)
-  {
-    pipes_[entry.first] = entry.second;
-    entry.second->incProcCount();
-  }
-  /*
-  for(auto x : fds_)
+  // the child shares the parent's open files under the same fd numbers, like after dup
+  proc.fds_lock_.acquire();
+  for(size_t fd = 0; fd < PROCESS_MAX_FDS; ++fd)
   {
-    debug(USERPROCESS, "NEW________________________________________[%ld] %d -> %d\n",pid_, x.first, x.second);
+    OpenFile* file = proc.fds_.get(fd);
+    if(file)
+    {
+      file->ref();
+      fd_allocator_.allocId(fd);
+      fds_.set(fd, file);
+    }
   }
-  */
-  fds_[fd_] = VfsSyscall::open(filename_, O_RDONLY);
-  loader_ = new Loader(getGlobalFD(fd_));
+  proc.fds_lock_.release();
+  loader_ = new Loader(fd_);
   fs_info_ = new FileSystemInfo(*proc.getFsInfo());
 
   if (!loader_ || !loader_->loadExecutableAndInitProcess())
@@ -116,6 +115,7 @@ UserProcess::UserProcess(const UserProcess &proc) :
 
 //  proc.getLoader()->arch_memory_.copyPagesToNewArchMem(loader_->arch_memory_);
   proc.getLoader()->arch_memory_.copyPagesToNewArchMemCOW(loader_->arch_memory_, proc.getPid(), getPid());
+  setupVdsoPage();
 
   auto new_thread = addNewThread("", nullptr, true);
 
@@ -142,19 +142,10 @@ UserProcess::~UserProcess()
 
   assert(Scheduler::instance()->isCurrentlyCleaningUp());
 
-  for(auto fd : fds_)
+  for(size_t fd = 0; fd < PROCESS_MAX_FDS; ++fd)
   {
-    assert(getGlobalFD(fd.first) != -1U && "No mapped global descriptor");
-    VfsSyscall::close(fd.second);
-  }
-  
-  for(auto pipe : pipes_)
-  {
-    pipe.second->decProcCount();
-    if(pipe.second->getProcCount() == 0)
-    {
-      delete(pipe.second);
-    }
+    if(fds_.get(fd))
+      closeFD(fd);
   }
   
   COWManager::instance()->eraseProcessFromCOWMap(this);
@@ -162,10 +153,17 @@ UserProcess::~UserProcess()
     
 
   deleteResources(true);
+  if (fd_ != -1)
+    VfsSyscall::close(fd_);
+
+  // the vdso page is not owned by the address space, so it outlives the loader
+  if (vdso_ppn_)
+    PageManager::instance()->freePPN(vdso_ppn_);
 
   debug(USERPROCESS, "Ending Process with pid: %zu\n", pid_);
-  ProcessRegistry::instance()->processExit(pid_);
+  // the pid is handed out again after processExit
   ProcessRegistry::instance()->removeFromWaitPIDMap(pid_);
+  ProcessRegistry::instance()->processExit(pid_);
 }
 
 
@@ -203,21 +201,45 @@ uint64_t UserProcess::getAccTime() const
   return accumulated_incs_;
 }
 
+void UserProcess::updateVdsoCpuTime(uint64 running_since)
+{
+  if (!vdso_ppn_)
+    return;
+  vdso_process_data* data = Vdso::processData(vdso_ppn_);
+  Vdso::writeBegin(data->seq);
+  data->cpu_cycles = accumulated_incs_;
+  data->running_since = running_since;
+  Vdso::writeEnd(data->seq);
+}
+
+size_t UserProcess::getRunnableThreadCount() const
+{
+  return __atomic_load_n(&runnable_threads_, __ATOMIC_RELAXED);
+}
+
+void UserProcess::runnableThreadsChanged(bool runnable)
+{
+  if (runnable)
+    __atomic_add_fetch(&runnable_threads_, 1, __ATOMIC_RELAXED);
+  else
+    __atomic_sub_fetch(&runnable_threads_, 1, __ATOMIC_RELAXED);
+}
+
 void UserProcess::setTerminal(Terminal *my_term)
 {
   my_terminal_ = my_term;
 }
 
 UserThread* UserProcess::getFirstThread() {
-  acquireThreadsListLock();
+  acquireThreadsListReadLock();
 
   if (checkIfThreadListIsEmpty()) {
-    releaseThreadsListLock();
+    releaseThreadsListReadLock();
     return nullptr;
   }
 
   auto* to_return = thread_list_.begin()->second;
-  releaseThreadsListLock();
+  releaseThreadsListReadLock();
 
   return to_return;
 }
@@ -434,17 +456,17 @@ size_t UserProcess::joinThread(pthread_t caller, pthread_t tid, void** retval)
     return 0;
   }
 
-  acquireThreadsListLock();
+  acquireThreadsListReadLock();
   UserThread* target = nullptr;
   if(!getThread(tid, &target) || target->wasReallyExited())
   {
     debug(JOIN, "[T%ld] The requested TID = %ld is not valid", caller, tid);
-    releaseThreadsListLock();
+    releaseThreadsListReadLock();
     releaseWaitersLock();
 
     return -1ULL;
   }
-  releaseThreadsListLock();
+  releaseThreadsListReadLock();
 
   if (waiting_list_.find(tid) != waiting_list_.end())
   {
@@ -495,23 +517,26 @@ size_t UserProcess::cancelThread(pthread_t id)
 {
   debug(THREAD, "T[%ld] pthread_cancel Request with target = %ld\n", currentThread->getTID(), id);
 
-  acquireThreadsListLock();
+  acquireThreadsListReadLock();
   UserThread *target = nullptr;
   if (!getThread(id, &target))
   {
-    releaseThreadsListLock();
+    releaseThreadsListReadLock();
     return -1ULL;
   }
 
   if(!target->isCancelableState())
   {
-    releaseThreadsListLock();
+    releaseThreadsListReadLock();
     return -2ULL;
   }
 
   debug(THREAD, "Cancellation Request successfully received...\n");
   target->receiveCancelRequest();
-  releaseThreadsListLock();
+  // a thread blocked on a futex or an fd would never reach the cancellation point
+  Futex::instance()->wakeThread(target);
+  wakeUpFDWaiters();
+  releaseThreadsListReadLock();
   return 0;
 }
 
@@ -531,13 +556,9 @@ uint64 UserProcess::getArgsStartAddr()
 }
 
 size_t UserProcess::allocNextFreeTID() {
-  while (isThreadTidInThreadList(next_tid_))
-  {
-    next_tid_++;
-  }
-
-  //increment after returning
-  return next_tid_++;
+  size_t tid = tid_allocator_.alloc();
+  assert(tid != -1U && "UserProcess::allocNextFreeTID: out of tids");
+  return tid;
 }
 
 /**
@@ -563,6 +584,7 @@ size_t UserProcess::allocNextFreeTID() {
 void UserProcess::eraseThreadInformation(size_t tid) {
   if(isThreadTidInThreadList(tid)) {
     thread_list_.erase(tid);
+    tid_allocator_.free(tid);
   }
 
   if(isThreadTidInUserStackList(tid)) {
@@ -596,21 +618,25 @@ UserThread* UserProcess::internalAddNewThread(ustl::string name, void *entry_poi
   }
 
   UserThread* new_thread;
+  size_t tid = allocNextFreeTID();
   if(!on_fork)
   {
-    size_t tid = allocNextFreeTID();
     ustl::string thread_name = name + " - pid: " + ustl::to_string(pid_) + " - tid: " + ustl::to_string(tid);
     new_thread = new UserThread(fs_info_, thread_name, Thread::USER_THREAD, this, tid, entry_point);
   }
   else
   {
-    new_thread = new UserThread((UserThread*)currentThread, this, allocNextFreeTID());
+    new_thread = new UserThread((UserThread*)currentThread, this, tid);
   }
 
   if(new_thread != nullptr)
   {
     thread_list_[new_thread->getTID()] = new_thread;
   }
+  else
+  {
+    tid_allocator_.free(tid);
+  }
 
   return new_thread;
 }
@@ -643,7 +669,7 @@ void UserProcess::kill() {
 
   // aquire all current tid's
   tid_list_.clear();
-  acquireThreadsListLock();
+  acquireThreadsListReadLock();
   for(auto& pair : thread_list_) {
     auto* thread = pair.second;
 
@@ -654,7 +680,7 @@ void UserProcess::kill() {
 
     tid_list_.push_back(thread->getTID());
   }
-  releaseThreadsListLock();
+  releaseThreadsListReadLock();
 
 
   // cancel and join all the threads until there are no more
@@ -695,14 +721,22 @@ void UserProcess::deleteResources(bool delete_loader) {
 
 void UserProcess::acquireThreadsListLock()
 {
-  thread_list_lock_.acquire();
+  thread_list_lock_.acquireWrite();
   //debug(THREAD, "ACQUIRE THREAD LIST LOCK\n");
 }
 void UserProcess::releaseThreadsListLock()
 {
-  thread_list_lock_.release();
+  thread_list_lock_.releaseWrite();
   //debug(THREAD, "RELEASE THREAD LIST LOCK\n");
 }
+void UserProcess::acquireThreadsListReadLock()
+{
+  thread_list_lock_.acquireRead();
+}
+void UserProcess::releaseThreadsListReadLock()
+{
+  thread_list_lock_.releaseRead();
+}
 void UserProcess::acquireWaitersLock()
 {
   waiters_lock_.acquire();
@@ -729,7 +763,7 @@ UserThread* UserProcess::addrIsWithinAnyUserStack(size_t address)
   ustl::map<size_t,UserThread*>::iterator it;
   UserThread* thread_of_given_stack_addr = NULL;
 
-  acquireThreadsListLock();
+  acquireThreadsListReadLock();
   for (it = thread_list_.begin(); it != thread_list_.end(); it++)
   {
     uint64 stack_start_addr = it->second->getUserStackStartAddr();
@@ -741,7 +775,7 @@ UserThread* UserProcess::addrIsWithinAnyUserStack(size_t address)
       break;
     }
   }
-  releaseThreadsListLock();
+  releaseThreadsListReadLock();
 
   if (thread_of_given_stack_addr)
     debug(USERPROCESS, "[addrIsWithinAnyUserStack] Yes!\n");
@@ -757,19 +791,19 @@ void UserProcess::killThreadsSiblings(size_t tid)
   debug(USERPROCESS, "killThreadsSiblings: Thread %zu is gonna rogue and kills his siblings!\n", tid);
   ustl::map<size_t,UserThread*>::iterator it;
 
-  acquireThreadsListLock();
+  acquireThreadsListReadLock();
   for (it = thread_list_.begin(); it != thread_list_.end(); it++)
   {
     if (it->first != tid)
     {
       debug(USERPROCESS, "killThreadsSiblings: pthread_cancel(%zu);", it->first);
-      releaseThreadsListLock();
+      releaseThreadsListReadLock();
       UThreadManager::instance()->cancel_thread(it->first);            // stitch threads sibling
       UThreadManager::instance()->join_thread(it->first, NULL);  // wait till it bleeds out
-      acquireThreadsListLock();
+      acquireThreadsListReadLock();
     }
   }
-  releaseThreadsListLock();
+  releaseThreadsListReadLock();
 }
 
 size_t UserProcess::restructureProcessForExecv(ustl::string filename, pointer argv, int argc)
@@ -786,10 +820,13 @@ size_t UserProcess::restructureProcessForExecv(ustl::string filename, pointer ar
   {
     debug(USERPROCESS, "Error: loading %s failed!\n", filename.c_str());
     delete new_loader;
+    if (new_fd != -1)
+      VfsSyscall::close(new_fd);
     //ProcessRegistry::instance()->processExit();   // throws [BACKTRACE  ]
     return -1;
   }
   getLoader()->arch_memory_.copyArgsSegmentToNewArchMem(new_loader->arch_memory_, args_ppn_);
+  new_loader->mapVdso(vdso_ppn_);
   debug(USERPROCESS, "Swap loaders ...\n");
   auto old_loader = loader_;
   loader_ = new_loader;
@@ -804,6 +841,8 @@ size_t UserProcess::restructureProcessForExecv(ustl::string filename, pointer ar
 
   debug(USERPROCESS, "Delete old loader ...\n");
   delete old_loader;
+  VfsSyscall::close(fd_);
+  fd_ = new_fd;
 
   debug(USERPROCESS, "Successfully restructured Process: %zu\n", pid_);
   return 0;
@@ -812,6 +851,15 @@ size_t UserProcess::restructureProcessForExecv(ustl::string filename, pointer ar
 
 
 // ==== PRIVATE MEMBERS ====
+void UserProcess::setupVdsoPage()
+{
+  vdso_ppn_ = PageManager::instance()->allocPPN();
+  vdso_process_data* data = Vdso::processData(vdso_ppn_);
+  memset(data, 0, PAGE_SIZE);
+  data->pid = pid_;
+  loader_->mapVdso(vdso_ppn_);
+}
+
 uint64_t UserProcess::readTSC()
 {
   uint32_t low, high;
@@ -868,192 +916,108 @@ void UserProcess::incAccTime(size_t time)
   accumulated_incs_+= (uint64_t)time;
 }
 
-ustl::map<int, int> UserProcess::getLocalFDs() const
+size_t UserProcess::addFD(OpenFile* file)
 {
-  /*
-  ustl::map<int, int> copy_map;
-  //fds_lock_.acquire();
-  for(auto entry : fds_)
-  {
-    auto copy_fd = new FileDescriptor(VfsSyscall::getFileDescriptor(entry.second)->getFile());
-    FileDescriptor::add(copy_fd);
-    copy_map[entry.first] = (int)copy_fd->getFd();
-  }
-  //fds_lock_.release();
-  */
-  return fds_;
+  fds_lock_.acquire();
+  size_t fd = fd_allocator_.allocLowest();
+  if(fd != -1U)
+    fds_.set(fd, file);
+  fds_lock_.release();
+  if(fd == -1U)
+    file->unref();
+  return fd;
 }
 
-
-size_t UserProcess::addLocalFD(int global_fd)
+OpenFile* UserProcess::getFD(size_t fd)
 {
-  //(flag_ & O_WRONLY)
-  size_t cur_fd = 0;
   fds_lock_.acquire();
-  fds_[++fd_num_] = global_fd;
-  cur_fd = fd_num_;
-  //debug(USERPROCESS, "________________________________________[%ld]ADDING: |%ld -> %d| \n", pid_, cur_fd, global_fd);
+  OpenFile* file = fds_.get(fd);
+  if(file)
+    file->ref();
   fds_lock_.release();
-  return cur_fd;
+  return file;
 }
 
-void UserProcess::removeLocalFD(int fd)
+size_t UserProcess::closeFD(size_t fd)
 {
-  //(flag_ & O_WRONLY)
   fds_lock_.acquire();
-  fds_.erase(fd);
-  fds_lock_.release();
-  pipes_lock_.acquire();
-  for(auto entry : pipes_)
+  OpenFile* file = fds_.get(fd);
+  if(file)
   {
-    if(entry.first.first == fd && entry.first.second == PIPE_FD_CLOSED)
-    {
-      entry.second->decProcCount();
-      if(entry.second->getProcCount() == 0)
-      {
-        delete(entry.second);
-      }
-      pipes_.erase({entry.first.first, entry.first.second});
-      break;
-    }
-    else if(entry.first.first == fd && entry.first.second != PIPE_FD_CLOSED)
-    {
-      entry.first.first = PIPE_FD_CLOSED;
-      break;
-    }
-    if(entry.first.first == PIPE_FD_CLOSED && entry.first.second == fd)
-    {
-      entry.second->decProcCount();
-      if(entry.second->getProcCount() == 0)
-      {
-        delete(entry.second);
-      }
-      pipes_.erase({entry.first.first, entry.first.second});
-      break;
-    } 
-    else if(entry.first.first != PIPE_FD_CLOSED && entry.first.second == fd)
-    {
-      entry.first.second = PIPE_FD_CLOSED;
-      break;
-    }
+    fds_.set(fd, nullptr);
+    fd_allocator_.free(fd);
   }
-  pipes_lock_.release();
+  fds_lock_.release();
+  if(!file)
+    return -1U;
+  // a syscall still working on the file holds its own reference
+  file->unref();
+  return 0;
 }
 
-size_t UserProcess::getGlobalFD(int local_fd)
+size_t UserProcess::dupFD(size_t fd)
 {
-  //(flag_ & O_WRONLY)
-  size_t glob_fd = 0;
   fds_lock_.acquire();
-  /*
-  for(auto x : fds_)
+  OpenFile* file = fds_.get(fd);
+  size_t new_fd = file ? fd_allocator_.allocLowest() : -1U;
+  if(new_fd != -1U)
   {
-    debug(USERPROCESS, "________________________________________[%ld] %d -> %d\n",pid_, x.first, x.second);
+    file->ref();
+    fds_.set(new_fd, file);
   }
-  debug(USERPROCESS, "________________________________________ [%ld]GLOBAL_FD(%ld): get %d \n", pid_, global_fd.size(), local_fd);
-  */
-  glob_fd = (fds_.find(local_fd) == fds_.end()) ? -1U : fds_.at(local_fd);
   fds_lock_.release();
-  return glob_fd;
-}
-
-size_t UserProcess::getOrigLocalFD() const
-{
-  return fd_;
-}
-
-size_t UserProcess::getFdNum() const
-{
-  return fd_num_;
-}
-
-size_t UserProcess::openPipe(size_t read, size_t write)
-{
-  //fds_lock_.acquire();
-  //fds_[++fd_num_] = PIPE_FD_CODE;
-  //debug(USERPROCESS, "________________________________________[%ld]\n",read);  
-  *(int*)read = ++fd_num_;
-  //fds_[++fd_num_] = PIPE_FD_CODE;
-  *(int*)write = ++fd_num_;
-  //fds_lock_.release();
-  pipes_lock_.acquire();
-  pipes_[{*(int*)read, *(int*)write}] = new RingBuffer<char>(PIPE_BUF_SIZE);
-  pipes_.at({*(int*)read, *(int*)write})->incProcCount();
-  pipes_lock_.release();
-  return 0;
-  //debug(USERPROCESS, "________________________________________[%ld]ADDING: |%ld -> %d| \n", pid_, cur_fd, global_fd);
+  return new_fd;
 }
 
-size_t UserProcess::readFromPipe(size_t read_fd, pointer buffer, size_t count)
+size_t UserProcess::dup2FD(size_t old_fd, size_t new_fd)
 {
-  RingBuffer<char>* to_read = NULL;
-  pipes_lock_.acquire();
-  for(auto entry : pipes_)
-  {
-    if(entry.first.first == (int)read_fd)
-    {
-      to_read = entry.second;
-      break;
-    }
-  }
-  if(to_read == NULL)
-  {
-    pipes_lock_.release();
-    return -1;// NOT THE READ END OF THE PIPE
-  }
-  //assert(to_read != NULL && "Should not happen since the existence is checked beforehand");
-  size_t character = 0;
-  while (character < count && (to_read->get(((char*)buffer)[character])))
+  if(new_fd >= PROCESS_MAX_FDS)
+    return -1U;
+  fds_lock_.acquire();
+  OpenFile* file = fds_.get(old_fd);
+  OpenFile* replaced = nullptr;
+  if(file && old_fd != new_fd)
   {
-    character++;
+    replaced = fds_.get(new_fd);
+    if(!replaced)
+      fd_allocator_.allocId(new_fd);
+    file->ref();
+    fds_.set(new_fd, file);
   }
-  pipes_lock_.release();
-  return character;
+  fds_lock_.release();
+  if(!file)
+    return -1U;
+  if(replaced)
+    replaced->unref();
+  return new_fd;
 }
-size_t UserProcess::writeToPipe(size_t write_fd, pointer buffer, size_t count)
+
+size_t UserProcess::openPipe(size_t read, size_t write)
 {
-  RingBuffer<char>* to_write = NULL;
-  pipes_lock_.acquire();
-  for(auto entry : pipes_)
+  Pipe* pipe = new Pipe();
+  size_t read_fd = addFD(new PipeOpenFile(pipe, Pipe::READ_END));
+  size_t write_fd = addFD(new PipeOpenFile(pipe, Pipe::WRITE_END));
+  if(read_fd == -1U || write_fd == -1U)
   {
-    if(entry.first.second == (int)write_fd)
-    {
-      to_write = entry.second;
-      break;
-    }
-  }
-  if(to_write == NULL)
-  {
-    pipes_lock_.release();
-    return -1; // NOT THE WRITE END OF THE PIPE
-  }
-  //assert(to_write != NULL && "Should not happen since the existence is checked beforehand");
-  size_t character = 0;
-  while (character < count && (to_write->put(((char*)buffer)[character])))
-  {
-    //debug(USERPROCESS, "________________________________________PIPE W: %c\n", ((char*)buffer)[character]);
-    character++;
+    if(read_fd != -1U)
+      closeFD(read_fd);
+    if(write_fd != -1U)
+      closeFD(write_fd);
+    return -1;
   }
-  pipes_lock_.release();
-  return character; 
+  *(int*)read = read_fd;
+  *(int*)write = write_fd;
+  return 0;
 }
 
-bool UserProcess::isPipe(int local_fd)
+void UserProcess::wakeUpFDWaiters()
 {
-  pipes_lock_.acquire();
-  for(auto entry : pipes_)
+  fds_lock_.acquire();
+  for(size_t fd = 0; fd < PROCESS_MAX_FDS; ++fd)
   {
-    if(entry.first.first == local_fd || entry.first.second == local_fd)
-    {
-      pipes_lock_.release();
-      return true;
-    }
+    OpenFile* file = fds_.get(fd);
+    if(file)
+      file->wakeUpAll();
   }
-  pipes_lock_.release();
-  return false;
+  fds_lock_.release();
 }
-
-ustl::map<ustl::pair<int, int>, RingBuffer<char>*> UserProcess::getPipes() const
-{
-  return pipes_;
-}
\ No newline at end of file
@@ -16,6 +16,7 @@ UserThread::UserThread(FileSystemInfo* working_dir, ustl::string name, Thread::T
   debug(THREAD, "UserThread '%s' is being created\n", this->getName());
   tid_ = tid;
   t_loader_ = parent_proc_->getLoader();
+  parent_proc_->runnableThreadsChanged(true);
 
   stack_start_addr_ = parent_proc_->ASLRStackManager(tid_);
   stack_end_addr_ = stack_start_addr_ - STACK_MAX_SIZE;
@@ -53,9 +54,12 @@ UserThread::UserThread(UserThread* thread, UserProcess* parent_proc, size_t tid)
   tid_ = tid;
 
   t_loader_ = parent_proc_->getLoader();
+  parent_proc_->runnableThreadsChanged(true);
 
   time_to_wakeup_ = 0;
 
+  nice_ = thread->nice_;
+
   stack_start_addr_ = thread->stack_start_addr_;
   stack_end_addr_   = thread->stack_end_addr_;
 
@@ -200,13 +204,17 @@ void UserThread::restructureUserThread(Loader* new_loader, ustl::string new_name
 
 void UserThread::sleepUntil(uint64_t wakeup)
 {
+  // the scheduler must not see the wakeup time before the thread sleeps, it would reset it
+  ArchInterrupts::disableInterrupts();
   if(wakeup < Scheduler::instance()->getCurrentTime())
   {
+    ArchInterrupts::enableInterrupts();
     return;
   }
   time_to_wakeup_ = wakeup;
-  //debug(THREAD, "PID %ld |TID %ld| SLEEP UNTIL: %ld | STATE: %d\n", parent_proc_->getPid(), getTID(), getWakeUpTime(), getState()); 
-  //setState(Sleeping);
+  // sleeping instead of just waiting, so the thread does not count as runnable for its process
+  setState(Sleeping);
+  ArchInterrupts::enableInterrupts();
   Scheduler::instance()->yield();
 }
 
@@ -216,6 +224,11 @@ uint64_t UserThread::getWakeUpTime()
   return time_to_wakeup_;
 }
 
+void UserThread::setWakeUpTime(uint64_t wakeup)
+{
+  time_to_wakeup_ = wakeup;
+}
+
 void UserThread::resetWakeUp()
 {
   time_to_wakeup_ = 0;
@@ -0,0 +1,78 @@
+#include "Vdso.h"
+#include "Clocksource.h"
+#include "PageManager.h"
+#include "ArchMemory.h"
+#include "offsets.h"
+#include "kstring.h"
+#include "assert.h"
+#include "debug.h"
+
+static_assert(VDSO_TIME_PAGE_ADDRESS == VDSO_SEGMENT_END, "vdso-definitions.h does not match offsets.h");
+static_assert(VDSO_PROCESS_PAGE_ADDRESS == VDSO_SEGMENT_END + PAGE_SIZE, "vdso-definitions.h does not match offsets.h");
+static_assert(sizeof(vdso_time_data) <= PAGE_SIZE && sizeof(vdso_process_data) <= PAGE_SIZE, "vdso data exceeds a page");
+
+Vdso *Vdso::instance_ = 0;
+
+Vdso *Vdso::instance()
+{
+  if (unlikely(!instance_))
+    instance_ = new Vdso();
+  return instance_;
+}
+
+Vdso::Vdso() : time_page_ppn_(0), time_data_(0)
+{
+}
+
+void Vdso::init()
+{
+  assert(!time_data_ && "vdso time page initialised twice");
+  time_page_ppn_ = PageManager::instance()->allocPPN();
+  vdso_time_data* data = (vdso_time_data*) ArchMemory::getIdentAddressOfPPN(time_page_ppn_);
+  memset(data, 0, PAGE_SIZE);
+
+  Clocksource* clock = Clocksource::instance();
+  data->tsc_mult = clock->getMult();
+  data->tsc_shift = TSC_MULT_SHIFT;
+  data->tsc_hz = clock->getTSCFrequency();
+  data->boot_cycles = clock->getBootCycles();
+  data->tick_cycles = data->boot_cycles;
+  time_data_ = data;
+
+  debug(CLOCKSOURCE, "Vdso::init: time page is ppn %zx\n", time_page_ppn_);
+}
+
+void Vdso::tick(size_t ticks, uint64 now)
+{
+  if (!time_data_)
+    return;
+  writeBegin(time_data_->seq);
+  time_data_->ticks = ticks;
+  time_data_->tick_cycles = now;
+  writeEnd(time_data_->seq);
+}
+
+void Vdso::mapInto(ArchMemory &arch_memory, size_t process_page_ppn)
+{
+  assert(time_data_ && "vdso time page is not initialised");
+  bool mapped = arch_memory.mapPage(VDSO_TIME_PAGE_ADDRESS / PAGE_SIZE, time_page_ppn_, 1, 0);
+  mapped = mapped && arch_memory.mapPage(VDSO_PROCESS_PAGE_ADDRESS / PAGE_SIZE, process_page_ppn, 1, 0);
+  assert(mapped && "vdso pages were already mapped - this should never happen");
+}
+
+vdso_process_data* Vdso::processData(size_t process_page_ppn)
+{
+  return (vdso_process_data*) ArchMemory::getIdentAddressOfPPN(process_page_ppn);
+}
+
+void Vdso::writeBegin(volatile unsigned long &seq)
+{
+  ++seq;
+  __sync_synchronize();
+}
+
+void Vdso::writeEnd(volatile unsigned long &seq)
+{
+  __sync_synchronize();
+  ++seq;
+}
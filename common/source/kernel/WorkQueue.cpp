@@ -0,0 +1,109 @@
+#include "WorkQueue.h"
+#include "Scheduler.h"
+#include "ArchInterrupts.h"
+#include "ArchThreads.h"
+#include "kprintf.h"
+#include "assert.h"
+
+WorkItem::WorkItem(WorkFunction function, void* data) :
+  function_(function), data_(data), next_(0), pending_(0)
+{
+}
+
+WorkQueue* WorkQueue::instance_ = 0;
+
+WorkQueue* WorkQueue::instance()
+{
+  if (unlikely(!instance_))
+    instance_ = new WorkQueue();
+  return instance_;
+}
+
+WorkQueue::WorkQueue() : Thread(0, "WorkQueue", Thread::KERNEL_THREAD), pending_(0), idle_(0), running_(false)
+{
+}
+
+WorkQueue::~WorkQueue()
+{
+  assert(false && "WorkQueue destruction means that you probably have accessed an invalid pointer somewhere.");
+}
+
+void WorkQueue::kill()
+{
+  assert(false && "WorkQueue destruction means that you probably have accessed an invalid pointer somewhere.");
+}
+
+bool WorkQueue::queue(WorkItem* work)
+{
+  assert(work && work->function_);
+  if (ArchThreads::testSetLock(work->pending_, 1))
+    return false;
+
+  if (unlikely(!running_))
+  {
+    ArchThreads::atomic_set(work->pending_, 0);
+    work->function_(work->data_);
+    return true;
+  }
+
+  WorkItem* head = __atomic_load_n(&pending_, __ATOMIC_RELAXED);
+  do
+  {
+    work->next_ = head;
+  } while (!__atomic_compare_exchange_n(&pending_, &head, work, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+
+  // the worker sleeps with interrupts disabled, so nobody can go to sleep in between
+  bool interrupts = ArchInterrupts::disableInterrupts();
+  if (ArchThreads::testSetLock(idle_, 0))
+    setState(Running);
+  if (interrupts)
+    ArchInterrupts::enableInterrupts();
+  return true;
+}
+
+bool WorkQueue::runPending()
+{
+  WorkItem* work = __atomic_exchange_n(&pending_, (WorkItem*)0, __ATOMIC_ACQUIRE);
+  if (!work)
+    return false;
+
+  WorkItem* fifo = 0;
+  while (work)
+  {
+    WorkItem* next = work->next_;
+    work->next_ = fifo;
+    fifo = work;
+    work = next;
+  }
+
+  while (fifo)
+  {
+    work = fifo;
+    fifo = work->next_;
+    work->next_ = 0;
+    // from now on it can be queued again, e.g. by the next interrupt of the same device
+    ArchThreads::atomic_set(work->pending_, 0);
+    debug(WORKQUEUE, "running work item %p\n", work);
+    work->function_(work->data_);
+  }
+  return true;
+}
+
+void WorkQueue::Run()
+{
+  running_ = true;
+  while (1)
+  {
+    if (runPending())
+      continue;
+
+    ArchInterrupts::disableInterrupts();
+    if (!__atomic_load_n(&pending_, __ATOMIC_ACQUIRE))
+    {
+      idle_ = 1;
+      setState(Sleeping);
+    }
+    ArchInterrupts::enableInterrupts();
+    Scheduler::instance()->yield();
+  }
+}
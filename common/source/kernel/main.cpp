@@ -10,9 +10,13 @@
 #include "kprintf.h"
 #include "Thread.h"
 #include "Scheduler.h"
+#include "Clocksource.h"
+#include "Vdso.h"
 #include "ArchCommon.h"
 #include "ArchThreads.h"
 #include "Mutex.h"
+#include "RWLock.h"
+#include "WorkQueue.h"
 #include "debug_bochs.h"
 #include "ArchMemory.h"
 #include "Loader.h"
@@ -80,6 +84,10 @@ extern "C" void startup()
 
   ArchInterrupts::setTimerFrequency(IRQ0_TIMER_FREQUENCY);
 
+  debug(MAIN, "Clocksource calibration\n");
+  Clocksource::instance()->calibrate();
+  Vdso::instance()->init();
+
   ArchCommon::initDebug();
 
   vfs.initialize();
@@ -100,8 +108,10 @@ extern "C" void startup()
   // initialise global and static objects
   extern ustl::list<FileDescriptor*> global_fd;
   new (&global_fd) ustl::list<FileDescriptor*>();
-  extern Mutex global_fd_lock;
-  new (&global_fd_lock) Mutex("global_fd_lock");
+  extern RWLock global_fd_lock;
+  new (&global_fd_lock) RWLock("global_fd_lock");
+  extern RWLock dentry_tree_lock;
+  new (&dentry_tree_lock) RWLock("dentry_tree_lock");
 
   debug(MAIN, "make a deep copy of FsWorkingDir\n");
   main_console->setWorkingDirInfo(new FileSystemInfo(*default_working_dir));
@@ -124,6 +134,7 @@ extern "C" void startup()
 
   debug(MAIN, "Adding Kernel threads\n");
   Scheduler::instance()->addNewThread(main_console);
+  Scheduler::instance()->addNewThread(WorkQueue::instance());
   Scheduler::instance()->addNewThread(new ProcessRegistry(new FileSystemInfo(*default_working_dir), user_progs /*see user_progs.h*/));
   Scheduler::instance()->printThreadList();
 
@@ -0,0 +1,104 @@
+#include "IdAllocator.h"
+#include "assert.h"
+
+#define WORD_OF(id) ((id) / ID_ALLOCATOR_BITS_PER_WORD)
+#define MASK_OF(id) (1ULL << ((id) % ID_ALLOCATOR_BITS_PER_WORD))
+
+IdAllocator::IdAllocator(size_t max_ids) :
+  max_ids_(max_ids),
+  num_words_(max_ids / ID_ALLOCATOR_BITS_PER_WORD),
+  num_summary_words_((num_words_ + ID_ALLOCATOR_BITS_PER_WORD - 1) / ID_ALLOCATOR_BITS_PER_WORD),
+  used_(0), full_(0), next_(0), num_used_(0)
+{
+  assert(max_ids && max_ids % ID_ALLOCATOR_BITS_PER_WORD == 0);
+  used_ = new uint64[num_words_]{};
+  full_ = new uint64[num_summary_words_]{};
+  // words past the end are never free
+  for (size_t word = num_words_; word < num_summary_words_ * ID_ALLOCATOR_BITS_PER_WORD; ++word)
+    full_[WORD_OF(word)] |= MASK_OF(word);
+}
+
+IdAllocator::~IdAllocator()
+{
+  delete[] used_;
+  delete[] full_;
+}
+
+size_t IdAllocator::findFree(size_t start) const
+{
+  if (start >= max_ids_)
+    return -1U;
+
+  // the rest of the word start is in
+  size_t word = WORD_OF(start);
+  uint64 free_bits = ~used_[word] & ~(MASK_OF(start) - 1);
+  if (free_bits)
+    return word * ID_ALLOCATOR_BITS_PER_WORD + __builtin_ctzll(free_bits);
+
+  // then the first word that is not full
+  ++word;
+  for (size_t summary = WORD_OF(word); summary < num_summary_words_; ++summary)
+  {
+    uint64 not_full = ~full_[summary];
+    if (summary == WORD_OF(word))
+      not_full &= ~(MASK_OF(word) - 1);
+    if (not_full)
+    {
+      word = summary * ID_ALLOCATOR_BITS_PER_WORD + __builtin_ctzll(not_full);
+      return word * ID_ALLOCATOR_BITS_PER_WORD + __builtin_ctzll(~used_[word]);
+    }
+  }
+  return -1U;
+}
+
+size_t IdAllocator::alloc()
+{
+  size_t id = findFree(next_);
+  if (id == -1U)
+    id = findFree(0);
+  if (id == -1U)
+    return -1U;
+
+  markUsed(id);
+  next_ = (id + 1 == max_ids_) ? 0 : id + 1;
+  return id;
+}
+
+size_t IdAllocator::allocLowest()
+{
+  size_t id = findFree(0);
+  if (id != -1U)
+    markUsed(id);
+  return id;
+}
+
+bool IdAllocator::allocId(size_t id)
+{
+  if (id >= max_ids_ || isUsed(id))
+    return false;
+  markUsed(id);
+  return true;
+}
+
+void IdAllocator::markUsed(size_t id)
+{
+  size_t word = WORD_OF(id);
+  used_[word] |= MASK_OF(id);
+  if (used_[word] == ~0ULL)
+    full_[WORD_OF(word)] |= MASK_OF(word);
+  ++num_used_;
+}
+
+void IdAllocator::free(size_t id)
+{
+  assert(isUsed(id) && "IdAllocator::free: id is not in use");
+  size_t word = WORD_OF(id);
+  used_[word] &= ~MASK_OF(id);
+  full_[WORD_OF(word)] &= ~MASK_OF(word);
+  --num_used_;
+}
+
+bool IdAllocator::isUsed(size_t id) const
+{
+  return id < max_ids_ && (used_[WORD_OF(id)] & MASK_OF(id));
+}
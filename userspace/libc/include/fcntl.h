@@ -20,6 +20,7 @@
 #pragma once
 
 #include "unistd.h"
+#include "../../../common/include/kernel/splice-definitions.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -144,6 +145,53 @@ extern int creat(const char *path, mode_t mode);
  */
 extern int open(const char *path, int flags, ...);
 
+/**
+ * Moves data between a pipe and a file without copying it through a user
+ * buffer. Either fd_in is the read end of a pipe and fd_out a regular file or
+ * the terminal, or fd_out is the write end of a pipe and fd_in a regular file.
+ * The data is moved at the current file offset, so off_in and off_out have to
+ * be NULL.
+ * Blocks like read and write on the pipe, moves at most one pipe buffer.
+ *
+ * @param fd_in The descriptor to read from
+ * @param off_in Must be NULL
+ * @param fd_out The descriptor to write to
+ * @param off_out Must be NULL
+ * @param len The maximum number of bytes to move
+ * @param flags SPLICE_F_* hints, ignored
+ * @return The number of bytes moved, 0 at end of file or -1 if an error occured
+ *
+ */
+extern ssize_t splice(int fd_in, off_t *off_in, int fd_out, off_t *off_out, size_t len, unsigned int flags);
+
+/**
+ * Writes the given user buffers to the write end of a pipe with one call.
+ *
+ * @param fd The write end of a pipe
+ * @param iov The buffers
+ * @param nr_segs The number of buffers, at most UIO_MAXIOV
+ * @param flags SPLICE_F_* hints, ignored
+ * @return The number of bytes written or -1 if an error occured
+ *
+ */
+extern ssize_t vmsplice(int fd, const struct iovec *iov, unsigned long nr_segs, unsigned int flags);
+
+/**
+ * Copies len bytes between two files in the kernel, without a user buffer.
+ * A NULL offset uses and advances the file position, otherwise the file is
+ * read or written at *offset, which is advanced.
+ *
+ * @param fd_in The file to read from
+ * @param off_in The position to read from or NULL
+ * @param fd_out The file to write to
+ * @param off_out The position to write to or NULL
+ * @param len The number of bytes to copy
+ * @param flags Has to be 0
+ * @return The number of bytes copied, 0 at end of file or -1 if an error occured
+ *
+ */
+extern ssize_t copy_file_range(int fd_in, off_t *off_in, int fd_out, off_t *off_out, size_t len, unsigned int flags);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "types.h"
+#include "../../../common/include/kernel/poll-definitions.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef unsigned long nfds_t;
+
+/**
+ * waits until one of the fds is ready for the requested events
+ * timeout in milliseconds, 0 returns right away, a negative one waits forever
+ * returns the number of fds with revents set, 0 on timeout, -1 on error
+ */
+extern int poll(struct pollfd *fds, nfds_t nfds, int timeout);
+
+#ifdef __cplusplus
+}
+#endif
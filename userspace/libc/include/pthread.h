@@ -11,15 +11,23 @@ typedef size_t pthread_t;
 typedef unsigned int pthread_attr_t;
 
 //pthread mutex typedefs
+//0: unlocked, 1: locked, 2: locked and there might be waiters in the kernel
 typedef unsigned int pthread_mutex_t;
 typedef unsigned int pthread_mutexattr_t;
+#define PTHREAD_MUTEX_INITIALIZER 0
 
 //pthread spinlock typedefs
 typedef unsigned int pthread_spinlock_t;
 
 //pthread cond typedefs
-typedef unsigned int pthread_cond_t;
+typedef struct
+{
+  unsigned int sequence;   //futex word, bumped by every signal/broadcast
+  unsigned int waiters;    //threads in pthread_cond_wait, signals skip the kernel if there are none
+  pthread_mutex_t *mutex;  //the mutex waiters use, broadcast requeues onto it
+} pthread_cond_t;
 typedef unsigned int pthread_condattr_t;
+#define PTHREAD_COND_INITIALIZER { 0, 0, 0 }
 
 extern int pthread_create(pthread_t *thread,
          const pthread_attr_t *attr, void *(*start_routine)(void *),
@@ -52,6 +60,16 @@ extern int pthread_cond_broadcast(pthread_cond_t *cond);
 
 extern int pthread_cond_wait(pthread_cond_t *cond, pthread_mutex_t *mutex);
 
+extern int pthread_spin_init(pthread_spinlock_t *lock, int pshared);
+
+extern int pthread_spin_destroy(pthread_spinlock_t *lock);
+
+extern int pthread_spin_lock(pthread_spinlock_t *lock);
+
+extern int pthread_spin_trylock(pthread_spinlock_t *lock);
+
+extern int pthread_spin_unlock(pthread_spinlock_t *lock);
+
 #ifdef __cplusplus
 }
 #endif
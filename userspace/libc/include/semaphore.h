@@ -7,7 +7,11 @@ extern "C" {
 //semaphores typedefs
 #ifndef SEM_T_DEFINED_
 #define SEM_T_DEFINED_
-typedef unsigned int sem_t;
+typedef struct
+{
+  unsigned int value;    //futex word
+  unsigned int waiters;  //threads in sem_wait, sem_post only enters the kernel if there are any
+} sem_t;
 #endif // SEM_T_DEFINED_
 
 extern int sem_init(sem_t *sem, int pshared, unsigned value);
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// futex operations, kept in sync with common/include/kernel/Futex.h
+#define FUTEX_WAIT 0
+#define FUTEX_WAKE 1
+#define FUTEX_REQUEUE 3
+
+/**
+ * FUTEX_WAIT: sleeps as long as *address == value, returns 0 when woken, -1 otherwise
+ * FUTEX_WAKE: wakes up to value threads sleeping on address, returns the number woken
+ * FUTEX_REQUEUE: wakes up to value threads and moves up to value2 others to address2
+ */
+extern int futex(unsigned int *address, int op, unsigned int value,
+                 unsigned int *address2, unsigned int value2);
+
+#ifdef __cplusplus
+}
+#endif
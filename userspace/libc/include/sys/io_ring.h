@@ -0,0 +1,43 @@
+#pragma once
+
+#include "types.h"
+#include "../../../../common/include/kernel/io-ring-definitions.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * allocates both rings with entries (a power of two, at most IO_RING_MAX_ENTRIES) entries each
+ * returns 0 on success, -1 on error
+ */
+extern int io_ring_init(struct io_ring *ring, unsigned int entries);
+
+extern void io_ring_free(struct io_ring *ring);
+
+/**
+ * returns the next free submission entry filled in with the operation, NULL if the ring is full
+ * the entry is handed to the kernel by the next io_ring_submit
+ */
+extern struct io_ring_sqe *io_ring_prep(struct io_ring *ring, unsigned int opcode, int fd,
+                                        unsigned long addr, unsigned long len, unsigned long user_data);
+
+/**
+ * executes the prepared entries with one kernel entry, stops early if the completion ring is full
+ * returns the number of entries executed, -1 on error
+ */
+extern int io_ring_submit(struct io_ring *ring);
+
+/**
+ * returns the oldest completion that was not seen yet, NULL if there is none
+ */
+extern struct io_ring_cqe *io_ring_peek_cqe(struct io_ring *ring);
+
+/**
+ * frees the completion returned by io_ring_peek_cqe
+ */
+extern void io_ring_cqe_seen(struct io_ring *ring);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "types.h"
+#include "../../../../common/include/kernel/termios-definitions.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * device specific requests, only TIOCSTI on the terminal is supported:
+ * the character the third argument points to is handled as if it was typed
+ * returns 0 on success, -1 on error
+ */
+extern int ioctl(int fd, unsigned long request, ...);
+
+#ifdef __cplusplus
+}
+#endif
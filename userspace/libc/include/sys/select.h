@@ -0,0 +1,39 @@
+#pragma once
+
+#include "types.h"
+#include "time.h"
+#include "string.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FD_SETSIZE 1024
+
+typedef struct
+{
+  unsigned long fds_bits[FD_SETSIZE / (8 * sizeof(unsigned long))];
+} fd_set;
+
+#define __FD_BITS (8 * sizeof(unsigned long))
+#define FD_ZERO(set) memset((set), 0, sizeof(fd_set))
+#define FD_SET(fd, set) ((set)->fds_bits[(fd) / __FD_BITS] |= (1UL << ((fd) % __FD_BITS)))
+#define FD_CLR(fd, set) ((set)->fds_bits[(fd) / __FD_BITS] &= ~(1UL << ((fd) % __FD_BITS)))
+#define FD_ISSET(fd, set) (((set)->fds_bits[(fd) / __FD_BITS] >> ((fd) % __FD_BITS)) & 1UL)
+
+struct timeval
+{
+  time_t tv_sec;
+  long tv_usec;
+};
+
+/**
+ * waits until one of the fds in the sets is ready, implemented on top of poll
+ * timeout NULL waits forever, the sets are overwritten with the ready fds
+ * returns the number of ready fds counted per set, 0 on timeout, -1 on error
+ */
+extern int select(int nfds, fd_set *readfds, fd_set *writefds, fd_set *exceptfds, struct timeval *timeout);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * copies count bytes from the file in_fd to out_fd without a user buffer
+ * out_fd may be a file, a pipe, a socket or the terminal
+ * if offset is not NULL, in_fd is read from *offset, *offset is advanced and the
+ * file position of in_fd stays, otherwise the file position is used and advanced
+ * returns the number of bytes copied, -1 on error
+ */
+extern ssize_t sendfile(int out_fd, int in_fd, off_t *offset, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
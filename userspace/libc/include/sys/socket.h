@@ -0,0 +1,67 @@
+#pragma once
+
+#include "types.h"
+#include "../../../../common/include/kernel/socket-definitions.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef unsigned int socklen_t;
+typedef unsigned short sa_family_t;
+
+struct sockaddr
+{
+  sa_family_t sa_family;
+  char sa_data[14];
+};
+
+/**
+ * creates an unbound unix domain socket
+ * domain has to be AF_UNIX, type SOCK_STREAM or SOCK_DGRAM, protocol 0
+ * returns the fd of the socket, -1 on error
+ */
+extern int socket(int domain, int type, int protocol);
+
+/**
+ * gives the socket the name in the sun_path of a struct sockaddr_un
+ * the names are kept by the kernel, no file is created
+ * returns 0 on success, -1 if the name is taken
+ */
+extern int bind(int sockfd, const struct sockaddr *addr, socklen_t addrlen);
+
+/**
+ * makes a bound stream socket accept connections, up to backlog (at most SOMAXCONN) may wait
+ * returns 0 on success, -1 on error
+ */
+extern int listen(int sockfd, int backlog);
+
+/**
+ * waits for a connection to the listening socket
+ * the address of the peer is unnamed, addr only gets the family
+ * returns the fd of the connected socket, -1 on error
+ */
+extern int accept(int sockfd, struct sockaddr *addr, socklen_t *addrlen);
+
+/**
+ * a stream socket connects to the listening socket with the name, a datagram
+ * socket sends its messages to the socket with the name from now on
+ * returns 0 on success, -1 if there is no such socket or it has too many waiting connections
+ */
+extern int connect(int sockfd, const struct sockaddr *addr, socklen_t addrlen);
+
+/**
+ * like write, a datagram is sent as a whole or not at all, flags are ignored
+ * returns the number of bytes sent, -1 on error
+ */
+extern ssize_t send(int sockfd, const void *buf, size_t len, int flags);
+
+/**
+ * like read, a datagram longer than len is truncated, flags are ignored
+ * returns the number of bytes received, 0 if the peer closed the connection, -1 on error
+ */
+extern ssize_t recv(int sockfd, void *buf, size_t len, int flags);
+
+#ifdef __cplusplus
+}
+#endif
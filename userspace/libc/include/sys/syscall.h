@@ -36,6 +36,15 @@ extern "C" {
 extern size_t __syscall(size_t arg1, size_t arg2, size_t arg3,
                         size_t arg4, size_t arg5, size_t arg6);
 
+#ifdef __x86_64__
+/**
+ * Same as __syscall, but always enters the kernel through int $0x80 instead of
+ * the SYSCALL instruction. Kept as fallback and for comparison.
+ */
+extern size_t __syscall_int80(size_t arg1, size_t arg2, size_t arg3,
+                              size_t arg4, size_t arg5, size_t arg6);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
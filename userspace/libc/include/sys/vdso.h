@@ -0,0 +1,35 @@
+#pragma once
+
+#include "types.h"
+#include "../../../../common/include/kernel/vdso-definitions.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Helpers for reading the vdso pages the kernel maps into every process.
+ * They are only available on x86_64, the callers fall back to syscalls otherwise.
+ */
+#ifdef __x86_64__
+#define VDSO_AVAILABLE 1
+
+#define __vdso_time_data ((const struct vdso_time_data*) VDSO_TIME_PAGE_ADDRESS)
+#define __vdso_process_data ((const struct vdso_process_data*) VDSO_PROCESS_PAGE_ADDRESS)
+
+/**
+ * @return nanoseconds since boot, the same value CLOCK_MONOTONIC returns
+ */
+extern unsigned long __vdso_monotonic_ns(void);
+
+/**
+ * @return cpu time of the calling process in nanoseconds
+ */
+extern unsigned long __vdso_process_cputime_ns(void);
+#else
+#define VDSO_AVAILABLE 0
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "types.h"
+#include "../../../common/include/kernel/termios-definitions.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * gets the attributes of the terminal fd refers to
+ * returns 0 on success, -1 if fd is not the terminal
+ */
+extern int tcgetattr(int fd, struct termios *termios_p);
+
+/**
+ * sets the attributes of the terminal fd refers to, see termios-definitions.h
+ * for optional_actions and what is supported
+ * returns 0 on success, -1 if fd is not the terminal
+ */
+extern int tcsetattr(int fd, int optional_actions, const struct termios *termios_p);
+
+/**
+ * turns the attributes into raw mode: no line editing, no echo, read waits for one character
+ */
+extern void cfmakeraw(struct termios *termios_p);
+
+#ifdef __cplusplus
+}
+#endif
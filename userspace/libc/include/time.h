@@ -6,14 +6,47 @@ extern "C" {
 
 #define CLOCKS_PER_SEC 1000000
 
+// clock ids, kept in sync with common/include/kernel/Clocksource.h
+#define CLOCK_REALTIME 0
+#define CLOCK_MONOTONIC 1
+#define CLOCK_PROCESS_CPUTIME_ID 2
+
 #ifndef CLOCK_T_DEFINED
 #define CLOCK_T_DEFINED
 typedef unsigned int clock_t;
 #endif // CLOCK_T_DEFINED
 
+typedef long int time_t;
+typedef int clockid_t;
+
+struct timespec
+{
+  time_t tv_sec;
+  long tv_nsec;
+};
+
 extern clock_t clock(void);
 
+/**
+ * Retrieves the time of the given clock.
+ * CLOCK_MONOTONIC counts nanoseconds since boot, CLOCK_PROCESS_CPUTIME_ID
+ * the cpu time consumed by all threads of the calling process.
+ *
+ * @param clock_id the clock to read
+ * @param tp where the time is stored
+ * @return 0 on success, -1 for an unsupported clock or an invalid pointer
+ */
+extern int clock_gettime(clockid_t clock_id, struct timespec *tp);
+
+/**
+ * Suspends the calling thread for at least the time given in req.
+ *
+ * @param req the time to sleep, tv_nsec has to be within [0, 999999999]
+ * @param rem if not NULL, the remaining time is stored here (always 0)
+ * @return 0 on success, -1 if req is invalid
+ */
+extern int nanosleep(const struct timespec *req, struct timespec *rem);
+
 #ifdef __cplusplus
 }
 #endif
-
@@ -119,6 +119,14 @@ typedef long int intptr_t;
  */
 extern pid_t fork();
 
+/**
+ * Returns the process ID of the calling process.
+ *
+ * @return the pid of the calling process, this function never fails
+ *
+ */
+extern pid_t getpid(void);
+
 /**
  * Terminates the calling process. Any open file descriptors belonging to the
  * process are closed, any children of the process are inherited by process
@@ -211,6 +219,15 @@ extern int dup(int file_descriptor);
  */
 extern int dup2(int old_file_descriptor, int new_file_descriptor);
 
+/**
+ * Writes the changes to the file with the given descriptor to the disk.
+ *
+ * @param file_descriptor the descriptor of the file
+ * @return 0 on success or -1 if the descriptor is not an open file
+ *
+ */
+extern int fsync(int file_descriptor);
+
 /**
  * Creates a pipe.
  * A pair of file descriptors pointing to a pipe inode is created and placed
@@ -290,6 +307,17 @@ extern void* sbrk(intptr_t increment);
 
 extern unsigned int sleep(unsigned int seconds);
 
+/**
+ * Adds increment to the nice value of the calling thread.
+ * A higher nice value gives the thread a smaller share of the cpu when the
+ * fair-share scheduling policy is active. The result is clamped to [-20, 19].
+ *
+ * @param increment the value to add to the current nice value
+ * @return the new nice value
+ *
+ */
+extern int nice(int increment);
+
 /**
  * Replaces the current process image with a new one.
  * The values provided with the argv array are the arguments for the new
@@ -144,7 +144,7 @@ int pipe(int file_descriptor_array[2])
  */
 int dup(int file_descriptor)
 {
-  return -1;
+  return __syscall(sc_dup, file_descriptor, 0x00, 0x00, 0x00, 0x00);
 }
 
 
@@ -162,7 +162,19 @@ int dup(int file_descriptor)
  */
 int dup2(int old_file_descriptor, int new_file_descriptor)
 {
-  return -1;
+  return __syscall(sc_dup2, old_file_descriptor, new_file_descriptor, 0x00, 0x00, 0x00);
+}
+
+/**
+ * Writes the changes to the file with the given descriptor to the disk.
+ *
+ * @param file_descriptor the descriptor of the file
+ * @return 0 on success or -1 if the descriptor is not an open file
+ *
+ */
+int fsync(int file_descriptor)
+{
+  return __syscall(sc_fsync, file_descriptor, 0x00, 0x00, 0x00, 0x00);
 }
 
 
@@ -0,0 +1,9 @@
+#include "sys/futex.h"
+#include "sys/syscall.h"
+#include "../../../common/include/kernel/syscall-definitions.h"
+
+int futex(unsigned int *address, int op, unsigned int value,
+          unsigned int *address2, unsigned int value2)
+{
+  return __syscall(sc_futex, (size_t)address, (size_t)op, (size_t)value, (size_t)address2, (size_t)value2);
+}
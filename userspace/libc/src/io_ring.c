@@ -0,0 +1,66 @@
+#include "sys/io_ring.h"
+#include "sys/syscall.h"
+#include "stdlib.h"
+#include "string.h"
+#include "../../../common/include/kernel/syscall-definitions.h"
+
+int io_ring_init(struct io_ring *ring, unsigned int entries)
+{
+  if (!entries || entries > IO_RING_MAX_ENTRIES || (entries & (entries - 1)))
+    return -1;
+  memset(ring, 0, sizeof(*ring));
+  ring->sqes = malloc(entries * sizeof(struct io_ring_sqe));
+  ring->cqes = malloc(entries * sizeof(struct io_ring_cqe));
+  if (!ring->sqes || !ring->cqes)
+  {
+    io_ring_free(ring);
+    return -1;
+  }
+  ring->entries = entries;
+  return 0;
+}
+
+void io_ring_free(struct io_ring *ring)
+{
+  free(ring->sqes);
+  free(ring->cqes);
+  ring->sqes = NULL;
+  ring->cqes = NULL;
+  ring->entries = 0;
+}
+
+struct io_ring_sqe *io_ring_prep(struct io_ring *ring, unsigned int opcode, int fd,
+                                 unsigned long addr, unsigned long len, unsigned long user_data)
+{
+  if (ring->sq_next - __atomic_load_n(&ring->sq_head, __ATOMIC_ACQUIRE) == ring->entries)
+    return NULL;
+  struct io_ring_sqe *sqe = &ring->sqes[ring->sq_next++ & (ring->entries - 1)];
+  sqe->opcode = opcode;
+  sqe->fd = fd;
+  sqe->addr = addr;
+  sqe->len = len;
+  sqe->user_data = user_data;
+  return sqe;
+}
+
+int io_ring_submit(struct io_ring *ring)
+{
+  // entries left over from the last submit because the completion ring was full go in again
+  unsigned int to_submit = ring->sq_next - __atomic_load_n(&ring->sq_head, __ATOMIC_ACQUIRE);
+  // the kernel only sees the entries once the tail is published
+  __atomic_store_n(&ring->sq_tail, ring->sq_next, __ATOMIC_RELEASE);
+  return __syscall(sc_io_ring_enter, (size_t)ring, (size_t)to_submit, 0x00, 0x00, 0x00);
+}
+
+struct io_ring_cqe *io_ring_peek_cqe(struct io_ring *ring)
+{
+  unsigned int cq_head = ring->cq_head;
+  if (cq_head == __atomic_load_n(&ring->cq_tail, __ATOMIC_ACQUIRE))
+    return NULL;
+  return &ring->cqes[cq_head & (ring->entries - 1)];
+}
+
+void io_ring_cqe_seen(struct io_ring *ring)
+{
+  __atomic_store_n(&ring->cq_head, ring->cq_head + 1, __ATOMIC_RELEASE);
+}
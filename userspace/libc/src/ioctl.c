@@ -0,0 +1,13 @@
+#include "sys/ioctl.h"
+#include "sys/syscall.h"
+#include "stdarg.h"
+#include "../../../common/include/kernel/syscall-definitions.h"
+
+int ioctl(int fd, unsigned long request, ...)
+{
+  va_list args;
+  va_start(args, request);
+  void *arg = va_arg(args, void *);
+  va_end(args);
+  return __syscall(sc_ioctl, (size_t)fd, (size_t)request, (size_t)arg, 0x00, 0x00);
+}
@@ -0,0 +1,8 @@
+#include "poll.h"
+#include "sys/syscall.h"
+#include "../../../common/include/kernel/syscall-definitions.h"
+
+int poll(struct pollfd *fds, nfds_t nfds, int timeout)
+{
+  return __syscall(sc_poll, (size_t)fds, (size_t)nfds, (size_t)timeout, 0x00, 0x00);
+}
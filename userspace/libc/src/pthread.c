@@ -1,7 +1,26 @@
 #include "pthread.h"
+#include "sched.h"
 #include "sys/syscall.h"
+#include "sys/futex.h"
 #include "../../../common/include/kernel/syscall-definitions.h"
 
+#define MUTEX_UNLOCKED 0
+#define MUTEX_LOCKED 1
+#define MUTEX_CONTENDED 2
+
+static inline unsigned int compareExchange(unsigned int *address, unsigned int expected, unsigned int desired)
+{
+  __atomic_compare_exchange_n(address, &expected, desired, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+  return expected;
+}
+
+// slow path, only taken if somebody else holds the mutex
+static void mutexLockContended(pthread_mutex_t *mutex)
+{
+  while (__atomic_exchange_n(mutex, MUTEX_CONTENDED, __ATOMIC_SEQ_CST) != MUTEX_UNLOCKED)
+    futex(mutex, FUTEX_WAIT, MUTEX_CONTENDED, 0, 0);
+}
+
 void exec_thread(void *(*start_routine)(void *), void* args)
 {
   pthread_exit(start_routine(args));
@@ -25,7 +44,8 @@ int pthread_create(pthread_t *thread,
  */
 int pthread_mutex_init(pthread_mutex_t *mutex, const pthread_mutexattr_t *attr)
 {
-  return -1;
+  *mutex = MUTEX_UNLOCKED;
+  return 0;
 }
 
 /**
@@ -70,7 +90,7 @@ int pthread_detach(pthread_t thread)
  */
 int pthread_mutex_destroy(pthread_mutex_t *mutex)
 {
-  return -1;
+  return (*mutex == MUTEX_UNLOCKED) ? 0 : -1;
 }
 
 /**
@@ -79,7 +99,10 @@ int pthread_mutex_destroy(pthread_mutex_t *mutex)
  */
 int pthread_mutex_lock(pthread_mutex_t *mutex)
 {
-  return -1;
+  // uncontended: a single cmpxchg, no syscall
+  if (compareExchange(mutex, MUTEX_UNLOCKED, MUTEX_LOCKED) != MUTEX_UNLOCKED)
+    mutexLockContended(mutex);
+  return 0;
 }
 
 /**
@@ -88,7 +111,18 @@ int pthread_mutex_lock(pthread_mutex_t *mutex)
  */
 int pthread_mutex_unlock(pthread_mutex_t *mutex)
 {
-  return -1;
+  unsigned int state = __atomic_fetch_sub(mutex, 1, __ATOMIC_SEQ_CST);
+  if (state == MUTEX_LOCKED)
+    return 0;
+  if (state == MUTEX_UNLOCKED)
+  {
+    __atomic_store_n(mutex, MUTEX_UNLOCKED, __ATOMIC_SEQ_CST);
+    return -1;
+  }
+  // there might be waiters, hand the mutex over to one of them
+  __atomic_store_n(mutex, MUTEX_UNLOCKED, __ATOMIC_SEQ_CST);
+  futex(mutex, FUTEX_WAKE, 1, 0, 0);
+  return 0;
 }
 
 /**
@@ -97,7 +131,10 @@ int pthread_mutex_unlock(pthread_mutex_t *mutex)
  */
 int pthread_cond_init(pthread_cond_t *cond, const pthread_condattr_t *attr)
 {
-  return -1;
+  cond->sequence = 0;
+  cond->waiters = 0;
+  cond->mutex = 0;
+  return 0;
 }
 
 /**
@@ -106,7 +143,7 @@ int pthread_cond_init(pthread_cond_t *cond, const pthread_condattr_t *attr)
  */
 int pthread_cond_destroy(pthread_cond_t *cond)
 {
-  return -1;
+  return __atomic_load_n(&cond->waiters, __ATOMIC_SEQ_CST) ? -1 : 0;
 }
 
 /**
@@ -115,7 +152,10 @@ int pthread_cond_destroy(pthread_cond_t *cond)
  */
 int pthread_cond_signal(pthread_cond_t *cond)
 {
-  return -1;
+  __atomic_fetch_add(&cond->sequence, 1, __ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&cond->waiters, __ATOMIC_SEQ_CST))
+    futex(&cond->sequence, FUTEX_WAKE, 1, 0, 0);
+  return 0;
 }
 
 /**
@@ -124,7 +164,13 @@ int pthread_cond_signal(pthread_cond_t *cond)
  */
 int pthread_cond_broadcast(pthread_cond_t *cond)
 {
-  return -1;
+  __atomic_fetch_add(&cond->sequence, 1, __ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&cond->waiters, __ATOMIC_SEQ_CST))
+  {
+    // wake one, the others are moved to the mutex and woken one by one as it gets unlocked
+    futex(&cond->sequence, FUTEX_REQUEUE, 1, cond->mutex, -1U);
+  }
+  return 0;
 }
 
 /**
@@ -133,7 +179,17 @@ int pthread_cond_broadcast(pthread_cond_t *cond)
  */
 int pthread_cond_wait(pthread_cond_t *cond, pthread_mutex_t *mutex)
 {
-  return -1;
+  __atomic_fetch_add(&cond->waiters, 1, __ATOMIC_SEQ_CST);
+  unsigned int sequence = __atomic_load_n(&cond->sequence, __ATOMIC_SEQ_CST);
+  __atomic_store_n(&cond->mutex, mutex, __ATOMIC_SEQ_CST);
+  pthread_mutex_unlock(mutex);
+
+  futex(&cond->sequence, FUTEX_WAIT, sequence, 0, 0);
+
+  // we may have been requeued onto the mutex, so it has to stay marked as contended
+  mutexLockContended(mutex);
+  __atomic_fetch_sub(&cond->waiters, 1, __ATOMIC_SEQ_CST);
+  return 0;
 }
 
 /**
@@ -142,7 +198,7 @@ int pthread_cond_wait(pthread_cond_t *cond, pthread_mutex_t *mutex)
  */
 int pthread_spin_destroy(pthread_spinlock_t *lock)
 {
-  return -1;
+  return 0;
 }
 
 /**
@@ -151,7 +207,8 @@ int pthread_spin_destroy(pthread_spinlock_t *lock)
  */
 int pthread_spin_init(pthread_spinlock_t *lock, int pshared)
 {
-  return -1;
+  *lock = 0;
+  return 0;
 }
 
 /**
@@ -160,7 +217,13 @@ int pthread_spin_init(pthread_spinlock_t *lock, int pshared)
  */
 int pthread_spin_lock(pthread_spinlock_t *lock)
 {
-  return -1;
+  while (__atomic_exchange_n(lock, 1, __ATOMIC_ACQUIRE))
+  {
+    // there is only one cpu, the holder has to run before the lock can become free
+    while (__atomic_load_n(lock, __ATOMIC_RELAXED))
+      sched_yield();
+  }
+  return 0;
 }
 
 /**
@@ -169,7 +232,7 @@ int pthread_spin_lock(pthread_spinlock_t *lock)
  */
 int pthread_spin_trylock(pthread_spinlock_t *lock)
 {
-  return -1;
+  return __atomic_exchange_n(lock, 1, __ATOMIC_ACQUIRE) ? -1 : 0;
 }
 
 /**
@@ -178,6 +241,7 @@ int pthread_spin_trylock(pthread_spinlock_t *lock)
  */
 int pthread_spin_unlock(pthread_spinlock_t *lock)
 {
-  return -1;
+  __atomic_store_n(lock, 0, __ATOMIC_RELEASE);
+  return 0;
 }
 
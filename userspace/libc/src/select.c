@@ -0,0 +1,68 @@
+#include "sys/select.h"
+#include "poll.h"
+#include "stdlib.h"
+
+int select(int nfds, fd_set *readfds, fd_set *writefds, fd_set *exceptfds, struct timeval *timeout)
+{
+  if (nfds < 0 || nfds > FD_SETSIZE)
+    return -1;
+
+  struct pollfd *fds = malloc((nfds ? nfds : 1) * sizeof(struct pollfd));
+  if (!fds)
+    return -1;
+
+  // one pollfd per fd that is in any of the sets
+  nfds_t num_fds = 0;
+  for (int fd = 0; fd < nfds; ++fd)
+  {
+    short events = 0;
+    if (readfds && FD_ISSET(fd, readfds))
+      events |= POLLIN;
+    if (writefds && FD_ISSET(fd, writefds))
+      events |= POLLOUT;
+    if (!events && !(exceptfds && FD_ISSET(fd, exceptfds)))
+      continue;
+    fds[num_fds].fd = fd;
+    fds[num_fds].events = events;
+    fds[num_fds].revents = 0;
+    ++num_fds;
+  }
+
+  int timeout_ms = timeout ? (int)(timeout->tv_sec * 1000 + timeout->tv_usec / 1000) : -1;
+  int result = poll(fds, num_fds, timeout_ms);
+  if (result < 0)
+  {
+    free(fds);
+    return -1;
+  }
+
+  if (readfds)
+    FD_ZERO(readfds);
+  if (writefds)
+    FD_ZERO(writefds);
+  if (exceptfds)
+    FD_ZERO(exceptfds);
+
+  int num_ready = 0;
+  for (nfds_t i = 0; i < num_fds; ++i)
+  {
+    if (fds[i].revents & POLLNVAL)
+    {
+      free(fds);
+      return -1;
+    }
+    // the end of file and a closed reader count as ready, a read or write returns right away
+    if (readfds && (fds[i].events & POLLIN) && (fds[i].revents & (POLLIN | POLLHUP | POLLERR)))
+    {
+      FD_SET(fds[i].fd, readfds);
+      ++num_ready;
+    }
+    if (writefds && (fds[i].events & POLLOUT) && (fds[i].revents & (POLLOUT | POLLERR)))
+    {
+      FD_SET(fds[i].fd, writefds);
+      ++num_ready;
+    }
+  }
+  free(fds);
+  return num_ready;
+}
@@ -1,4 +1,5 @@
 #include "semaphore.h"
+#include "sys/futex.h"
 
 
 /**
@@ -7,7 +8,13 @@
  */
 int sem_wait(sem_t *sem)
 {
-  return -1;
+  if (sem_trywait(sem) == 0)
+    return 0;
+  __atomic_fetch_add(&sem->waiters, 1, __ATOMIC_SEQ_CST);
+  while (sem_trywait(sem) != 0)
+    futex(&sem->value, FUTEX_WAIT, 0, 0, 0);
+  __atomic_fetch_sub(&sem->waiters, 1, __ATOMIC_SEQ_CST);
+  return 0;
 }
 
 /**
@@ -16,6 +23,12 @@ int sem_wait(sem_t *sem)
  */
 int sem_trywait(sem_t *sem)
 {
+  unsigned int value = __atomic_load_n(&sem->value, __ATOMIC_SEQ_CST);
+  while (value > 0)
+  {
+    if (__atomic_compare_exchange_n(&sem->value, &value, value - 1, 0, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST))
+      return 0;
+  }
   return -1;
 }
 
@@ -25,7 +38,11 @@ int sem_trywait(sem_t *sem)
  */
 int sem_init(sem_t *sem, int pshared, unsigned value)
 {
-  return -1;
+  // futexes are keyed by address space and virtual address and there is no shared memory,
+  // so a pshared semaphore is only shared by the threads of one process
+  sem->value = value;
+  sem->waiters = 0;
+  return 0;
 }
 
 /**
@@ -34,7 +51,7 @@ int sem_init(sem_t *sem, int pshared, unsigned value)
  */
 int sem_destroy(sem_t *sem)
 {
-  return -1;
+  return __atomic_load_n(&sem->waiters, __ATOMIC_SEQ_CST) ? -1 : 0;
 }
 
 /**
@@ -43,7 +60,10 @@ int sem_destroy(sem_t *sem)
  */
 int sem_post(sem_t *sem)
 {
-  return -1;
+  __atomic_fetch_add(&sem->value, 1, __ATOMIC_SEQ_CST);
+  if (__atomic_load_n(&sem->waiters, __ATOMIC_SEQ_CST))
+    futex(&sem->value, FUTEX_WAKE, 1, 0, 0);
+  return 0;
 }
 
 
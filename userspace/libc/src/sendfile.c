@@ -0,0 +1,16 @@
+#include "sys/sendfile.h"
+#include "fcntl.h"
+#include "sys/syscall.h"
+#include "../../../common/include/kernel/syscall-definitions.h"
+
+ssize_t sendfile(int out_fd, int in_fd, off_t *offset, size_t count)
+{
+  return __syscall(sc_sendfile, (size_t)out_fd, (size_t)in_fd, (size_t)offset, count, 0x00);
+}
+
+ssize_t copy_file_range(int fd_in, off_t *off_in, int fd_out, off_t *off_out, size_t len, unsigned int flags)
+{
+  if (flags)
+    return -1;
+  return __syscall(sc_copy_file_range, (size_t)fd_in, (size_t)off_in, (size_t)fd_out, (size_t)off_out, len);
+}
@@ -0,0 +1,63 @@
+#include "sys/socket.h"
+#include "sys/syscall.h"
+#include "stdlib.h"
+#include "../../../common/include/kernel/syscall-definitions.h"
+
+/**
+ * @return the \0 terminated name of a unix domain socket address, NULL if it is none
+ */
+static const char *socketName(const struct sockaddr *addr, socklen_t addrlen)
+{
+  const struct sockaddr_un *unix_addr = (const struct sockaddr_un *)addr;
+  if (!addr || addrlen < sizeof(sa_family_t) + 1 || addrlen > sizeof(struct sockaddr_un) ||
+      unix_addr->sun_family != AF_UNIX)
+    return NULL;
+  return unix_addr->sun_path;
+}
+
+int socket(int domain, int type, int protocol)
+{
+  return __syscall(sc_socket, (size_t)domain, (size_t)type, (size_t)protocol, 0x00, 0x00);
+}
+
+int bind(int sockfd, const struct sockaddr *addr, socklen_t addrlen)
+{
+  const char *name = socketName(addr, addrlen);
+  if (!name)
+    return -1;
+  return __syscall(sc_bind, (size_t)sockfd, (size_t)name, 0x00, 0x00, 0x00);
+}
+
+int listen(int sockfd, int backlog)
+{
+  return __syscall(sc_listen, (size_t)sockfd, (size_t)(backlog > 0 ? backlog : 1), 0x00, 0x00, 0x00);
+}
+
+int accept(int sockfd, struct sockaddr *addr, socklen_t *addrlen)
+{
+  int fd = __syscall(sc_accept, (size_t)sockfd, 0x00, 0x00, 0x00, 0x00);
+  if (fd >= 0 && addr && addrlen && *addrlen >= sizeof(sa_family_t))
+  {
+    addr->sa_family = AF_UNIX;
+    *addrlen = sizeof(sa_family_t);
+  }
+  return fd;
+}
+
+int connect(int sockfd, const struct sockaddr *addr, socklen_t addrlen)
+{
+  const char *name = socketName(addr, addrlen);
+  if (!name)
+    return -1;
+  return __syscall(sc_connect, (size_t)sockfd, (size_t)name, 0x00, 0x00, 0x00);
+}
+
+ssize_t send(int sockfd, const void *buf, size_t len, int flags)
+{
+  return __syscall(sc_send, (size_t)sockfd, (size_t)buf, len, (size_t)flags, 0x00);
+}
+
+ssize_t recv(int sockfd, void *buf, size_t len, int flags)
+{
+  return __syscall(sc_recv, (size_t)sockfd, (size_t)buf, len, (size_t)flags, 0x00);
+}
@@ -0,0 +1,16 @@
+#include "fcntl.h"
+#include "sys/syscall.h"
+#include "../../../common/include/kernel/syscall-definitions.h"
+
+ssize_t splice(int fd_in, off_t *off_in, int fd_out, off_t *off_out, size_t len, unsigned int flags)
+{
+  // the kernel always uses the file offsets
+  if (off_in || off_out)
+    return -1;
+  return __syscall(sc_splice, (size_t)fd_in, (size_t)fd_out, len, (size_t)flags, 0x00);
+}
+
+ssize_t vmsplice(int fd, const struct iovec *iov, unsigned long nr_segs, unsigned int flags)
+{
+  return __syscall(sc_vmsplice, (size_t)fd, (size_t)iov, (size_t)nr_segs, (size_t)flags, 0x00);
+}
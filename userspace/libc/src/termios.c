@@ -0,0 +1,20 @@
+#include "termios.h"
+#include "sys/syscall.h"
+#include "../../../common/include/kernel/syscall-definitions.h"
+
+int tcgetattr(int fd, struct termios *termios_p)
+{
+  return __syscall(sc_tcgetattr, (size_t)fd, (size_t)termios_p, 0x00, 0x00, 0x00);
+}
+
+int tcsetattr(int fd, int optional_actions, const struct termios *termios_p)
+{
+  return __syscall(sc_tcsetattr, (size_t)fd, (size_t)optional_actions, (size_t)termios_p, 0x00, 0x00);
+}
+
+void cfmakeraw(struct termios *termios_p)
+{
+  termios_p->c_lflag &= ~(ICANON | ECHO);
+  termios_p->c_cc[VMIN] = 1;
+  termios_p->c_cc[VTIME] = 0;
+}
@@ -1,13 +1,44 @@
 #include "time.h"
 #include "sys/syscall.h"
+#include "sys/vdso.h"
 #include "../../../common/include/kernel/syscall-definitions.h"
 
 
 /**
- * function stub
  * posix compatible signature - do not change the signature!
+ * reads the vdso process page, no kernel entry needed
  */
 clock_t clock(void)
 {
+#if VDSO_AVAILABLE
+  return __vdso_process_cputime_ns() / (1000000000UL / CLOCKS_PER_SEC);
+#else
   return __syscall(sc_clock, 0x00, 0x00, 0x00, 0x00, 0x00);
+#endif
+}
+
+/**
+ * posix compatible signature - do not change the signature!
+ * CLOCK_MONOTONIC and CLOCK_PROCESS_CPUTIME_ID are served from the vdso pages
+ */
+int clock_gettime(clockid_t clock_id, struct timespec *tp)
+{
+#if VDSO_AVAILABLE
+  if (tp && (clock_id == CLOCK_MONOTONIC || clock_id == CLOCK_PROCESS_CPUTIME_ID))
+  {
+    unsigned long ns = clock_id == CLOCK_MONOTONIC ? __vdso_monotonic_ns() : __vdso_process_cputime_ns();
+    tp->tv_sec = ns / 1000000000UL;
+    tp->tv_nsec = ns % 1000000000UL;
+    return 0;
+  }
+#endif
+  return __syscall(sc_clock_gettime, (size_t)clock_id, (size_t)tp, 0x00, 0x00, 0x00);
+}
+
+/**
+ * posix compatible signature - do not change the signature!
+ */
+int nanosleep(const struct timespec *req, struct timespec *rem)
+{
+  return __syscall(sc_nanosleep, (size_t)req, (size_t)rem, 0x00, 0x00, 0x00);
 }
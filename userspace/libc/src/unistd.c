@@ -1,5 +1,6 @@
 #include "unistd.h"
 #include "sys/syscall.h"
+#include "sys/vdso.h"
 #include "../../../common/include/kernel/syscall-definitions.h"
 
 
@@ -32,6 +33,15 @@ unsigned int sleep(unsigned int seconds)
 }
 
 
+/**
+ * posix compatible signature - do not change the signature!
+ */
+int nice(int increment)
+{
+  return __syscall(sc_nice, (size_t)increment, 0x00, 0x00, 0x00, 0x00);
+}
+
+
 /**
  * function stub
  * posix compatible signature - do not change the signature!
@@ -40,3 +50,17 @@ int ftruncate(int fildes, off_t length)
 {
     return -1;
 }
+
+
+/**
+ * posix compatible signature - do not change the signature!
+ * reads the vdso process page, no kernel entry needed
+ */
+pid_t getpid(void)
+{
+#if VDSO_AVAILABLE
+  return __vdso_process_data->pid;
+#else
+  return __syscall(sc_getpid, 0x00, 0x00, 0x00, 0x00, 0x00);
+#endif
+}
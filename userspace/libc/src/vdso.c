@@ -0,0 +1,54 @@
+#include "sys/vdso.h"
+
+#if VDSO_AVAILABLE
+
+static inline unsigned long readCycles(void)
+{
+  unsigned int low, high;
+  asm volatile("rdtsc" : "=a"(low), "=d"(high));
+  return ((unsigned long)high << 32) | low;
+}
+
+// there is only one cpu, so the kernel can never be in the middle of an update while
+// we run; the seqlock still keeps the readers correct should that ever change
+static inline unsigned long readBegin(const volatile unsigned long* seq)
+{
+  unsigned long start;
+  while ((start = *seq) & 1)
+    ;
+  asm volatile("" ::: "memory");
+  return start;
+}
+
+static inline int readRetry(const volatile unsigned long* seq, unsigned long start)
+{
+  asm volatile("" ::: "memory");
+  return *seq != start;
+}
+
+static inline unsigned long cyclesToNs(unsigned long cycles)
+{
+  return (unsigned long)(((unsigned __int128)cycles * __vdso_time_data->tsc_mult) >> __vdso_time_data->tsc_shift);
+}
+
+unsigned long __vdso_monotonic_ns(void)
+{
+  return cyclesToNs(readCycles() - __vdso_time_data->boot_cycles);
+}
+
+unsigned long __vdso_process_cputime_ns(void)
+{
+  unsigned long seq, cycles, running_since;
+  do
+  {
+    seq = readBegin(&__vdso_process_data->seq);
+    cycles = __vdso_process_data->cpu_cycles;
+    running_since = __vdso_process_data->running_since;
+  } while (readRetry(&__vdso_process_data->seq, seq));
+
+  if (running_since)
+    cycles += readCycles() - running_since;
+  return cyclesToNs(cycles);
+}
+
+#endif
@@ -0,0 +1,51 @@
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <assert.h>
+
+// fds are handed out lowest first, dup'ed fds share the open file, the pipe reaches its
+// end of file only when every fd of the write end is closed
+int main()
+{
+  int fd[2];
+  char buffer[16];
+
+  assert(pipe(fd) == 0);
+  assert(fd[0] == 3 && fd[1] == 4); // 0, 1 and 2 are the terminal
+
+  int copy = dup(fd[1]);
+  assert(copy == 5);
+  assert(write(copy, "abc", 3) == 3);
+  assert(close(fd[1]) == 0);
+  assert(write(copy, "def", 3) == 3);
+  assert(close(copy) == 0);
+  assert(read(fd[0], buffer, sizeof(buffer)) == 6);
+  assert(memcmp(buffer, "abcdef", 6) == 0);
+  assert(read(fd[0], buffer, sizeof(buffer)) == 0);
+
+  // the lowest free fd is reused
+  assert(dup(fd[0]) == 4);
+  assert(close(4) == 0);
+  assert(close(fd[0]) == 0);
+
+  // redirect stdout into a pipe and back
+  assert(pipe(fd) == 0);
+  int saved_stdout = dup(1);
+  assert(saved_stdout != -1);
+  assert(dup2(fd[1], 1) == 1);
+  assert(write(1, "redirected", 10) == 10);
+  assert(dup2(saved_stdout, 1) == 1);
+  assert(close(saved_stdout) == 0);
+  assert(close(fd[1]) == 0);
+  assert(read(fd[0], buffer, sizeof(buffer)) == 10);
+  assert(memcmp(buffer, "redirected", 10) == 0);
+  assert(close(fd[0]) == 0);
+
+  assert(dup(42) == -1);
+  assert(dup2(42, 5) == -1);
+  assert(dup2(1, 1) == 1);
+  assert(close(42) == -1);
+
+  printf("dup1: done\n");
+  return 0;
+}
@@ -0,0 +1,34 @@
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <wait.h>
+#include <assert.h>
+
+// parent and child share the open file and with it the file offset,
+// so the child's write goes after the parent's and the parent's next write after the child's
+int main()
+{
+  char buffer[32];
+  int fd = open("fork4.txt", O_CREAT | O_RDWR);
+  assert(fd != -1);
+  assert(write(fd, "parent,", 7) == 7);
+
+  pid_t child = fork();
+  if (child == 0)
+  {
+    assert(write(fd, "child,", 6) == 6);
+    return 0;
+  }
+  assert(child > 0);
+  assert(waitpid(child, NULL, 0) == child);
+
+  assert(write(fd, "parent", 6) == 6);
+  assert(lseek(fd, 0, SEEK_SET) == 0);
+  assert(read(fd, buffer, sizeof(buffer)) == 19);
+  assert(memcmp(buffer, "parent,child,parent", 19) == 0);
+  assert(close(fd) == 0);
+
+  printf("fork4: done\n");
+  return 0;
+}
@@ -0,0 +1,65 @@
+#include <stdio.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <wait.h>
+#include <assert.h>
+
+#define NUM_THREADS 4
+#define NUM_ITERATIONS 200000
+
+static double work(double factor, int yield)
+{
+  double sum = 0.0;
+  for (size_t i = 0; i < NUM_ITERATIONS; i++)
+  {
+    sum += factor * (double)i;
+    if (yield && (i % 1000) == 0)
+      sched_yield();
+  }
+  return sum;
+}
+
+static double expected[NUM_THREADS];
+static double results[NUM_THREADS];
+
+static void* worker(void* arg)
+{
+  size_t index = (size_t)arg;
+  results[index] = work(0.25 * (index + 1), 1);
+  return 0;
+}
+
+// several threads and processes keep floating point state in sse registers across
+// yields, with lazy FPU switching every one of them has to see its own registers
+int main()
+{
+  for (size_t i = 0; i < NUM_THREADS; i++)
+    expected[i] = work(0.25 * (i + 1), 0);
+
+  double parent_value = 1.5;
+  pid_t child = fork();
+  // the child inherits the FPU state of the parent
+  assert(parent_value * 2.0 == 3.0);
+
+  pthread_t threads[NUM_THREADS];
+  for (size_t i = 0; i < NUM_THREADS; i++)
+    assert(pthread_create(&threads[i], 0, worker, (void*)i) == 0);
+  for (size_t i = 0; i < NUM_THREADS; i++)
+    assert(pthread_join(threads[i], 0) == 0);
+
+  for (size_t i = 0; i < NUM_THREADS; i++)
+  {
+    if (results[i] != expected[i])
+    {
+      printf("fpu1: %s thread %zu got a wrong result\n", child ? "parent" : "child", i);
+      return -1;
+    }
+  }
+
+  if (child == 0)
+    return 0;
+  waitpid(child, NULL, 0);
+  printf("fpu1: all floating point results are correct\n");
+  return 0;
+}
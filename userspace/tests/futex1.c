@@ -0,0 +1,98 @@
+#include <stdio.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sched.h>
+#include <time.h>
+#include <assert.h>
+
+#define MAX_THREADS 64
+#define NUM_INCREMENTS 20000
+
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t cond = PTHREAD_COND_INITIALIZER;
+static sem_t sem;
+static size_t counter;
+static size_t ready;
+
+static unsigned long nowNs()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000UL + ts.tv_nsec;
+}
+
+static void* incrementer(void* arg)
+{
+  for (size_t i = 0; i < NUM_INCREMENTS; i++)
+  {
+    pthread_mutex_lock(&mutex);
+    counter++;
+    pthread_mutex_unlock(&mutex);
+  }
+  return 0;
+}
+
+static void* condWaiter(void* arg)
+{
+  pthread_mutex_lock(&mutex);
+  ready++;
+  while (counter == 0)
+    pthread_cond_wait(&cond, &mutex);
+  pthread_mutex_unlock(&mutex);
+  sem_post(&sem);
+  return 0;
+}
+
+// mutex contention with 2-64 threads, then condition broadcast and semaphores
+int main()
+{
+  pthread_t threads[MAX_THREADS];
+
+  unsigned long start = nowNs();
+  for (size_t i = 0; i < NUM_INCREMENTS; i++)
+  {
+    pthread_mutex_lock(&mutex);
+    counter++;
+    pthread_mutex_unlock(&mutex);
+  }
+  printf("uncontended lock/unlock: %lu ns\n", (nowNs() - start) / NUM_INCREMENTS);
+
+  for (size_t num_threads = 2; num_threads <= MAX_THREADS; num_threads *= 2)
+  {
+    counter = 0;
+    start = nowNs();
+    for (size_t i = 0; i < num_threads; i++)
+      assert(pthread_create(&threads[i], 0, incrementer, 0) == 0);
+    for (size_t i = 0; i < num_threads; i++)
+      assert(pthread_join(threads[i], 0) == 0);
+    unsigned long elapsed = nowNs() - start;
+    assert(counter == num_threads * NUM_INCREMENTS);
+    printf("%2zu threads: %lu ns per lock/unlock\n", num_threads, elapsed / (num_threads * NUM_INCREMENTS));
+  }
+
+  // all waiters are woken by one broadcast and report back through the semaphore
+  counter = 0;
+  ready = 0;
+  assert(sem_init(&sem, 0, 0) == 0);
+  for (size_t i = 0; i < 8; i++)
+    assert(pthread_create(&threads[i], 0, condWaiter, 0) == 0);
+  pthread_mutex_lock(&mutex);
+  while (ready < 8)
+  {
+    pthread_mutex_unlock(&mutex);
+    sched_yield();
+    pthread_mutex_lock(&mutex);
+  }
+  counter = 1;
+  pthread_cond_broadcast(&cond);
+  pthread_mutex_unlock(&mutex);
+  for (size_t i = 0; i < 8; i++)
+    assert(sem_wait(&sem) == 0);
+  for (size_t i = 0; i < 8; i++)
+    assert(pthread_join(threads[i], 0) == 0);
+  assert(sem_trywait(&sem) == -1);
+  assert(sem_destroy(&sem) == 0);
+
+  printf("futex1: done\n");
+  return 0;
+}
@@ -0,0 +1,107 @@
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/io_ring.h>
+#include <assert.h>
+
+#define ENTRIES 512
+#define WRITES 256
+#define CHUNK 16
+#define BENCH_OPS 4096
+#define BENCH_BATCH 128
+
+static char data[WRITES * CHUNK];
+static char buffer[WRITES * CHUNK];
+
+static unsigned long nowNs()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000UL + ts.tv_nsec;
+}
+
+// runs one operation through the ring and returns its result
+static long runOne(struct io_ring* ring, unsigned int opcode, int fd, unsigned long addr, unsigned long len)
+{
+  assert(io_ring_prep(ring, opcode, fd, addr, len, opcode));
+  assert(io_ring_submit(ring) == 1);
+  struct io_ring_cqe* cqe = io_ring_peek_cqe(ring);
+  assert(cqe && cqe->user_data == opcode);
+  long res = cqe->res;
+  io_ring_cqe_seen(ring);
+  return res;
+}
+
+// batched file and pipe i/o through the submission ring, compared to one syscall per operation
+int main()
+{
+  struct io_ring ring;
+  assert(io_ring_init(&ring, ENTRIES) == 0);
+  for (size_t i = 0; i < sizeof(data); ++i)
+    data[i] = 'a' + i % 26;
+
+  // WRITES writes, an fsync and a close in one kernel entry
+  int fd = runOne(&ring, IO_RING_OP_OPEN, -1, (unsigned long)"ioring1.txt", O_CREAT | O_RDWR);
+  assert(fd >= 0);
+  for (unsigned long i = 0; i < WRITES; ++i)
+    assert(io_ring_prep(&ring, IO_RING_OP_WRITE, fd, (unsigned long)(data + i * CHUNK), CHUNK, i));
+  assert(io_ring_prep(&ring, IO_RING_OP_FSYNC, fd, 0, 0, WRITES));
+  assert(io_ring_prep(&ring, IO_RING_OP_CLOSE, fd, 0, 0, WRITES + 1));
+  assert(io_ring_submit(&ring) == WRITES + 2);
+  for (unsigned long i = 0; i < WRITES + 2; ++i)
+  {
+    struct io_ring_cqe* cqe = io_ring_peek_cqe(&ring);
+    assert(cqe && cqe->user_data == i);
+    assert(cqe->res == (i < WRITES ? CHUNK : 0));
+    io_ring_cqe_seen(&ring);
+  }
+  assert(!io_ring_peek_cqe(&ring));
+
+  fd = open("ioring1.txt", O_RDONLY);
+  assert(fd >= 0);
+  assert(runOne(&ring, IO_RING_OP_READ, fd, (unsigned long)buffer, sizeof(buffer)) == sizeof(buffer));
+  assert(memcmp(buffer, data, sizeof(data)) == 0);
+  assert(runOne(&ring, IO_RING_OP_CLOSE, fd, 0, 0) == 0);
+  // errors end up in the completion
+  assert(runOne(&ring, IO_RING_OP_CLOSE, fd, 0, 0) == -1);
+  assert(runOne(&ring, 1234, fd, 0, 0) == -1);
+
+  // a write and the matching read of a pipe, the entries are executed in order
+  int pipe_fd[2];
+  assert(pipe(pipe_fd) == 0);
+  unsigned long start = nowNs();
+  for (int i = 0; i < BENCH_OPS; ++i)
+  {
+    assert(write(pipe_fd[1], data, CHUNK) == CHUNK);
+    assert(read(pipe_fd[0], buffer, CHUNK) == CHUNK);
+  }
+  unsigned long syscall_ns = nowNs() - start;
+
+  start = nowNs();
+  for (int i = 0; i < BENCH_OPS; i += BENCH_BATCH / 2)
+  {
+    for (int j = 0; j < BENCH_BATCH / 2; ++j)
+    {
+      assert(io_ring_prep(&ring, IO_RING_OP_WRITE, pipe_fd[1], (unsigned long)data, CHUNK, 0));
+      assert(io_ring_prep(&ring, IO_RING_OP_READ, pipe_fd[0], (unsigned long)buffer, CHUNK, 0));
+    }
+    assert(io_ring_submit(&ring) == BENCH_BATCH);
+    struct io_ring_cqe* cqe;
+    while ((cqe = io_ring_peek_cqe(&ring)))
+    {
+      assert(cqe->res == CHUNK);
+      io_ring_cqe_seen(&ring);
+    }
+  }
+  unsigned long ring_ns = nowNs() - start;
+  close(pipe_fd[0]);
+  close(pipe_fd[1]);
+  io_ring_free(&ring);
+
+  printf("%d pipe write+read pairs: %lu us with syscalls, %lu us with the ring (%d per submit)\n",
+         BENCH_OPS, syscall_ns / 1000, ring_ns / 1000, BENCH_BATCH);
+  printf("ioring1: done\n");
+  return 0;
+}
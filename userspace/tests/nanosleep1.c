@@ -0,0 +1,36 @@
+#include <stdio.h>
+#include <time.h>
+#include <assert.h>
+
+static long long elapsedNs(struct timespec* start, struct timespec* end)
+{
+  return (end->tv_sec - start->tv_sec) * 1000000000LL + (end->tv_nsec - start->tv_nsec);
+}
+
+// sleeps for a few durations below and above one timer tick and reports
+// how late the wakeup was according to CLOCK_MONOTONIC
+int main()
+{
+  long durations[] = { 100000, 500000, 1000000, 10000000, 100000000, 250000000 };
+  struct timespec start, end;
+
+  for (size_t i = 0; i < sizeof(durations) / sizeof(durations[0]); i++)
+  {
+    struct timespec req = { 0, durations[i] };
+    assert(clock_gettime(CLOCK_MONOTONIC, &start) == 0);
+    assert(nanosleep(&req, NULL) == 0);
+    assert(clock_gettime(CLOCK_MONOTONIC, &end) == 0);
+
+    long long slept = elapsedNs(&start, &end);
+    assert(slept >= durations[i]);
+    printf("nanosleep(%ld ns) took %lld ns, %lld ns late\n", durations[i], slept, slept - durations[i]);
+  }
+
+  struct timespec invalid = { 0, 1000000000 };
+  assert(nanosleep(&invalid, NULL) == -1);
+  assert(clock_gettime(CLOCK_REALTIME, &start) == -1);
+
+  assert(clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &end) == 0);
+  printf("process cpu time: %ld.%09ld s\n", end.tv_sec, end.tv_nsec);
+  return 0;
+}
@@ -0,0 +1,102 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <wait.h>
+#include <time.h>
+#include <pthread.h>
+#include <assert.h>
+
+#define WINDOW_MS 1000UL
+#define PARKED_THREADS 8
+
+static unsigned long nowMs()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000UL + ts.tv_nsec / 1000000UL;
+}
+
+// spins for WINDOW_MS of wall time and returns the cpu time the process got meanwhile
+static clock_t spin()
+{
+  clock_t start = clock();
+  unsigned long end = nowMs() + WINDOW_MS;
+  while (nowMs() < end)
+  {
+  }
+  return clock() - start;
+}
+
+static int park_fd[2];
+
+static void* parked(void* arg)
+{
+  char c;
+  read(park_fd[0], &c, 1);
+  return arg;
+}
+
+// runs child_work in a child process and spin in the parent at the same time
+// returns the cpu time of the parent, the child's is stored in child_cpu
+static clock_t race(void (*child_work)(int), clock_t* child_cpu)
+{
+  int result_fd[2];
+  assert(pipe(result_fd) == 0);
+  int pid = fork();
+  assert(pid >= 0);
+  if (pid == 0)
+  {
+    close(result_fd[0]);
+    child_work(result_fd[1]);
+    exit(0);
+  }
+  close(result_fd[1]);
+  clock_t parent_cpu = spin();
+  assert(read(result_fd[0], child_cpu, sizeof(*child_cpu)) == sizeof(*child_cpu));
+  close(result_fd[0]);
+  waitpid(pid, NULL, 0);
+  return parent_cpu;
+}
+
+static void nicedSpin(int result_fd)
+{
+  assert(nice(10) == 10);
+  clock_t cpu = spin();
+  write(result_fd, &cpu, sizeof(cpu));
+}
+
+// one busy thread and several blocked ones
+static void spinWithParkedThreads(int result_fd)
+{
+  pthread_t threads[PARKED_THREADS];
+  assert(pipe(park_fd) == 0);
+  for (int i = 0; i < PARKED_THREADS; i++)
+    assert(pthread_create(&threads[i], NULL, parked, NULL) == 0);
+  clock_t cpu = spin();
+  write(result_fd, &cpu, sizeof(cpu));
+
+  char release[PARKED_THREADS] = {0};
+  write(park_fd[1], release, sizeof(release));
+  for (int i = 0; i < PARKED_THREADS; i++)
+    pthread_join(threads[i], NULL);
+}
+
+// cpu shares under the fair-share scheduling policy: a niced process gets clearly less,
+// blocked threads do not shrink the share of the busy thread of their process
+int main()
+{
+  clock_t child_cpu;
+  clock_t parent_cpu = race(nicedSpin, &child_cpu);
+  printf("nice 0: %u us, nice 10: %u us of cpu time\n", (unsigned int)parent_cpu, (unsigned int)child_cpu);
+  // the weights differ by a factor of about 9
+  assert(parent_cpu > 3 * child_cpu);
+
+  parent_cpu = race(spinWithParkedThreads, &child_cpu);
+  printf("single thread: %u us, busy thread next to %d blocked ones: %u us of cpu time\n",
+         (unsigned int)parent_cpu, PARKED_THREADS, (unsigned int)child_cpu);
+  // both compete with one runnable thread, so they get about the same
+  assert(child_cpu * 2 > parent_cpu && parent_cpu * 2 > child_cpu);
+
+  printf("nice1: done\n");
+  return 0;
+}
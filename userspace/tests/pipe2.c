@@ -50,7 +50,6 @@ int main()
         char p[1026];
         printf("PARENT TRIES TO WOVERFLOW %ld\n", write(fd[1], &p, 1026));
         printf("PARENT TRIES TO READ %ld\n", read(fd[0], &p, 1026));
-        printf("PARENT TRIES TO READ(empty) %ld\n", read(fd[0], &p, 1026));
         printf("---------------Some R/W----------\n");
         int too_much = 2000;
         printf("PARENT TRIES TO W OVERFLOW(%d): %ld\n", too_much, write(fd[1], &p, too_much));
@@ -58,5 +57,9 @@ int main()
         printf("PARENT TRIES TO W OVERFLOW(%d): %ld\n", too_much, write(fd[1], &p, too_much));
         printf("PARENT TRIES TO R TOO MUCH(%d): %ld\n", too_much, read(fd[0], &p, too_much));
         printf("PARENT TRIES TO W OVERFLOW(%d): %ld\n", too_much, write(fd[1], &p, too_much));
+        close(fd[1]);
+        printf("PARENT READS THE REST %ld\n", read(fd[0], &p, too_much));
+        // reading from an empty pipe blocks as long as there is a writer, without one it is the end of file
+        printf("PARENT TRIES TO READ(empty, no writer) %ld\n", read(fd[0], &p, 1026));
     }
 }
@@ -0,0 +1,55 @@
+#include <stdio.h>
+#include <unistd.h>
+#include <wait.h>
+#include <time.h>
+#include <assert.h>
+
+#define TOTAL_BYTES (8 * 1024 * 1024)
+#define MAX_CHUNK (64 * 1024)
+
+static char buffer[MAX_CHUNK];
+
+static unsigned long nowNs()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000UL + ts.tv_nsec;
+}
+
+// pipe throughput: a child writes TOTAL_BYTES into the pipe, the parent reads until end of file
+int main()
+{
+  for (size_t chunk = 64; chunk <= MAX_CHUNK; chunk *= 4)
+  {
+    int fd[2];
+    assert(pipe(fd) == 0);
+
+    pid_t child = fork();
+    if (child == 0)
+    {
+      close(fd[0]);
+      for (size_t sent = 0; sent < TOTAL_BYTES; sent += chunk)
+        assert(write(fd[1], buffer, chunk) == (ssize_t)chunk);
+      close(fd[1]);
+      return 0;
+    }
+    assert(child > 0);
+    close(fd[1]);
+
+    unsigned long start = nowNs();
+    size_t received = 0;
+    ssize_t num_read;
+    while ((num_read = read(fd[0], buffer, MAX_CHUNK)) > 0)
+      received += num_read;
+    unsigned long elapsed = nowNs() - start;
+
+    assert(num_read == 0);
+    assert(received == TOTAL_BYTES);
+    close(fd[0]);
+    assert(waitpid(child, NULL, 0) == child);
+
+    printf("%6zu byte writes: %lu MB/s\n", chunk, (TOTAL_BYTES * 1000UL) / (elapsed ? elapsed : 1));
+  }
+  printf("pipe3: done\n");
+  return 0;
+}
@@ -0,0 +1,70 @@
+#include <stdio.h>
+#include <unistd.h>
+#include <wait.h>
+#include <time.h>
+#include <poll.h>
+#include <sys/select.h>
+#include <assert.h>
+
+static unsigned long nowMs()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000UL + ts.tv_nsec / 1000000UL;
+}
+
+// poll and select on pipes: timeouts, a wakeup by a write of another process, end of file, invalid fds
+int main()
+{
+  int fd[2];
+  char c;
+  assert(pipe(fd) == 0);
+
+  // an empty pipe is writable but not readable
+  struct pollfd fds[2] = {{fd[0], POLLIN, 0}, {fd[1], POLLOUT, 0}};
+  assert(poll(fds, 2, 0) == 1);
+  assert(fds[0].revents == 0 && fds[1].revents == POLLOUT);
+
+  // nothing happens, the timeout elapses
+  unsigned long start = nowMs();
+  assert(poll(fds, 1, 100) == 0);
+  assert(nowMs() - start >= 100);
+
+  // the child's write wakes up the parent
+  pid_t child = fork();
+  if (child == 0)
+  {
+    sleep(1);
+    assert(write(fd[1], "x", 1) == 1);
+    return 0;
+  }
+  assert(child > 0);
+  assert(poll(fds, 1, -1) == 1);
+  assert(fds[0].revents == POLLIN);
+  assert(read(fd[0], &c, 1) == 1 && c == 'x');
+  assert(waitpid(child, NULL, 0) == child);
+
+  // select sees the same
+  fd_set readfds, writefds;
+  FD_ZERO(&readfds);
+  FD_ZERO(&writefds);
+  FD_SET(fd[0], &readfds);
+  FD_SET(fd[1], &writefds);
+  struct timeval timeout = {0, 0};
+  assert(select(fd[1] + 1, &readfds, &writefds, NULL, &timeout) == 1);
+  assert(!FD_ISSET(fd[0], &readfds) && FD_ISSET(fd[1], &writefds));
+
+  // without writers the read end reports the end of file
+  assert(close(fd[1]) == 0);
+  assert(poll(fds, 1, -1) == 1);
+  assert(fds[0].revents == (POLLIN | POLLHUP));
+
+  // closed fds are reported, negative ones ignored
+  struct pollfd invalid[2] = {{fd[1], POLLIN, 0}, {-1, POLLIN, 0}};
+  assert(poll(invalid, 2, 0) == 1);
+  assert(invalid[0].revents == POLLNVAL && invalid[1].revents == 0);
+  assert(close(fd[0]) == 0);
+
+  printf("poll1: done\n");
+  return 0;
+}
@@ -0,0 +1,62 @@
+#include <stdio.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <time.h>
+#include <assert.h>
+
+#define MAX_THREADS 16
+#define NUM_ITERATIONS 500
+#define FILE_NAME "rwlock1.txt"
+
+static const char data[] = "read-mostly kernel tables";
+
+static unsigned long nowNs()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000UL + ts.tv_nsec;
+}
+
+// every iteration walks the path, looks up the fd twice and closes it again
+static void* openReadClose(void* arg)
+{
+  char buffer[sizeof(data)];
+  for (size_t i = 0; i < NUM_ITERATIONS; i++)
+  {
+    int fd = open(FILE_NAME, O_RDONLY);
+    assert(fd >= 0);
+    assert(read(fd, buffer, sizeof(data)) == sizeof(data));
+    assert(buffer[0] == data[0]);
+    close(fd);
+  }
+  return 0;
+}
+
+// concurrent open/read/close of the same file with 1-16 threads,
+// path walks and fd lookups only hold the kernel tables for reading
+int main()
+{
+  pthread_t threads[MAX_THREADS];
+
+  int fd = open(FILE_NAME, O_CREAT);
+  assert(fd >= 0);
+  close(fd);
+  fd = open(FILE_NAME, O_WRONLY);
+  assert(fd >= 0);
+  assert(write(fd, data, sizeof(data)) == sizeof(data));
+  close(fd);
+
+  for (size_t num_threads = 1; num_threads <= MAX_THREADS; num_threads *= 2)
+  {
+    unsigned long start = nowNs();
+    for (size_t i = 0; i < num_threads; i++)
+      assert(pthread_create(&threads[i], 0, openReadClose, 0) == 0);
+    for (size_t i = 0; i < num_threads; i++)
+      assert(pthread_join(threads[i], 0) == 0);
+    unsigned long elapsed = nowNs() - start;
+    printf("%2zu threads: %lu ns per open/read/close\n", num_threads, elapsed / (num_threads * NUM_ITERATIONS));
+  }
+  printf("rwlock1: done\n");
+  return 0;
+}
@@ -0,0 +1,93 @@
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/sendfile.h>
+#include <assert.h>
+
+#define FILE_SIZE (40 * 1024)
+
+static char data[FILE_SIZE];
+static char buffer[FILE_SIZE];
+
+static unsigned long nowNs()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000UL + ts.tv_nsec;
+}
+
+static void checkFile(const char* path, size_t size, const char* expected)
+{
+  int fd = open(path, O_RDONLY);
+  assert(fd != -1);
+  assert(read(fd, buffer, sizeof(buffer)) >= (ssize_t)size);
+  assert(memcmp(buffer, expected, size) == 0);
+  close(fd);
+}
+
+// in-kernel file copies with copy_file_range and sendfile
+int main()
+{
+  for (size_t i = 0; i < FILE_SIZE; ++i)
+    data[i] = 'a' + i % 23;
+  int in = open("sendfile1.txt", O_CREAT | O_RDWR);
+  assert(in != -1);
+  assert(write(in, data, FILE_SIZE) == FILE_SIZE);
+
+  // the whole file through a user buffer, then in the kernel
+  assert(lseek(in, 0, SEEK_SET) == 0);
+  int out = open("sendfile1.copy", O_CREAT | O_WRONLY);
+  unsigned long start = nowNs();
+  ssize_t num_read;
+  while ((num_read = read(in, buffer, 4096)) > 0)
+    assert(write(out, buffer, num_read) == num_read);
+  unsigned long user_ns = nowNs() - start;
+  close(out);
+
+  assert(lseek(in, 0, SEEK_SET) == 0);
+  out = open("sendfile1.range", O_CREAT | O_WRONLY);
+  start = nowNs();
+  assert(copy_file_range(in, NULL, out, NULL, FILE_SIZE + 100, 0) == FILE_SIZE);
+  unsigned long kernel_ns = nowNs() - start;
+  // both file positions moved
+  assert(lseek(in, 0, SEEK_CUR) == FILE_SIZE);
+  assert(lseek(out, 0, SEEK_CUR) == FILE_SIZE);
+  assert(copy_file_range(in, NULL, out, NULL, 100, 0) == 0);
+  close(out);
+  checkFile("sendfile1.range", FILE_SIZE, data);
+
+  // with offsets the file positions stay
+  out = open("sendfile1.range", O_RDWR);
+  off_t in_offset = 1000;
+  off_t out_offset = 10;
+  assert(copy_file_range(in, &in_offset, out, &out_offset, 500, 0) == 500);
+  assert(in_offset == 1500 && out_offset == 510);
+  assert(lseek(in, 0, SEEK_CUR) == FILE_SIZE);
+  assert(lseek(out, 0, SEEK_CUR) == 0);
+  assert(read(out, buffer, 510) == 510);
+  assert(memcmp(buffer, data, 10) == 0 && memcmp(buffer + 10, data + 1000, 500) == 0);
+  close(out);
+
+  // overlapping ranges of one file are refused
+  in_offset = 0;
+  out_offset = 100;
+  assert(copy_file_range(in, &in_offset, in, &out_offset, 200, 0) == -1);
+
+  // sendfile into a pipe
+  int fd[2];
+  assert(pipe(fd) == 0);
+  off_t offset = 26;
+  assert(sendfile(fd[1], in, &offset, 1000) == 1000);
+  assert(offset == 1026);
+  assert(read(fd[0], buffer, sizeof(buffer)) == 1000);
+  assert(memcmp(buffer, data + 26, 1000) == 0);
+  close(fd[0]);
+  close(fd[1]);
+  close(in);
+
+  printf("%d bytes: read/write %lu us, copy_file_range %lu us\n", FILE_SIZE, user_ns / 1000, kernel_ns / 1000);
+  printf("sendfile1: done\n");
+  return 0;
+}
@@ -0,0 +1,110 @@
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <wait.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <assert.h>
+
+static struct sockaddr_un address(const char* name)
+{
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  memcpy(addr.sun_path, name, strlen(name) + 1);
+  return addr;
+}
+
+#define CLIENTS 4
+
+// unix domain sockets: a stream server serving several forked clients, end of file, poll, datagrams
+int main()
+{
+  char buffer[64];
+  struct sockaddr_un addr = address("/socket1.stream");
+
+  int server = socket(AF_UNIX, SOCK_STREAM, 0);
+  assert(server != -1);
+  assert(bind(server, (struct sockaddr*)&addr, sizeof(addr)) == 0);
+  assert(listen(server, CLIENTS) == 0);
+
+  // the name is taken now
+  int other = socket(AF_UNIX, SOCK_STREAM, 0);
+  assert(bind(other, (struct sockaddr*)&addr, sizeof(addr)) == -1);
+  close(other);
+
+  // every client sends its number, the server answers with it incremented
+  for (int i = 0; i < CLIENTS; ++i)
+  {
+    if (fork() == 0)
+    {
+      close(server);
+      int client = socket(AF_UNIX, SOCK_STREAM, 0);
+      assert(connect(client, (struct sockaddr*)&addr, sizeof(addr)) == 0);
+      assert(send(client, &i, sizeof(i), 0) == sizeof(i));
+      int answer;
+      assert(recv(client, &answer, sizeof(answer), 0) == sizeof(answer));
+      assert(answer == i + 1);
+      close(client);
+      return 0;
+    }
+  }
+  for (int i = 0; i < CLIENTS; ++i)
+  {
+    struct pollfd pfd = {server, POLLIN, 0};
+    assert(poll(&pfd, 1, -1) == 1 && pfd.revents == POLLIN);
+    int connection = accept(server, NULL, NULL);
+    assert(connection != -1);
+    int number;
+    assert(recv(connection, &number, sizeof(number), 0) == sizeof(number));
+    ++number;
+    assert(send(connection, &number, sizeof(number), 0) == sizeof(number));
+    // the client closes after the answer
+    assert(recv(connection, &number, sizeof(number), 0) == 0);
+    close(connection);
+  }
+  for (int i = 0; i < CLIENTS; ++i)
+    assert(waitpid(-1, NULL, 0) > 0);
+
+  // connecting works without accept, read and write work on sockets too
+  int client = socket(AF_UNIX, SOCK_STREAM, 0);
+  assert(connect(client, (struct sockaddr*)&addr, sizeof(addr)) == 0);
+  assert(write(client, "hello", 5) == 5);
+  int connection = accept(server, NULL, NULL);
+  struct pollfd pfd = {connection, POLLIN | POLLOUT, 0};
+  assert(poll(&pfd, 1, 0) == 1 && pfd.revents == (POLLIN | POLLOUT));
+  assert(read(connection, buffer, sizeof(buffer)) == 5);
+  assert(memcmp(buffer, "hello", 5) == 0);
+  close(client);
+  assert(poll(&pfd, 1, 0) == 1 && (pfd.revents & POLLHUP));
+  close(connection);
+
+  // a closed server frees the name
+  close(server);
+  client = socket(AF_UNIX, SOCK_STREAM, 0);
+  assert(connect(client, (struct sockaddr*)&addr, sizeof(addr)) == -1);
+  close(client);
+
+  // datagrams keep their boundaries, a too long one is truncated
+  struct sockaddr_un dgram_addr = address("/socket1.dgram");
+  int receiver = socket(AF_UNIX, SOCK_DGRAM, 0);
+  int sender = socket(AF_UNIX, SOCK_DGRAM, 0);
+  assert(bind(receiver, (struct sockaddr*)&dgram_addr, sizeof(dgram_addr)) == 0);
+  assert(connect(sender, (struct sockaddr*)&dgram_addr, sizeof(dgram_addr)) == 0);
+  assert(send(sender, "first", 5, 0) == 5);
+  assert(send(sender, "second", 6, 0) == 6);
+  assert(recv(receiver, buffer, sizeof(buffer), 0) == 5);
+  assert(memcmp(buffer, "first", 5) == 0);
+  assert(recv(receiver, buffer, 3, 0) == 3);
+  assert(memcmp(buffer, "sec", 3) == 0);
+  pfd.fd = receiver;
+  pfd.events = POLLIN;
+  assert(poll(&pfd, 1, 0) == 0);
+  close(receiver);
+  assert(send(sender, "lost", 4, 0) == -1);
+  close(sender);
+
+  printf("socket1: done\n");
+  return 0;
+}
@@ -0,0 +1,138 @@
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <wait.h>
+#include <time.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <assert.h>
+
+#define MAX_CLIENTS 8
+#define REQUESTS 1000
+#define MESSAGE_SIZE 64
+#define STREAM_BYTES (4 * 1024 * 1024)
+#define STREAM_CHUNK 4096
+
+static char buffer[STREAM_CHUNK];
+
+static unsigned long nowNs()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000UL + ts.tv_nsec;
+}
+
+static int connectTo(struct sockaddr_un* addr)
+{
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  assert(fd != -1);
+  assert(connect(fd, (struct sockaddr*)addr, sizeof(*addr)) == 0);
+  return fd;
+}
+
+// N client processes send requests, one server answers them all through poll
+static void requestResponse(struct sockaddr_un* addr, int server, int num_clients)
+{
+  for (int i = 0; i < num_clients; ++i)
+  {
+    if (fork() == 0)
+    {
+      int fd = connectTo(addr);
+      char message[MESSAGE_SIZE];
+      memset(message, 'r', sizeof(message));
+      for (int r = 0; r < REQUESTS; ++r)
+      {
+        assert(send(fd, message, sizeof(message), 0) == sizeof(message));
+        assert(recv(fd, message, sizeof(message), 0) == sizeof(message));
+      }
+      close(fd);
+      _exit(0);
+    }
+  }
+
+  struct pollfd fds[MAX_CLIENTS];
+  for (int i = 0; i < num_clients; ++i)
+  {
+    fds[i].fd = accept(server, NULL, NULL);
+    fds[i].events = POLLIN;
+    assert(fds[i].fd != -1);
+  }
+
+  unsigned long start = nowNs();
+  int open_clients = num_clients;
+  while (open_clients)
+  {
+    assert(poll(fds, num_clients, -1) > 0);
+    for (int i = 0; i < num_clients; ++i)
+    {
+      if (!fds[i].revents)
+        continue;
+      char message[MESSAGE_SIZE];
+      ssize_t num_read = recv(fds[i].fd, message, sizeof(message), 0);
+      if (num_read <= 0)
+      {
+        close(fds[i].fd);
+        fds[i].fd = -1;
+        --open_clients;
+        continue;
+      }
+      assert(num_read == sizeof(message));
+      assert(send(fds[i].fd, message, sizeof(message), 0) == sizeof(message));
+    }
+  }
+  unsigned long elapsed = nowNs() - start;
+  for (int i = 0; i < num_clients; ++i)
+    assert(waitpid(-1, NULL, 0) > 0);
+
+  unsigned long total = (unsigned long)num_clients * REQUESTS;
+  printf("%d clients: %lu requests/s, %lu us per round trip\n", num_clients,
+         total * 1000000000UL / (elapsed ? elapsed : 1), elapsed / 1000 * num_clients / total);
+}
+
+// one client streams STREAM_BYTES to the server
+static void throughput(struct sockaddr_un* addr, int server)
+{
+  if (fork() == 0)
+  {
+    int fd = connectTo(addr);
+    for (size_t sent = 0; sent < STREAM_BYTES; sent += STREAM_CHUNK)
+      assert(send(fd, buffer, STREAM_CHUNK, 0) == STREAM_CHUNK);
+    close(fd);
+    _exit(0);
+  }
+  int fd = accept(server, NULL, NULL);
+  assert(fd != -1);
+  unsigned long start = nowNs();
+  size_t received = 0;
+  ssize_t num_read;
+  while ((num_read = recv(fd, buffer, sizeof(buffer), 0)) > 0)
+    received += num_read;
+  unsigned long elapsed = nowNs() - start;
+  assert(num_read == 0 && received == STREAM_BYTES);
+  close(fd);
+  assert(waitpid(-1, NULL, 0) > 0);
+  printf("stream: %lu MB/s\n", (STREAM_BYTES * 1000UL) / (elapsed ? elapsed : 1));
+}
+
+// unix domain socket benchmark: request/response with 1 to MAX_CLIENTS clients, stream throughput
+int main()
+{
+  struct sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  memcpy(addr.sun_path, "/socket2", sizeof("/socket2"));
+
+  int server = socket(AF_UNIX, SOCK_STREAM, 0);
+  assert(server != -1);
+  assert(bind(server, (struct sockaddr*)&addr, sizeof(addr)) == 0);
+  assert(listen(server, MAX_CLIENTS) == 0);
+
+  for (int num_clients = 1; num_clients <= MAX_CLIENTS; num_clients *= 2)
+    requestResponse(&addr, server, num_clients);
+  throughput(&addr, server);
+
+  close(server);
+  printf("socket2: done\n");
+  return 0;
+}
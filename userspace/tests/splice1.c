@@ -0,0 +1,111 @@
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <assert.h>
+
+#define FILE_SIZE (32 * 1024)
+
+static char data[FILE_SIZE];
+static char buffer[FILE_SIZE];
+
+static unsigned long nowNs()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000UL + ts.tv_nsec;
+}
+
+// copies the file through the pipe with splice, or with read and write through a user buffer
+static unsigned long copyFile(const char* from, const char* to, int use_splice)
+{
+  int fd[2];
+  assert(pipe(fd) == 0);
+  int in = open(from, O_RDONLY);
+  int out = open(to, O_CREAT | O_WRONLY);
+  assert(in != -1 && out != -1);
+
+  unsigned long start = nowNs();
+  ssize_t num_moved;
+  size_t copied = 0;
+  do
+  {
+    if (use_splice)
+    {
+      num_moved = splice(in, NULL, fd[1], NULL, FILE_SIZE, SPLICE_F_MOVE);
+      if (num_moved > 0)
+        assert(splice(fd[0], NULL, out, NULL, num_moved, SPLICE_F_MOVE) == num_moved);
+    }
+    else
+    {
+      num_moved = read(in, buffer, 4096);
+      if (num_moved > 0)
+      {
+        assert(write(fd[1], buffer, num_moved) == num_moved);
+        assert(read(fd[0], buffer, num_moved) == num_moved);
+        assert(write(out, buffer, num_moved) == num_moved);
+      }
+    }
+    copied += num_moved > 0 ? num_moved : 0;
+  } while (num_moved > 0);
+  unsigned long elapsed = nowNs() - start;
+
+  assert(num_moved == 0);
+  assert(copied == FILE_SIZE);
+  close(in);
+  close(out);
+  close(fd[0]);
+  close(fd[1]);
+  return elapsed;
+}
+
+// splice between files and pipes, vmsplice of user buffers into a pipe
+int main()
+{
+  for (size_t i = 0; i < FILE_SIZE; ++i)
+    data[i] = 'a' + i % 26;
+  int fd = open("splice1.txt", O_CREAT | O_RDWR);
+  assert(fd != -1);
+  assert(write(fd, data, FILE_SIZE) == FILE_SIZE);
+  close(fd);
+
+  unsigned long copy_ns = copyFile("splice1.txt", "splice1.copy", 0);
+  unsigned long splice_ns = copyFile("splice1.txt", "splice1.splice", 1);
+
+  fd = open("splice1.splice", O_RDONLY);
+  assert(fd != -1);
+  assert(read(fd, buffer, FILE_SIZE) == FILE_SIZE);
+  assert(memcmp(buffer, data, FILE_SIZE) == 0);
+  close(fd);
+
+  // at least one side has to be a pipe, and it has to be the right end
+  int pipe_fd[2];
+  assert(pipe(pipe_fd) == 0);
+  fd = open("splice1.txt", O_RDONLY);
+  assert(splice(fd, NULL, fd, NULL, 16, 0) == -1);
+  assert(splice(fd, NULL, pipe_fd[0], NULL, 16, 0) == -1);
+  off_t offset = 0;
+  assert(splice(fd, &offset, pipe_fd[1], NULL, 16, 0) == -1);
+  close(fd);
+
+  struct iovec iov[2] = {{"vm", 2}, {"splice", 6}};
+  assert(vmsplice(pipe_fd[1], iov, 2, 0) == 8);
+  assert(vmsplice(pipe_fd[0], iov, 2, 0) == -1);
+  struct iovec kernel_iov = {(void*) 0xffffffff80000000UL, 8};
+  assert(vmsplice(pipe_fd[1], &kernel_iov, 1, 0) == -1);
+  // a socket might block with the pipe locked
+  int sock = socket(AF_UNIX, SOCK_STREAM, 0);
+  assert(sock >= 0);
+  assert(splice(pipe_fd[0], NULL, sock, NULL, 8, 0) == -1);
+  close(sock);
+  assert(read(pipe_fd[0], buffer, sizeof(buffer)) == 8);
+  assert(memcmp(buffer, "vmsplice", 8) == 0);
+  close(pipe_fd[0]);
+  close(pipe_fd[1]);
+
+  printf("read/write copy: %lu us, splice copy: %lu us\n", copy_ns / 1000, splice_ns / 1000);
+  printf("splice1: done\n");
+  return 0;
+}
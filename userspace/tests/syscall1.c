@@ -0,0 +1,40 @@
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include <assert.h>
+#include "sys/syscall.h"
+
+#define NUM_CALLS 100000
+
+static unsigned long nowNs()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000UL + ts.tv_nsec;
+}
+
+// null syscall latency: getpid through SYSCALL/SYSRET vs. the int $0x80 gate
+int main()
+{
+  size_t pid = __syscall(sc_getpid, 0x00, 0x00, 0x00, 0x00, 0x00);
+  assert(pid == __syscall_int80(sc_getpid, 0x00, 0x00, 0x00, 0x00, 0x00));
+  assert(pid == (size_t)getpid());
+
+  unsigned long start = nowNs();
+  for (size_t i = 0; i < NUM_CALLS; i++)
+    __syscall_int80(sc_getpid, 0x00, 0x00, 0x00, 0x00, 0x00);
+  unsigned long int80 = nowNs() - start;
+
+  start = nowNs();
+  for (size_t i = 0; i < NUM_CALLS; i++)
+    __syscall(sc_getpid, 0x00, 0x00, 0x00, 0x00, 0x00);
+  unsigned long fast = nowNs() - start;
+
+  printf("getpid via int $0x80: %lu ns per call\n", int80 / NUM_CALLS);
+  printf("getpid via syscall:   %lu ns per call\n", fast / NUM_CALLS);
+
+  // arguments have to survive the fast path, including the one passed in r10
+  char buffer[] = "syscall arguments ok\n";
+  assert(__syscall(sc_write, 1, (size_t)buffer, sizeof(buffer) - 1, 0x00, 0x00) == sizeof(buffer) - 1);
+  return 0;
+}
@@ -0,0 +1,130 @@
+#include <stdio.h>
+#include <unistd.h>
+#include <poll.h>
+#include <termios.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/ioctl.h>
+#include <assert.h>
+
+static void type(const char* keys)
+{
+  for (; *keys; ++keys)
+    assert(ioctl(STDIN_FILENO, TIOCSTI, keys) == 0);
+}
+
+static int readable()
+{
+  struct pollfd pfd = {STDIN_FILENO, POLLIN, 0};
+  return poll(&pfd, 1, 0);
+}
+
+static char line[16];
+static volatile ssize_t line_length = -1;
+
+static void* reader(void* arg)
+{
+  line_length = read(STDIN_FILENO, line, sizeof(line));
+  return arg;
+}
+
+// lets a blocked reader run and checks it is still waiting
+static void assertReaderBlocked()
+{
+  struct timespec pause = {0, 50000000};
+  nanosleep(&pause, NULL);
+  assert(line_length == -1);
+}
+
+// terminal attributes, non-blocking raw reads and the line discipline fed by injected keys,
+// run it without typing
+int main()
+{
+  struct termios original;
+  struct termios raw;
+  char buffer[16];
+  int fd[2];
+
+  // the terminal starts in canonical mode with echo
+  assert(tcgetattr(STDIN_FILENO, &original) == 0);
+  assert(original.c_lflag & ICANON);
+  assert(original.c_lflag & ECHO);
+  assert(original.c_cc[VMIN] == 1);
+
+  // only the terminal has attributes
+  assert(pipe(fd) == 0);
+  assert(tcgetattr(fd[0], &raw) == -1);
+  assert(tcsetattr(fd[1], TCSANOW, &original) == -1);
+  assert(tcsetattr(STDIN_FILENO, 42, &original) == -1);
+  close(fd[0]);
+  close(fd[1]);
+
+  // raw mode with VMIN 0 does not wait for input
+  raw = original;
+  cfmakeraw(&raw);
+  assert(!(raw.c_lflag & (ICANON | ECHO)));
+  raw.c_cc[VMIN] = 0;
+  assert(tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw) == 0);
+  for (int i = 0; i < 100; ++i)
+    assert(read(STDIN_FILENO, buffer, sizeof(buffer)) == 0);
+
+  // and the terminal is not readable without input
+  struct pollfd pfd = {STDIN_FILENO, POLLIN, 0};
+  assert(poll(&pfd, 1, 0) == 0);
+
+  struct termios current;
+  assert(tcgetattr(STDIN_FILENO, &current) == 0);
+  assert(!(current.c_lflag & ICANON) && current.c_cc[VMIN] == 0);
+
+  // canonical mode assembles a line, backspace edits it, and only the line end makes it readable
+  struct termios canonical = original;
+  canonical.c_lflag &= ~ECHO;
+  assert(tcsetattr(STDIN_FILENO, TCSAFLUSH, &canonical) == 0);
+  type("ab\bc");
+  assert(readable() == 0);
+  type("\n");
+  assert(readable() == 1);
+  assert(read(STDIN_FILENO, buffer, sizeof(buffer)) == 3 && memcmp(buffer, "ac\n", 3) == 0);
+  assert(readable() == 0);
+
+  // one line per read
+  type("x\ny\n");
+  assert(read(STDIN_FILENO, buffer, sizeof(buffer)) == 2 && memcmp(buffer, "x\n", 2) == 0);
+  assert(read(STDIN_FILENO, buffer, sizeof(buffer)) == 2 && memcmp(buffer, "y\n", 2) == 0);
+
+  // a blocked reader is only woken by the line end
+  pthread_t thread;
+  assert(pthread_create(&thread, NULL, reader, NULL) == 0);
+  assertReaderBlocked();
+  type("hi");
+  assertReaderBlocked();
+  type("\n");
+  pthread_join(thread, NULL);
+  assert(line_length == 3 && memcmp(line, "hi\n", 3) == 0);
+
+  // raw mode with VMIN 3 gets readable and wakes a blocked reader at the third key
+  raw.c_cc[VMIN] = 3;
+  assert(tcsetattr(STDIN_FILENO, TCSAFLUSH, &raw) == 0);
+  type("12");
+  assert(readable() == 0);
+  type("3");
+  assert(readable() == 1);
+  assert(read(STDIN_FILENO, buffer, sizeof(buffer)) == 3 && memcmp(buffer, "123", 3) == 0);
+
+  line_length = -1;
+  assert(pthread_create(&thread, NULL, reader, NULL) == 0);
+  assertReaderBlocked();
+  type("45");
+  assertReaderBlocked();
+  type("6");
+  pthread_join(thread, NULL);
+  assert(line_length == 3 && memcmp(line, "456", 3) == 0);
+
+  assert(tcsetattr(STDIN_FILENO, TCSANOW, &original) == 0);
+  assert(tcgetattr(STDIN_FILENO, &current) == 0);
+  assert((current.c_lflag & (ICANON | ECHO)) == (ICANON | ECHO) && current.c_cc[VMIN] == 1);
+
+  printf("tty1: done\n");
+  return 0;
+}
@@ -0,0 +1,53 @@
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#include <assert.h>
+#include "sys/syscall.h"
+
+#define NUM_CALLS 100000
+
+static unsigned long nowNs()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000UL + ts.tv_nsec;
+}
+
+// compares the vdso backed clock()/getpid() against the same values fetched via syscall
+int main()
+{
+  assert(getpid() == (pid_t)__syscall(sc_getpid, 0x00, 0x00, 0x00, 0x00, 0x00));
+
+  clock_t user = clock();
+  clock_t kernel = __syscall(sc_clock, 0x00, 0x00, 0x00, 0x00, 0x00);
+  printf("clock(): vdso %u, syscall %u\n", user, kernel);
+
+  unsigned long start = nowNs();
+  for (size_t i = 0; i < NUM_CALLS; i++)
+    clock();
+  unsigned long vdso = nowNs() - start;
+
+  start = nowNs();
+  for (size_t i = 0; i < NUM_CALLS; i++)
+    __syscall(sc_clock, 0x00, 0x00, 0x00, 0x00, 0x00);
+  unsigned long syscall = nowNs() - start;
+
+  printf("clock() via vdso:    %lu ns per call\n", vdso / NUM_CALLS);
+  printf("clock() via syscall: %lu ns per call\n", syscall / NUM_CALLS);
+
+  start = nowNs();
+  for (size_t i = 0; i < NUM_CALLS; i++)
+    getpid();
+  printf("getpid() via vdso:   %lu ns per call\n", (nowNs() - start) / NUM_CALLS);
+
+  // the vdso page is read-only, the fork child has its own one
+  pid_t parent = getpid();
+  pid_t child = fork();
+  if (child == 0)
+  {
+    assert(getpid() != parent);
+    return 0;
+  }
+  assert(getpid() == parent);
+  return 0;
+}
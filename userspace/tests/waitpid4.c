@@ -0,0 +1,61 @@
+#include <stdio.h>
+#include <unistd.h>
+#include <wait.h>
+#include <pthread.h>
+#include <time.h>
+#include <assert.h>
+
+#define MAX_WAITERS 32
+
+static pid_t child_pid;
+static unsigned long returned_at[MAX_WAITERS];
+
+static unsigned long nowNs()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000UL + ts.tv_nsec;
+}
+
+static void* waiter(void* index)
+{
+  assert(waitpid(child_pid, NULL, 0) == child_pid);
+  returned_at[(size_t)index] = nowNs();
+  return 0;
+}
+
+// many threads wait for the same child, its exit wakes all of them at once,
+// the time between the first and the last waiter returning should grow linearly
+int main()
+{
+  pthread_t threads[MAX_WAITERS];
+
+  for (size_t num_waiters = 1; num_waiters <= MAX_WAITERS; num_waiters *= 2)
+  {
+    child_pid = fork();
+    if (child_pid == 0)
+    {
+      sleep(1); // until all waiters are asleep
+      return 0;
+    }
+    assert(child_pid > 0);
+
+    for (size_t i = 0; i < num_waiters; i++)
+      assert(pthread_create(&threads[i], 0, waiter, (void*)i) == 0);
+    for (size_t i = 0; i < num_waiters; i++)
+      assert(pthread_join(threads[i], 0) == 0);
+
+    unsigned long first = returned_at[0];
+    unsigned long last = returned_at[0];
+    for (size_t i = 1; i < num_waiters; i++)
+    {
+      if (returned_at[i] < first)
+        first = returned_at[i];
+      if (returned_at[i] > last)
+        last = returned_at[i];
+    }
+    printf("%2zu waiters: %lu ns from the first to the last waiter returning\n", num_waiters, last - first);
+  }
+  printf("waitpid4: done\n");
+  return 0;
+}
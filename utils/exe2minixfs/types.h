@@ -4,6 +4,9 @@
 
 #define Mutex const char*
 #define MutexLock __attribute__((unused)) const char*
+#define RWLock const char*
+#define ReadLock __attribute__((unused)) const char*
+#define WriteLock __attribute__((unused)) const char*
 #define ArchThreads
 
 #include <stdint.h>